@@ -0,0 +1,32 @@
+#pragma once
+
+class AlphaBetaFilter {
+public:
+	/**
+	 * @brief Construct a new Alpha-Beta Filter object.
+	 * 
+	 * Tracks a noisy measured value and its rate of change.
+	 * 
+	 * @param alpha The correction gain applied to the value, in [0, 1].
+	 * @param beta The correction gain applied to the rate, in [0, 2].
+	 */
+	AlphaBetaFilter(double alpha = 0.5, double beta = 0.1);
+
+	void setGains(double alpha, double beta);
+	void reset(double value = 0, double rate = 0);
+
+	/**
+	 * @brief Correct the estimate with a new measurement.
+	 * 
+	 * @param measuredValue The newly measured value.
+	 * @param deltaTime_seconds Time elapsed since the previous measurement.
+	 */
+	void update(double measuredValue, double deltaTime_seconds);
+
+	double getValue();
+	double getRate();
+
+private:
+	double alpha, beta;
+	double estimatedValue, estimatedRate;
+};
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <initializer_list>
+#include <vector>
+
+// Subsystems a command may require, combined as a bitmask
+
+namespace commandsubsystem {
+	enum Subsystem {
+		None = 0,
+		Drive = 1 << 0,
+		Intake = 1 << 1,
+		Arm = 1 << 2,
+		Clamp = 1 << 3,
+		Swing = 1 << 4,
+	};
+}
+
+/**
+ * @brief A non-blocking autonomous action, stepped by the command executor.
+ *
+ * `initialize` runs once when the command starts, `execute` once per frame until `isFinished`,
+ * then `end` runs once. A command must never wait or sleep inside these functions.
+ */
+class Command {
+public:
+	virtual ~Command() {}
+
+	virtual void initialize() {}
+	virtual void execute() {}
+	virtual bool isFinished() { return true; }
+	virtual void end(bool isInterrupted) {}
+
+	int getRequirements() { return requirements; }
+	int getId() { return commandId; }
+	void setId(int commandId) { this->commandId = commandId; }
+
+protected:
+	int requirements = commandsubsystem::None;
+	int commandId = -1;
+};
+
+/// @brief Runs its commands one after another.
+class SequentialCommandGroup : public Command {
+public:
+	SequentialCommandGroup(std::initializer_list<Command *> commands);
+	~SequentialCommandGroup();
+
+	void initialize() override;
+	void execute() override;
+	bool isFinished() override;
+	void end(bool isInterrupted) override;
+
+private:
+	std::vector<Command *> commands;
+	int currentIndex;
+};
+
+/**
+ * @brief Runs its commands at the same time.
+ *
+ * Finishes when all commands finish, when any command finishes (race),
+ * or when the first command finishes (deadline). Unfinished commands are interrupted.
+ */
+class ParallelCommandGroup : public Command {
+public:
+	enum EndCondition {
+		AllFinished,
+		AnyFinished,
+		FirstFinished,
+	};
+
+	ParallelCommandGroup(std::initializer_list<Command *> commands, EndCondition endCondition = AllFinished);
+	~ParallelCommandGroup();
+
+	void initialize() override;
+	void execute() override;
+	bool isFinished() override;
+	void end(bool isInterrupted) override;
+
+private:
+	std::vector<Command *> commands;
+	std::vector<bool> isRunning;
+	EndCondition endCondition;
+	bool isGroupFinished;
+};
+
+/**
+ * @brief Runs every scheduled command, one frame per call of `runFrame`.
+ *
+ * Commands are owned by the executor once scheduled, and deleted when they end.
+ * Scheduling a command interrupts the running commands that share any of its requirements.
+ */
+namespace commands {
+	/// @brief Schedules a command. Safe to call from any task, including from a command.
+	/// @return The command's id, or -1 if the queue is full.
+	int schedule(Command *command);
+
+	/// @brief Schedules a command and waits until it ends. Must not be called from a command.
+	void runAndWait(Command *command);
+
+	/// @brief Drops the scheduled commands, and interrupts the running ones at the start of the next frame.
+	void cancelAll();
+
+	bool isRunning(int commandId);
+	bool isIdle();
+
+	/// @brief Steps the running commands once. Called by the scheduler.
+	void runFrame();
+}
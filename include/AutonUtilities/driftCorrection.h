@@ -2,20 +2,70 @@
 
 #include "main.h"
 
+/**
+ * @brief Keeps a drift-corrected copy of an inertial sensor's rotation.
+ *
+ * The gyro bias is estimated while the robot is stationary, and the clockwise / counter-clockwise scales
+ * are refined whenever a reference rotation is available. The per-revolution drift constants are only used as priors.
+ * The sensor's own rotation is never modified.
+ */
 class DriftCorrection {
 public:
 	// Reolution drift in degrees
 	DriftCorrection(inertial &sensor, double perClockwiseRevolutionDrift, double perCCWRevolutionDrift);
+	/// @brief Corrects a rotation read from a callback, in degrees with clockwise being positive like `inertial::rotation`.
+	DriftCorrection(double (*rotationCallback)(), double perClockwiseRevolutionDrift, double perCCWRevolutionDrift);
 
 	void _onInit();
 
+	/// @brief Resynchronizes the corrected rotation with the sensor's rotation. Estimated bias and scales are kept.
 	void setInitial();
+
+	/**
+	 * @brief Marks whether the robot is known to be stationary for the next correction.
+	 *
+	 * @param isStationary Whether the tracking wheels and motors report no motion.
+	 */
+	void setStationary(bool isStationary);
+
+	/**
+	 * @brief Provides a trusted rotation change for the next correction, used to refine the scales.
+	 *
+	 * @param referenceDeltaRotation_degrees The rotation change since the last correction, in degrees, clockwise being positive.
+	 */
+	void setReferenceDeltaRotation(double referenceDeltaRotation_degrees);
+
 	void correct();
 	double getRotation();
 
+	double getBias_degreesPerSecond();
+	double getClockwiseScale();
+	double getCCWScale();
+	bool isStationary();
+
 private:
 	inertial *sensor;
+	double (*rotationCallback)();
 	double perClockwiseRevolutionDrift, perCCWRevolutionDrift;
 	double storedInitialRotation;
 	double correctedRotation;
+
+	// Timing
+	uint64_t storedTime_microseconds;
+
+	// Stationary detection
+	bool stationaryHint;
+	double stationaryDuration_seconds;
+
+	// Bias estimate
+	double bias_degreesPerSecond;
+
+	// Scale estimates, as recursive least squares sums
+	bool hasReferenceDelta;
+	double referenceDeltaRotation_degrees;
+	double clockwiseScaleSumXX, clockwiseScaleSumXY;
+	double ccwScaleSumXX, ccwScaleSumXY;
+
+	double readRotation();
+	void updateScaleSums(double measuredDelta_degrees, double referenceDelta_degrees);
 };
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <utility>
+
+class Linegular;
+
+/**
+ * @brief Linear time-varying unicycle controller.
+ *
+ * Uses LQR gains scheduled on the reference velocity. The gains are computed offline by
+ * tools/ltvUnicycleTable.py and interpolated from a table, so each update runs in constant time.
+ * Has the same interface as RamseteController.
+ */
+class LtvUnicycleController {
+public:
+	LtvUnicycleController();
+
+	void setDirection(bool isReversed);
+
+	std::pair<double, double> getLinegularVelocity(
+		Linegular actual, Linegular desired,
+		double desiredLinearVelocity, double desiredAngularVelocity_radiansPerSecond
+	);
+
+private:
+	double directionFactor = 1;
+};
@@ -0,0 +1,56 @@
+#pragma once
+
+// Generated by tools/ltvUnicycleTable.py, don't edit by hand
+// Q tolerances: 0.1025 tiles, 0.2051 tiles, 2.0000 rad
+// R tolerances: 1.6404 tiles/s, 2.0000 rad/s, dt: 0.010 s
+
+namespace ltvtable {
+	const int period_msec = 10;
+	const double velocityStep_tilesPerSecond = 0.1000;
+	const int entryCount = 41;
+
+	// kForward, kLeft, kTheta for each reference velocity
+	const double gains[entryCount][3] = {
+		{14.771118, 0.000000, 0.995012}, // 0.00 tiles/s
+		{14.771118, 9.670187, 1.707925}, // 0.10 tiles/s
+		{14.771118, 9.646228, 2.199226}, // 0.20 tiles/s
+		{14.771118, 9.626775, 2.598120}, // 0.30 tiles/s
+		{14.771118, 9.609976, 2.942575}, // 0.40 tiles/s
+		{14.771118, 9.594982, 3.250034}, // 0.50 tiles/s
+		{14.771118, 9.581318, 3.530236}, // 0.60 tiles/s
+		{14.771118, 9.568685, 3.789274}, // 0.70 tiles/s
+		{14.771118, 9.556884, 4.031263}, // 0.80 tiles/s
+		{14.771118, 9.545771, 4.259134}, // 0.90 tiles/s
+		{14.771118, 9.535241, 4.475065}, // 1.00 tiles/s
+		{14.771118, 9.525211, 4.680724}, // 1.10 tiles/s
+		{14.771118, 9.515619, 4.877426}, // 1.20 tiles/s
+		{14.771118, 9.506412, 5.066224}, // 1.30 tiles/s
+		{14.771118, 9.497548, 5.247982}, // 1.40 tiles/s
+		{14.771118, 9.488992, 5.423417}, // 1.50 tiles/s
+		{14.771118, 9.480716, 5.593131}, // 1.60 tiles/s
+		{14.771118, 9.472693, 5.757637}, // 1.70 tiles/s
+		{14.771118, 9.464903, 5.917375}, // 1.80 tiles/s
+		{14.771118, 9.457327, 6.072727}, // 1.90 tiles/s
+		{14.771118, 9.449949, 6.224026}, // 2.00 tiles/s
+		{14.771118, 9.442753, 6.371565}, // 2.10 tiles/s
+		{14.771118, 9.435729, 6.515604}, // 2.20 tiles/s
+		{14.771118, 9.428864, 6.656373}, // 2.30 tiles/s
+		{14.771118, 9.422149, 6.794079}, // 2.40 tiles/s
+		{14.771118, 9.415573, 6.928907}, // 2.50 tiles/s
+		{14.771118, 9.409130, 7.061026}, // 2.60 tiles/s
+		{14.771118, 9.402812, 7.190587}, // 2.70 tiles/s
+		{14.771118, 9.396612, 7.317729}, // 2.80 tiles/s
+		{14.771118, 9.390523, 7.442578}, // 2.90 tiles/s
+		{14.771118, 9.384541, 7.565249}, // 3.00 tiles/s
+		{14.771118, 9.378659, 7.685849}, // 3.10 tiles/s
+		{14.771118, 9.372874, 7.804476}, // 3.20 tiles/s
+		{14.771118, 9.367181, 7.921220}, // 3.30 tiles/s
+		{14.771118, 9.361575, 8.036165}, // 3.40 tiles/s
+		{14.771118, 9.356054, 8.149388}, // 3.50 tiles/s
+		{14.771118, 9.350613, 8.260961}, // 3.60 tiles/s
+		{14.771118, 9.345249, 8.370953}, // 3.70 tiles/s
+		{14.771118, 9.339959, 8.479426}, // 3.80 tiles/s
+		{14.771118, 9.334740, 8.586439}, // 3.90 tiles/s
+		{14.771118, 9.329590, 8.692046}, // 4.00 tiles/s
+	};
+}
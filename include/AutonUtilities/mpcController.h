@@ -0,0 +1,63 @@
+#pragma once
+
+#include <utility>
+
+class Linegular;
+
+/**
+ * @brief Model-predictive path tracking controller for a differential drive.
+ *
+ * Tracks a reference over a short horizon with a unicycle model linearized about the reference.
+ * The decision variables are the wheel velocities at each step, bounded by the drivetrain's
+ * voltage-limited speed and acceleration. The QP is solved by accelerated projected gradient
+ * with a fixed iteration cap, on fixed-size arrays, so a solve never allocates.
+ */
+class MpcController {
+public:
+	static const int maxHorizonSteps = 20;
+
+	MpcController(int horizonSteps = 15, double stepTime_seconds = 0.020);
+
+	void setDirection(bool isReversed);
+
+	/// @brief Clears the warm start and the last command. Call when following starts.
+	void reset();
+
+	int getHorizonSteps();
+	double getStepTime_seconds();
+
+	/// @brief Sets the reference at a step of the horizon, where step 0 is now.
+	void setReference(
+		int stepIndex, Linegular desired,
+		double desiredLinearVelocity, double desiredAngularVelocity_radiansPerSecond
+	);
+
+	/// @brief Solves for the velocities to apply now, using the references set for every step.
+	std::pair<double, double> getLinegularVelocity(Linegular actual);
+
+	int getLastIterationCount();
+
+private:
+	int horizonSteps;
+	double stepTime_seconds;
+	double directionFactor = 1;
+
+	// Bounds
+	double maxWheelVelocity, maxWheelAcceleration;
+	double halfTrackWidth;
+
+	// Reference, in tiles and polar radians
+	double referenceX[maxHorizonSteps], referenceY[maxHorizonSteps], referenceTheta[maxHorizonSteps];
+	double referenceLinear[maxHorizonSteps], referenceAngular[maxHorizonSteps];
+
+	// Wheel velocity deviations from the reference, {left, right} per step
+	double solution[2 * maxHorizonSteps];
+	bool hasSolution;
+
+	double lastLeftVelocity, lastRightVelocity;
+	bool hasLastCommand;
+	int lastIterationCount;
+
+	double computeGradient(const double initialError[3], const double *deviations, double *gradient);
+	void project(double *deviations);
+};
@@ -1,10 +1,19 @@
 #pragma once
 
+#include "AutonUtilities/alphaBetaFilter.h"
 #include "main.h"
 
 class DriftCorrection;
 class Linegular;
 
+namespace odometry {
+	enum HeadingFusionMode {
+		InertialOnly,
+		Complementary,
+		Kalman,
+	};
+}
+
 class Odometry {
 public:
 	/**
@@ -25,8 +34,9 @@ public:
 	 * @param sensorToWheel_gearRatio The ratio `sensorGearTeeth` / `wheelGearTeeth`, or (sensor gear) / (farther gear) * (close gear) / (far gear) * ... * () / ().
 	 * @param wheelDiameter_inches The diameter of the driven wheel in inches.
 	 * @param normalRotateRadius_inches The distance between the sensor's measuring line and a parallel line passing through the tracking center. Positive means the sensor is measuring forward to the right of the tracking center.
+	 * @param timestampCallback An optional function pointer for getting the timestamp, in milliseconds, of the sensor's latest sample. Sensors without one are refreshed by change detection.
 	 */
-	void addPositionSensor2D(double polarAngle, double (*revolutionCallback)(), double sensorToWheel_gearRatio, double wheelDiameter_inches, double normalRotateRadius_inches);
+	void addPositionSensor2D(double polarAngle, double (*revolutionCallback)(), double sensorToWheel_gearRatio, double wheelDiameter_inches, double normalRotateRadius_inches, uint32_t (*timestampCallback)() = nullptr);
 
 	/**
 	 * @brief Adds an inertial sensor to track the robot's rotation in a 2D plane.
@@ -42,6 +52,18 @@ public:
 	 */
 	void addInertialSensor(inertial &sensor, double perClockwiseRevolutionDrift = 0, double perCCWRevolutionDrift = 0);
 
+	/**
+	 * @brief Adds a rotation source read from a callback, such as a simulated inertial sensor.
+	 * Its samples have no timestamps, so frames are refreshed by the position sensors.
+	 * 
+	 * Only works before the odometry is started.
+	 * 
+	 * @param rotationCallback A function pointer for getting the robot's rotation in degrees, clockwise being positive like `inertial::rotation`.
+	 * @param perClockwiseRevolutionDrift The drift, in degrees, per clockwise revolution of the robot.
+	 * @param perCCWRevolutionDrift The drift, in degrees, per counter-clockwise revolution of the robot.
+	 */
+	void addInertialSensor(double (*rotationCallback)(), double perClockwiseRevolutionDrift = 0, double perCCWRevolutionDrift = 0);
+
 	/**
 	 * @brief Sets the factor multiplied to the robot's position in inches.
 	 * 
@@ -49,6 +71,59 @@ public:
 	 */
 	void setPositionFactor(double inchToValue_ratio);
 
+	/**
+	 * @brief Sets the gains of the filters estimating the robot's velocity and acceleration.
+	 * 
+	 * @param alpha The correction gain applied to the velocity, in [0, 1]. Lower is smoother.
+	 * @param beta The correction gain applied to the acceleration, in [0, 2]. Lower is smoother.
+	 */
+	void setMotionFilterGains(double alpha, double beta);
+
+	/**
+	 * @brief Sets a function that reports the drive's speed, used with the tracking wheels to detect when the robot is stationary.
+	 * Inertial sensor bias is estimated during stationary periods.
+	 * 
+	 * Example: `([]() {return fabs(LeftMotors.velocity(pct)) + fabs(RightMotors.velocity(pct));}, 2)`.
+	 * 
+	 * @param driveSpeedCallback A function pointer for getting the drive's non-negative speed.
+	 * @param maxStationarySpeed The largest speed still considered stationary, in the callback's units.
+	 */
+	void setStationarySpeedCallback(double (*driveSpeedCallback)(), double maxStationarySpeed);
+
+	/**
+	 * @brief Sets the drive motor encoders used as a reference to check the tracking wheels and inertial sensors.
+	 * Sensors inconsistent with the reference lose health and are excluded for the frame.
+	 * When no look sensor is kept, the drive travel is used instead. Sideways sensors are kept when none would remain, as the drive can't measure sliding.
+	 * 
+	 * Only works before the odometry is started.
+	 * 
+	 * @param leftRevolutionCallback A function pointer for getting the left drive motors' position in revolutions.
+	 * @param rightRevolutionCallback A function pointer for getting the right drive motors' position in revolutions.
+	 * @param motorToWheel_gearRatio The ratio (wheel revolutions) / (motor revolutions).
+	 * @param wheelDiameter_inches The diameter of the drive wheels in inches.
+	 * @param trackWidth_inches The distance between the left and right drive wheels in inches.
+	 */
+	void setDriveReference(double (*leftRevolutionCallback)(), double (*rightRevolutionCallback)(), double motorToWheel_gearRatio, double wheelDiameter_inches, double trackWidth_inches);
+
+	/**
+	 * @brief Sets how the heading is fused from a parallel tracking wheel pair and the inertial sensors.
+	 * The tracking wheels give short-term rotation, and the inertial sensors correct it over the long term.
+	 * Requires two parallel tracking wheels with different normal rotate radii; otherwise the inertial sensors are used alone.
+	 * 
+	 * @param mode The fusion mode.
+	 * @param timeConstant_seconds For complementary fusion, the time over which the inertial sensors pull the heading back.
+	 */
+	void setHeadingFusion(odometry::HeadingFusionMode mode, double timeConstant_seconds = 0.5);
+
+	/**
+	 * @brief Sets the noise model of the Kalman heading fusion.
+	 * 
+	 * @param processNoisePerDegree The variance, in squared degrees, added per degree of tracking wheel rotation.
+	 * @param processNoisePerFrame The variance, in squared degrees, added every frame.
+	 * @param measurementNoise The variance, in squared degrees, of the inertial sensors' heading.
+	 */
+	void setHeadingKalmanNoise(double processNoisePerDegree, double processNoisePerFrame, double measurementNoise);
+
 	/**
 	 * @brief (unavailable) Starts tracking the robot's position. This can only be called once.
 	 * 
@@ -88,6 +163,15 @@ public:
 	 */
 	void setRightAngle(double fieldAngle_degrees);
 
+	/**
+	 * @brief Sets the robot's position and rotation together, between odometry frames.
+	 * 
+	 * @param x Horizontal position with position factor.
+	 * @param y Vertical position with position factor.
+	 * @param lookFieldAngle_degrees Robot's front/look direction. Field angle rotation in degrees.
+	 */
+	void setPose(double x, double y, double lookFieldAngle_degrees);
+
 	double getX();
 	double getY();
 	double getLookFieldAngle_degrees();
@@ -95,6 +179,29 @@ public:
 
 	Linegular getLookLinegular();
 
+	// Body-frame motion, with position factor, per second
+	double getLocalRightVelocity();
+	double getLocalLookVelocity();
+	double getAngularVelocity_radiansPerSecond();
+
+	double getLocalRightAcceleration();
+	double getLocalLookAcceleration();
+	double getAngularAcceleration_radiansPerSecondSquared();
+
+	// Sensor health in [0, 1] and number of frames the sensor was excluded
+	double getPositionSensorHealth(int sensorIndex);
+	int getPositionSensorRejectionCount(int sensorIndex);
+	double getInertialSensorHealth(int sensorIndex);
+	int getInertialSensorRejectionCount(int sensorIndex);
+
+	// Number of frames the tracking wheel rotation disagreed with the inertial sensors
+	int getHeadingFusionRejectionCount();
+
+	// Sample refresh statistics
+	double getEffectiveUpdateRate_hertz();
+	int getSkippedFrameCount();
+	int getMergedFrameCount();
+
 	void printDebug();
 
 private:
@@ -104,19 +211,52 @@ private:
 	std::vector<double> positionSensor_sensorToWheel_gearRatios;
 	std::vector<double> positionSensor_wheelDiameters_inches;
 	std::vector<double> positionSensor_normalRotateRadii_inches;
+	std::vector<uint32_t (*)()> positionSensor_timestampCallbacks;
 
 	std::vector<double> positionSensor_oldMeasurements, positionSensor_newMeasurements;
+	std::vector<uint32_t> positionSensor_oldTimestamps, positionSensor_newTimestamps;
+	std::vector<double> positionSensor_samplePeriods_milliseconds;
 
 	int positionSensor_count;
 
-	// Inertial gyro sensors
+	// Inertial gyro sensors, null for rotation callbacks
 	std::vector<inertial *> inertialSensors;
 	std::vector<DriftCorrection *> inertialSensor_driftCorrections;
 
 	std::vector<double> inertialSensor_oldMeasurements, inertialSensor_newMeasurements;
+	std::vector<uint32_t> inertialSensor_oldTimestamps;
 
 	int inertialSensor_count;
 
+	// Drive reference
+	double (*driveLeftRevolutionCallback)();
+	double (*driveRightRevolutionCallback)();
+	double driveMotorToWheel_gearRatio, driveWheelDiameter_inches, driveTrackWidth_inches;
+	double driveLeft_oldMeasurement, driveRight_oldMeasurement;
+	double driveLeft_newMeasurement, driveRight_newMeasurement;
+
+	// Sensor health, sized on start
+	std::vector<double> positionSensor_healthScores, positionSensor_frameWeights;
+	std::vector<int> positionSensor_rejectionCounts;
+	std::vector<double> inertialSensor_healthScores, inertialSensor_frameWeights;
+	std::vector<int> inertialSensor_rejectionCounts;
+	bool hasReferenceDeltaPolarAngle, useReferenceDeltaPolarAngle;
+	double referenceDeltaPolarAngle_degrees;
+	bool isLookOnDriveReference;
+	double driveLookDelta_inches;
+
+	// Heading fusion
+	odometry::HeadingFusionMode headingFusionMode;
+	double headingFusionTimeConstant_seconds;
+	double headingKalmanProcessNoisePerDegree, headingKalmanProcessNoisePerFrame, headingKalmanMeasurementNoise;
+	double fusedPolarAngle_degrees, inertialPolarAngle_degrees;
+	double headingKalmanVariance;
+	int headingFusionRejectionCount;
+
+	// Stationary detection
+	double (*driveSpeedCallback)();
+	double maxStationarySpeed;
+
 	// Factors
 	double positionFactor;
 
@@ -126,14 +266,42 @@ private:
 	// Tracked values
 	double x, y;
 	double right_fieldAngle_degrees;
+	mutex poseMutex;
+
+	// Motion estimation
+	AlphaBetaFilter localRightVelocityFilter, localLookVelocityFilter, angularVelocityFilter;
+	uint64_t lastFrameTime_microseconds;
+	double frameDeltaTime_seconds;
+
+	// Sample refresh
+	double effectiveUpdateRate_hertz;
+	int skippedFrameCount, mergedFrameCount;
 
 	// Functions
 	void odometryThread();
 
 	void getNewPositionSensorMeasurements();
 	void getNewInertialSensorMeasurements();
+	void getNewDriveReferenceMeasurements();
+	uint32_t getInertialSensorTimestamp(int sensorIndex);
+
+	double getPositionSensorDeltaDistance_inches(int sensorIndex);
+	void updateSensorHealth();
+	void updateInertialSensorHealth(bool canReplaceSensors);
+	void updatePositionSensorHealth();
+	double getAxisFrameWeight(bool isLookAxis);
+	void restoreRejectedPositionSensors(bool isLookAxis);
+
+	void updateDriftCorrectionHints();
+	bool isPositionSensorsStationary();
+	bool getTrackingWheelDeltaPolarAngle_degrees(double &deltaPolarAngle_degrees);
 
 	double getDeltaPolarAngle_degrees();
+	double getFusedDeltaPolarAngle_degrees(double inertialDeltaPolarAngle_degrees);
 	double getLocalDeltaX_inches(double deltaPolarAngle_degrees);
 	double getLocalDeltaY_inches(double deltaPolarAngle_degrees);
+
+	bool hasFreshSamples();
+	void updateFrameTime();
+	void updateMotionEstimate(double localDeltaRight, double localDeltaLook, double deltaPolarAngle_degrees);
 };
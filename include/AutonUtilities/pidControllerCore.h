@@ -0,0 +1,203 @@
+#pragma once
+
+#include "Utilities/virtualClock.h"
+
+#include <cmath>
+
+// Features of the controller, combined as a bitmask
+
+namespace pidfeature {
+	enum Feature {
+		None = 0,
+		Feedforward = 1 << 0, // kS, kV, kA on a reference velocity and acceleration
+		DerivativeFilter = 1 << 1, // First-order low-pass on the derivative
+		IntegralClamp = 1 << 2, // Limit on the integral term's output
+		SlewLimit = 1 << 3, // Limit on the output's rate of change
+		All = Feedforward | DerivativeFilter | IntegralClamp | SlewLimit,
+	};
+}
+
+/**
+ * @brief PID controller with optional feedforward, derivative filtering, integral clamping and slew limiting.
+ *
+ * Features are selected at compile time with the `features` bitmask.
+ * The checks are on a constant, so the terms of disabled features are optimized out.
+ *
+ * @tparam features A combination of `pidfeature::Feature` flags.
+ */
+template <int features>
+class PIDControllerCore {
+public:
+	PIDControllerCore(double kP = 0, double kI = 0, double kD = 0, double settleRange = 5, double settleFrameCount = 7) {
+		kProp = kP, kInteg = kI, kDeriv = kD;
+		kStatic = kVelocity = kAcceleration = 0;
+		referenceVelocity = referenceAcceleration = 0;
+		derivativeTimeConstant_seconds = 0;
+		maxIntegralValue = 1e9;
+		maxSlewRate_perSecond = 1e9;
+		resetErrorToZero();
+
+		settleErrorRange = std::fabs(settleRange);
+		settleMinFrameCount = settleFrameCount;
+		settledFrames = 0;
+	}
+
+	/// @brief Sets the feedforward gains. Only used with `pidfeature::Feedforward`.
+	void setFeedforward(double kS, double kV, double kA) {
+		kStatic = kS, kVelocity = kV, kAcceleration = kA;
+	}
+
+	/// @brief Sets the reference velocity and acceleration used by the feedforward.
+	void setFeedforwardReference(double velocity, double acceleration = 0) {
+		referenceVelocity = velocity;
+		referenceAcceleration = acceleration;
+	}
+
+	/// @brief Sets the time constant of the derivative low-pass. Only used with `pidfeature::DerivativeFilter`.
+	void setDerivativeFilter(double timeConstant_seconds) {
+		derivativeTimeConstant_seconds = std::fabs(timeConstant_seconds);
+	}
+
+	/// @brief Sets the largest magnitude of the integral term's output. Only used with `pidfeature::IntegralClamp`.
+	void setIntegralLimit(double maxIntegralValue) {
+		this->maxIntegralValue = std::fabs(maxIntegralValue);
+	}
+
+	/// @brief Sets the largest change of the output per second. Only used with `pidfeature::SlewLimit`.
+	void setSlewRate(double maxValueChange_perSecond) {
+		maxSlewRate_perSecond = std::fabs(maxValueChange_perSecond);
+	}
+
+	void resetErrorToZero() {
+		previousError = currentError = 2e17;
+		cumulativeError = deltaError = 0;
+		slewedValue = 0;
+		pidTimer.reset();
+		settledFrames = 0;
+	}
+
+	/// @brief Updates the controller, measuring the elapsed time since the last update.
+	void computeFromError(double error) {
+		double elapsedTime_seconds = pidTimer.value();
+		computeFromError(error, elapsedTime_seconds);
+	}
+
+	/// @brief Updates the controller with an explicit elapsed time.
+	void computeFromError(double error, double deltaTime_seconds) {
+		pidTimer.reset();
+
+		// Previous error
+		bool isFirstFrame = previousError > 1e17;
+		if (isFirstFrame) {
+			previousError = error;
+		} else {
+			previousError = currentError;
+		}
+
+		// Update errors
+		currentError = error;
+		bool hasElapsed = deltaTime_seconds >= minDeltaTime_seconds;
+		bool isCrossZero = (currentError >= 0 && previousError <= 0) || (currentError <= 0 && previousError >= 0);
+		if (isCrossZero) {
+			cumulativeError = 0;
+		} else if (hasElapsed) {
+			cumulativeError += 0.5 * (previousError + currentError) * deltaTime_seconds;
+		}
+
+		// Clamp integral
+		if ((features & pidfeature::IntegralClamp) && kInteg != 0) {
+			double maxCumulativeError = maxIntegralValue / std::fabs(kInteg);
+			cumulativeError = fmax(-maxCumulativeError, fmin(maxCumulativeError, cumulativeError));
+		}
+
+		// Derivative, held when too little time has elapsed
+		if (isFirstFrame) {
+			deltaError = 0;
+		} else if (hasElapsed) {
+			double rawDeltaError = (currentError - previousError) / deltaTime_seconds;
+			if (features & pidfeature::DerivativeFilter) {
+				double filterGain = deltaTime_seconds / (derivativeTimeConstant_seconds + deltaTime_seconds);
+				deltaError += filterGain * (rawDeltaError - deltaError);
+			} else {
+				deltaError = rawDeltaError;
+			}
+		}
+
+		// Slew output
+		if (features & pidfeature::SlewLimit) {
+			double targetValue = getUnslewedValue(true, true, true);
+			if (isFirstFrame || !hasElapsed) {
+				slewedValue = isFirstFrame ? targetValue : slewedValue;
+			} else {
+				double maxChange = maxSlewRate_perSecond * deltaTime_seconds;
+				slewedValue += fmax(-maxChange, fmin(maxChange, targetValue - slewedValue));
+			}
+		}
+
+		// Settle errors
+		if (std::fabs(error) < settleErrorRange) {
+			settledFrames++;
+			settledFrames = fmin(settledFrames, settleMinFrameCount + 1);
+		} else {
+			settledFrames = 0;
+		}
+	}
+
+	void setErrorI(double errorI) {
+		cumulativeError = errorI;
+	}
+
+	/// @brief Returns the controller output. The slew limit applies when all terms are used.
+	double getValue(bool useP = true, bool useI = true, bool useD = true) {
+		if ((features & pidfeature::SlewLimit) && useP && useI && useD) {
+			return slewedValue;
+		}
+		return getUnslewedValue(useP, useI, useD);
+	}
+
+	bool isSettled() {
+		if (std::fabs(currentError) < settleErrorRange && settledFrames >= settleMinFrameCount) {
+			return true;
+		} else {
+			return false;
+		}
+	}
+
+private:
+	static constexpr double minDeltaTime_seconds = 1e-3;
+
+	vclock::Timer pidTimer;
+
+	double kProp, kInteg, kDeriv;
+	double kStatic, kVelocity, kAcceleration;
+	double referenceVelocity, referenceAcceleration;
+	double derivativeTimeConstant_seconds;
+	double maxIntegralValue;
+	double maxSlewRate_perSecond;
+
+	double currentError, cumulativeError, deltaError, previousError;
+	double slewedValue;
+	double settleErrorRange, settleMinFrameCount;
+	double settledFrames;
+
+	double getUnslewedValue(bool useP, bool useI, bool useD) {
+		double valP = useP ? (currentError * kProp) : 0;
+		double valI = useI ? (cumulativeError * kInteg) : 0;
+		double valD = useD ? (deltaError * kDeriv) : 0;
+		return valP + valI + valD + getFeedforwardValue();
+	}
+
+	double getFeedforwardValue() {
+		if (!(features & pidfeature::Feedforward)) {
+			return 0;
+		}
+
+		// Static friction in the direction of motion, or of the error when holding position
+		double direction = referenceVelocity;
+		if (direction == 0 && std::fabs(currentError) >= settleErrorRange && currentError < 1e17) {
+			direction = currentError;
+		}
+		double valS = (direction > 0) ? kStatic : ((direction < 0) ? -kStatic : 0);
+		return valS + kVelocity * referenceVelocity + kAcceleration * referenceAcceleration;
+	}
+};
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "AutonUtilities/alphaBetaFilter.h"
+
+/**
+ * @brief Predicts when a blocking move will settle, so it can hand off early.
+ *
+ * The error and its rate are tracked by an alpha-beta filter. The mechanism is modelled
+ * as braking at a constant deceleration, so the error it will come to rest at is
+ * e + sign(de) * de^2 / (2 * decel). The move is predicted settled once that resting
+ * error is in range, the rate is slow enough to stop there, and this held for a few frames.
+ */
+class SettlePredictor {
+public:
+	/**
+	 * @param settleRange Error range the move settles in, as used by its PID.
+	 * @param brakeDeceleration Deceleration the mechanism can brake at, in error units per second squared.
+	 * @param maxSettleRate Fastest error rate to hand off at.
+	 * @param settleConfirm_seconds Time the move's own settle check stays in range before exiting.
+	 * @param confirmFrameCount Consecutive frames the prediction must hold.
+	 */
+	SettlePredictor(double settleRange, double brakeDeceleration, double maxSettleRate, double settleConfirm_seconds, int confirmFrameCount = 2);
+
+	/// @brief Clears the prediction. The next update starts the filter at its error.
+	void reset();
+	void update(double error, double deltaTime_seconds);
+
+	bool isPredictedSettled();
+	double getPredictedFinalError();
+	double getErrorRate();
+
+	/// @brief Estimated time the move's own settle check would still take.
+	double getRemainingTime_seconds();
+
+	/**
+	 * @brief Records the move's statistics, call once when the move ends.
+	 *
+	 * A handed off move saves the estimated remaining time. A move that ran to its own
+	 * exit saves nothing, but the time since the prediction first held is recorded as
+	 * a measured saving, to check the estimate against.
+	 */
+	void recordMove(const char *moveName, bool isHandedOff);
+
+private:
+	double settleRange;
+	double brakeDeceleration;
+	double maxSettleRate;
+	double settleConfirm_seconds;
+	int confirmFrameCount;
+
+	AlphaBetaFilter errorFilter;
+
+	bool hasError;
+	double elapsed_seconds;
+	double predictedFinalError;
+	int predictedFrameCount;
+	double firstPredicted_seconds;
+};
+
+/**
+ * @brief Per-move statistics of predictive settling over a routine.
+ */
+namespace settlestats {
+	struct MoveStats {
+		const char *name;
+		double duration_seconds;
+		double saved_seconds;
+		bool isHandedOff;
+		bool isMeasured;
+	};
+
+	// Moves kept for printing, later moves still count in the totals
+	const int maxMoveCount = 64;
+
+	void recordMove(const char *name, double duration_seconds, double saved_seconds, bool isHandedOff, bool isMeasured);
+
+	int getMoveCount();
+	double getTotalSaved_seconds();
+	void resetStats();
+
+	/// @brief Prints every recorded move and the totals to the terminal.
+	void printStats();
+}
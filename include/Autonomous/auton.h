@@ -13,7 +13,8 @@ namespace auton {
 		AutonSkills59, AutonSkillsNoWallStake,
 		DrivingRunAutonSkills, DrivingSkills,
 		AllianceWallStake, LoveShape, FieldTour,
-		Test, OdometryRadiusTest,
+		Test, OdometryRadiusTest, TurnProfileTest,
+		SystemIdentification,
 		None
 	};
 
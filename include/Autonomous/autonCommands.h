@@ -0,0 +1,34 @@
+#pragma once
+
+#include "AutonUtilities/command.h"
+
+#include <initializer_list>
+
+// Commands for autonomous routines, run by the executor in `commands`
+
+namespace autoncommands {
+	/* Groups */
+
+	Command *sequence(std::initializer_list<Command *> commands);
+	Command *parallel(std::initializer_list<Command *> commands);
+	Command *race(std::initializer_list<Command *> commands);
+	Command *deadline(std::initializer_list<Command *> commands);
+
+	/* Timing */
+
+	Command *waitSeconds(double seconds);
+	Command *waitFor(bool (*condition)());
+	Command *instant(void (*action)(), int requirements = commandsubsystem::None);
+
+	/* Drive */
+
+	Command *driveTurnToFace(double x_tiles, double y_tiles, bool isReverse = false, double maxVelocityPct = 100, double maxTurnVelocityPct = 100, double runTimeout = 3);
+	Command *waitForDriveTurnDistance(double distanceError_tiles);
+	Command *followSplinePath(bool reverseHeading = false);
+
+	/* Mechanics */
+
+	Command *setIntakeState(int state);
+	Command *setArmStage(int stage);
+	Command *setGoalClampState(bool state);
+}
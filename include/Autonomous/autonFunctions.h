@@ -4,6 +4,8 @@
 
 #include "AutonUtilities/odometry.h"
 
+#include "Utilities/virtualClock.h"
+
 #include "main.h"
 
 
@@ -12,6 +14,7 @@
 class UniformCubicSpline;
 class CurveSampler;
 class TrajectoryPlanner;
+class Command;
 
 
 // Namespace
@@ -21,12 +24,13 @@ namespace autonfunctions {
 
 	void setRobotRotation(double rotation);
 
-	extern timer _autonTimer;
+	extern vclock::Timer _autonTimer;
 
 	/* PID differential */
 
 	void turnToAngle(double rotation, double rotateCenterOffsetIn = 0, double runTimeout = 3);
 	void turnToAngleVelocity(double rotation, double maxVelocityPct, double rotateCenterOffsetIn = 0, double runTimeout = 3);
+	void turnToAngleProfiled(double rotation, double maxVelocityPct = 100, double runTimeout = 3);
 
 	void driveDistanceTiles(double distanceTiles, double maxVelocityPct = 100, double runTimeout = 3);
 	void driveAndTurnDistanceTiles(double distanceTiles, double targetRotation, double maxVelocityPct = 100, double maxTurnVelocityPct = 100, double runTimeout = 3);
@@ -35,24 +39,59 @@ namespace autonfunctions {
 	/* PID + Odometry */
 
 	namespace driveturn {
-		void async_driveTurnToFace_tiles(double x_tiles, double y_tiles, bool isReverse = false, double maxVelocityPct = 100, double maxTurnVelocityPct = 100, double runTimeout = 3);
-		void driveTurnToFace_tiles(double x_tiles, double y_tiles, bool isReverse = false, double maxVelocityPct = 100, double maxTurnVelocityPct = 100, double runTimeout = 3);
+		// A positive exit radius chains the drive-turn: it passes the target at the exit velocity
+		// once within the radius, and keeps driving for the next command instead of stopping.
+		void async_driveTurnToFace_tiles(double x_tiles, double y_tiles, bool isReverse = false, double maxVelocityPct = 100, double maxTurnVelocityPct = 100, double runTimeout = 3, double exitVelocityPct = 0, double exitRadius_tiles = 0);
+		void driveTurnToFace_tiles(double x_tiles, double y_tiles, bool isReverse = false, double maxVelocityPct = 100, double maxTurnVelocityPct = 100, double runTimeout = 3, double exitVelocityPct = 0, double exitRadius_tiles = 0);
+
+		// State of one drive-turn, so several can be described without shared globals
+		struct DriveTurnToFaceState {
+			double targetX_tiles, targetY_tiles;
+			bool isReverse;
+			double maxVelocity_pct, maxTurnVelocity_pct;
+			double runTimeout_seconds;
+			double exitVelocity_pct, exitRadius_tiles;
+
+			// Set when started
+			double startX_tiles, startY_tiles;
+			double targetDistance_tiles, targetRotation_degrees;
+			double elapsedTime_seconds;
+			bool isHandedOff;
+			int statusToken;
+		};
+
+		Command *createDriveTurnToFaceCommand(double x_tiles, double y_tiles, bool isReverse = false, double maxVelocityPct = 100, double maxTurnVelocityPct = 100, double runTimeout = 3, double exitVelocityPct = 0, double exitRadius_tiles = 0);
+
+		void startDriveTurnToFace(DriveTurnToFaceState &state);
+		bool stepDriveTurnToFace(DriveTurnToFaceState &state, double deltaTime_seconds);
+		void finishDriveTurnToFace(DriveTurnToFaceState &state, bool isInterrupted);
 
 		extern double _linearPathDistanceError;
-		extern double _targetX, _targetY;
-		extern bool _isReverseHeading;
-		extern double _maxVelocity_pct, _maxTurnVelocity_pct;
-		extern double _runTimeout;
 		extern bool _isDriveTurnSettled;
 	}
 
 	void turnToFace_tiles(double x_tiles, double y_tiles, bool isReverse = false, double maxTurnVelocity_pct = 100);
 
 	void runLinearPIDPath(std::vector<std::vector<double>> waypoints, double maxVelocity, bool isReverse = false);
+	/// @brief Chains the legs of linear PID paths through shallow corners instead of stopping at each waypoint.
+	/// Intermediate waypoints are passed at the exit velocity within the exit radius, and the next leg's turn blends into the drive.
+	/// Off by default.
+	void setLinearPathChaining(bool useChaining = true, double exitVelocityPct = 50, double exitRadius_tiles = 0.2);
 
 	void setDifferentialUseRelativeRotation(bool useRelativeRotation);
+	/// @brief Exits blocking PID moves once they are predicted to settle, instead of waiting in range.
+	/// When off, moves still record how much time the prediction would have saved.
+	/// Off by default.
+	void setUsePredictiveSettle(bool usePredictiveSettle = true);
 
 	extern bool _useRelativeRotation;
+	extern bool _usePredictiveSettle;
+
+
+	/* Wall reset */
+
+	void addWallResetSensor(distance &sensor, double rightOffset_inches, double lookOffset_inches, double mountAngle_degrees);
+	bool resetPoseFromWalls(double maxDistanceError_inches = 3, bool resetHeading = true);
 
 
 	/* Path following */
@@ -60,9 +99,22 @@ namespace autonfunctions {
 	void setSplinePath(UniformCubicSpline &splinePath, TrajectoryPlanner &trajectoryPlan);
 	void setSplinePath(UniformCubicSpline &splinePath, TrajectoryPlanner &trajectoryPlan, CurveSampler &curveSampler);
 	void setPathToPctFactor(double factor = autonvals::tilesPerSecond_to_pct);
+	/// @brief Selects the gain-scheduled LTV controller instead of Ramsete for following paths.
+	void setPathFollowUseLtv(bool useLtv = true);
+	/// @brief Selects the horizon MPC instead of Ramsete for following paths.
+	void setPathFollowUseMpc(bool useMpc = true);
+	/// @brief Follows paths by adaptive pure pursuit on progress instead of tracking the timed trajectory.
+	void setPathFollowUsePurePursuit(bool usePursuit = true);
+	/// @brief Indexes the reference by the robot's progress along the path instead of by time.
+	void setPathFollowUseProgress(bool useProgress = true);
+	/// @brief Starts following the set path. A path that starts moving, set right after one that ended
+	/// moving, continues the previous path's timeline instead of restarting it.
 	void followSplinePath(bool reverseHeading = false);
+	/// @brief Follows the set path for one frame. Run by the "path follow" job, which `followSplinePath` enables.
+	void runPathFollowFrame();
 
-	extern timer _splinePathTimer;
+	extern vclock::Timer _splinePathTimer;
+	extern double _splinePathStartTime_seconds;
 	extern UniformCubicSpline _splinePath;
 	extern TrajectoryPlanner _trajectoryPlan;
 	extern CurveSampler _curveSampler;
@@ -20,6 +20,7 @@ namespace autonpaths {
 		extern const double maxVel;
 		extern const double maxAccel;
 		extern const double maxDecel;
+		extern const double maxJerk;
 
 		extern std::vector<UniformCubicSpline> splines;
 		extern std::vector<CurveSampler> splineSamplers;
@@ -30,6 +31,12 @@ namespace autonpaths {
 
 		void clearSplines();
 		void pushNewSpline(UniformCubicSpline spline, bool reverse = false, double maxVel = pathbuild::maxVel);
+		/// @brief Pushes splines that are followed back to back, each starting where the previous one ends.
+		/// Smooth joints are passed at the fastest speed the curvature and limits on both sides allow,
+		/// instead of stopping. Follow each with `runFollowSpline` as soon as the previous one completes.
+		/// A joint is smooth if the position moves under 0.02 tiles and the heading turns under 5 degrees across it.
+		/// The whole sequence drives in one direction. Other joints stop as with `pushNewSpline`.
+		void pushNewSplineSequence(std::vector<UniformCubicSpline> sequence, bool reverse = false, double maxVel = pathbuild::maxVel);
 		void runFollowSpline();
 
 		extern std::vector<std::vector<std::vector<double>>> linearPaths;
@@ -57,6 +64,8 @@ namespace autonpaths {
 
 	void autonTest();
 	void odometryRadiusTest();
+	void turnProfileTest();
+	void systemIdentification();
 
 	void runAutonRedUp();
 	void runAutonRedUpSafe();
@@ -3,7 +3,7 @@
 #include <string>
 
 namespace rumble {
-	void runThread();
+	void runFrame();
 
 	void setConstantRumbling(bool willRumble);
 
@@ -6,6 +6,15 @@
 #include <vector>
 
 
+// Point sampled at a uniform arc length
+
+struct CurvePoint {
+	double x, y;
+	double distance;
+	double curvature;
+};
+
+
 // Class
 
 class CurveSampler {
@@ -31,6 +40,9 @@ public:
 	double paramToDistance(double t);
 	double distanceToParam(double distance);
 
+	/// @brief Samples points spaced uniformly by arc length, including both endpoints.
+	std::vector<CurvePoint> getUniformPoints(double spacing);
+
 private:
 	std::vector<std::pair<double, double>> t_cumulativeDistances;
 	UniformCubicSpline spline;
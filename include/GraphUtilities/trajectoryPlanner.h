@@ -44,15 +44,48 @@ public:
 	std::vector<std::pair<double, std::vector<double>>> _getBackwardKinematics();
 	trajectory::merged_kinematics _getMergedForwardBackward();
 	std::vector<std::pair<double, std::vector<double>>> _getCombinedKinematics();
+	/// @brief Limits the rate of change of acceleration, giving S-curve velocity. Call before `calculateMotion`.
+	/// Acceleration steps are spread over a moving window. Where the rounded profile passes a velocity constraint,
+	/// it is clamped to the constraint and the acceleration passes run again.
+	TrajectoryPlanner &setMaxJerk(double maxJerk);
+
+	/// @brief Starts and ends the motion at the given velocities instead of at rest. Call before `calculateMotion`.
+	/// Each velocity is capped by the constraint at its end, and must be reachable within the distance.
+	TrajectoryPlanner &setBoundaryVelocities(double startVelocity, double endVelocity);
+
 	TrajectoryPlanner &calculateMotion();
+	void _setShiftedConstraints(
+		std::vector<std::pair<double, std::vector<double>>> &originalConstraints,
+		double startShift, double shiftedDistance
+	);
+	bool _calculateSteppedMotion();
+	void _applyJerkLimit(double window);
+	void _clampToConstraints();
 
 	std::vector<double> getMotionAtTime(double time);
 
+	/// @brief Returns the planned {distance, velocity, acceleration} once the given distance is reached.
+	std::vector<double> getMotionAtDistance(double distance);
+
 	double getTotalTime();
+	double getStartVelocity();
+	double getEndVelocity();
+
+	/// @brief Returns the velocity constraint at a distance, or 0 if there are no constraints.
+	double getMaxVelocityAtDistance(double distance);
 
 private:
 	std::vector<std::pair<double, std::vector<double>>> distance_motionConstraints;
 
+	// Time to {distance, velocity, acceleration, jerk}
 	std::vector<std::pair<double, std::vector<double>>> time_kinematics;
 	double totalDistance;
+	double maxJerk;
+	double startVelocity, endVelocity;
+
+	std::vector<double> _getSegmentMotion(std::vector<double> &nodeKinematics, double segmentDeltaTime);
+	std::vector<double> _getSteppedMotionAtTime(std::vector<std::pair<double, std::vector<double>>> &steppedKinematics, double time);
+	double _getReachableVelocity(double fromVelocity, bool isBackward);
+	int _getConstraintIndex(double distance);
+	double _getMinVelocityConstraint(double startDistance, double endDistance);
 };
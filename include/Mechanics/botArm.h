@@ -1,7 +1,7 @@
 #pragma once
 
 namespace botarm {
-	void runThread();
+	void runFrame();
 
 	void preauton();
 
@@ -18,7 +18,4 @@ namespace botarm {
 	void control(int);
 
 	bool canControl();
-
-	extern double _taskState;
-	extern double _taskDelay;
 }
@@ -5,8 +5,5 @@ namespace botarmpneu {
 
 	void switchState();
 
-	extern int _taskState;
-	extern double _taskDelay;
-
 	extern double pressedCount;
 }
@@ -1,12 +1,14 @@
 #pragma once
 
+#include "vex.h"
+
 namespace botdrive {
 	enum controlType {
 		ArcadeTwoStick,
 		ArcadeSingleStick,
 	};
 
-	void runThread();
+	void runFrame();
 
 	void preauton();
 
@@ -18,6 +20,12 @@ namespace botdrive {
 	double getMaxDriveVelocity();
 
 	void driveLinegularVelocity(double linearVelocity_pct, double angularVelocity_radPerSecond);
+	/// @brief Drives at a velocity and acceleration in physical units, with voltage from the drivetrain feedforward.
+	void driveLinegularMotion(
+		double linearVelocity_tilesPerSecond, double angularVelocity_radPerSecond,
+		double linearAcceleration_tilesPerSecondSquared = 0, double angularAcceleration_radPerSecondSquared = 0
+	);
 	void driveVelocity(double leftVelocityPct, double rightVelocityPct);
 	void driveVoltage(double leftVoltageVolt, double rightVoltageVolt, double clampMaxVoltage);
+	void stopDrive(brakeType mode);
 }
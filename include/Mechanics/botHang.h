@@ -4,7 +4,4 @@ namespace bothang {
 void setState(bool, double = 0);
 
 void switchState();
-
-extern int _taskState;
-extern double _taskDelay;
 }  // namespace bothang
@@ -3,7 +3,7 @@
 #include <string>
 
 namespace botintake {
-	void runThread();
+	void runFrame();
 
 	void preauton();
 
@@ -28,13 +28,4 @@ namespace botintake {
 	void control(int, int);
 
 	bool canControl();
-
-	extern int _taskState;
-	extern double _taskDelay;
-
-	extern bool _colorFilterTaskState;
-	extern double _colorFilterTaskDelay;
-
-	extern bool _storeRingTaskState;
-	extern double _storeRingTaskDelay;
 }
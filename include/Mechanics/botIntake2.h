@@ -3,7 +3,7 @@
 #include <string>
 
 namespace botintake2 {
-	void runThread();
+	void runFrame();
 
 	void preauton();
 
@@ -24,7 +24,4 @@ namespace botintake2 {
 	void control(int, int);
 
 	bool canControl();
-
-	extern int _taskState;
-	extern double _taskDelay;
 }
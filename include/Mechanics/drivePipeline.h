@@ -0,0 +1,42 @@
+#pragma once
+
+#include "vex.h"
+
+/**
+ * @brief Final stage between the drive controllers and the drive motors.
+ *
+ * Commands pass through, in order:
+ * desaturation to the available voltage, per-side slew and jerk limiting,
+ * battery compensation, then deduplication of unchanged commands.
+ * Slew and jerk limiting only applies to commands that ask for it, such as driver control.
+ */
+namespace drivepipeline {
+	enum DesaturationPriority {
+		// Scale both sides equally, keeping the commanded curvature
+		PreserveCurvature,
+		// Keep the turning voltage, reducing the forward voltage first
+		PreserveAngular,
+	};
+
+	struct Config {
+		double maxSlew_voltPerSecond;
+		double maxJerk_voltPerSecondSquared;
+		DesaturationPriority priority;
+		bool compensateBattery;
+		double nominalBattery_volt;
+		double dedupeTolerance_volt;
+	};
+
+	void setConfig(Config config);
+	Config getConfig();
+
+	/// @brief Sends a voltage to each side, limited to clampMaxVoltage.
+	/// @param isSlewLimited Whether to limit the slew and jerk, otherwise the voltage passes through.
+	void submitVoltage(double leftVoltage_volt, double rightVoltage_volt, double clampMaxVoltage_volt = 12, bool isSlewLimited = false);
+
+	/// @brief Stops both sides and clears the limiter state.
+	void submitStop(brakeType mode);
+
+	/// @brief Clears the limiter and deduplication state.
+	void reset();
+}
@@ -12,7 +12,4 @@ namespace goalclamp {
 	void control();
 
 	bool canControl();
-
-	extern int _taskState;
-	extern double _taskDelay;
 }
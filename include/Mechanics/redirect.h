@@ -13,7 +13,4 @@ namespace redirect {
 	void control(int);
 
 	bool canControl();
-
-	extern int _taskState;
-	extern double _taskDelay;
 }  // namespace redirect
@@ -12,7 +12,4 @@ namespace samplemech {
 	void control(int);
 
 	bool canControl();
-
-	extern int _taskState;
-	extern double _taskDelay;
 }
@@ -14,7 +14,4 @@ namespace swing {
 	void control(int);
 
 	bool canControl();
-
-	extern int _taskState;
-	extern double _taskDelay;
 }
@@ -0,0 +1,131 @@
+#pragma once
+
+/**
+ * @brief Fixed-step dynamic model of the differential drivetrain.
+ *
+ * Each side's motors follow the V5 torque/speed line with the firmware current limit,
+ * driven by a voltage relative to a full battery like `motor::spin(volt)`. The torque
+ * goes through the gear ratio to the wheels, which grip the ground up to the traction
+ * limit and slip past it. The chassis has mass and rotational inertia, and the battery
+ * sags with the total current drawn.
+ *
+ * The model steps at a fixed time step and reads no clock, so the same commands give the
+ * same motion on the brain and on the host.
+ */
+class DriveDynamicsModel {
+public:
+	struct Config {
+		// Drivetrain
+		int motorCountPerSide;
+		double motorFreeSpeed_rpm;
+		double motorStallTorque_newtonMeters;
+		double motorCurrentLimit_amps;
+		double motorFrictionVoltage_volt;
+		double wheelToMotorGearRatio;
+		double gearEfficiency;
+		double wheelDiameter_meters;
+		double trackWidth_meters;
+		double lookWheelDiameter_meters;
+		double lateralWheelDiameter_meters;
+		double lateralWheelBackOffset_meters;
+
+		// Chassis
+		double mass_kilograms;
+		double momentOfInertia_kilogramMetersSquared;
+		double sideRotatingMass_kilograms;
+		double tractionCoefficient;
+
+		// Battery
+		double batteryOpenVoltage_volt;
+		double batteryResistance_ohms;
+
+		double timeStep_seconds;
+	};
+
+	/// @brief Returns the robot's config, with the drivetrain geometry from `botinfo`.
+	/// The mass and inertia are sized so the drive's feedforward kA holds in the model.
+	static Config getDefaultConfig();
+
+	DriveDynamicsModel();
+	DriveDynamicsModel(Config config);
+
+	void setConfig(Config config);
+	Config getConfig();
+
+	/// @brief Puts the robot at rest at a pose, and clears the sensors.
+	void reset(double x_tiles, double y_tiles, double polarAngle_radians);
+	/// @brief Moves the robot to a pose, keeping its velocities.
+	void setPose(double x_tiles, double y_tiles, double polarAngle_radians);
+
+	/// @brief Commands each side's motors, in volts relative to a full battery.
+	void setVoltage(double leftVoltage_volt, double rightVoltage_volt);
+	/// @brief Stops each side's motors, braking through the motor or coasting.
+	void stop(bool isCoast);
+
+	/// @brief Runs the whole time steps that fit in the time, carrying the remainder to the next call.
+	void advance(double deltaTime_seconds);
+	void step();
+
+	// Pose
+	double getX_tiles();
+	double getY_tiles();
+	double getPolarAngle_radians();
+	double getLinearVelocity_tilesPerSecond();
+	double getAngularVelocity_radiansPerSecond();
+	double getElapsedTime_seconds();
+
+	// Simulated sensors
+	double getLeftMotorPosition_revolutions();
+	double getRightMotorPosition_revolutions();
+	double getLeftMotorVelocity_pct();
+	double getRightMotorVelocity_pct();
+	double getLeftCurrent_amps();
+	double getRightCurrent_amps();
+	/// @brief Rotation of an unpowered tracking wheel at the center, which doesn't slip.
+	double getLookWheelPosition_revolutions();
+	/// @brief Rotation of an unpowered tracking wheel measuring rightward, behind the center by its offset.
+	/// The drive doesn't slide sideways, so it only turns with the robot.
+	double getLateralWheelPosition_revolutions();
+	/// @brief Clockwise heading, like `inertial::rotation`.
+	double getInertialRotation_degrees();
+	double getBatteryVoltage_volt();
+
+	bool isLeftSlipping();
+	bool isRightSlipping();
+
+private:
+	struct SideState {
+		double command_volt;
+		bool isStopped, isCoast;
+
+		double wheelVelocity_metersPerSecond;
+		double wheelDistance_meters;
+		double current_amps, batteryCurrent_amps;
+		bool isSlipping;
+	};
+
+	void _ensureConfig();
+	double _getMotorForce(SideState &side);
+	void _solveTraction(double leftForce, double rightForce, double &leftTraction, double &rightTraction);
+
+	Config config;
+	bool isConfigured;
+
+	// Derived motor constants
+	double backEmf_voltSecondsPerRadian;
+	double torque_newtonMetersPerAmp;
+	double resistance_ohms;
+
+	// Chassis state, in meters
+	double x_meters, y_meters, polarAngle_radians;
+	double linearVelocity_metersPerSecond, angularVelocity_radiansPerSecond;
+	double lookDistance_meters;
+	double lateralDistance_meters;
+	double turnedAngle_radians;
+
+	SideState leftSide, rightSide;
+	double batteryVoltage_volt;
+
+	double elapsed_seconds;
+	double remainder_seconds;
+};
@@ -1,14 +1,18 @@
 #pragma once
 
 #include "Simulation/vector3.h"
-#include "vex.h"
+#include "Simulation/driveDynamicsModel.h"
+#include "Utilities/virtualClock.h"
 
 class RobotSimulator {
 public:
 	RobotSimulator();
 
 	void resetTimer();
+	/// @brief Steps the drive model by the time since the last update, and copies its motion.
+	/// The pose may be set directly between updates, the model continues from it.
 	void updatePhysics();
+	void updatePhysics(double deltaTime_seconds);
 
 	void setDistance(double distance);
 	void updateDistance();
@@ -18,8 +22,11 @@ public:
 
 	double travelledDistance;
 
+	// Receives the drive voltages and provides the simulated sensors
+	DriveDynamicsModel driveModel;
+
 private:
-	timer physicsTimer;
+	vclock::Timer physicsTimer;
 	Vector3 previousPosition;
 	double lastUpdateTime = 0;
 };
@@ -0,0 +1,31 @@
+#pragma once
+
+/**
+ * @brief Fires delayed actions from a hashed timer wheel.
+ *
+ * Each action is stored with the value it is called with, so no global is shared between calls.
+ * Scheduling, cancelling and rescheduling are O(1). Actions fire from the scheduler's task,
+ * at the first dispatcher frame after their delay, and must not block.
+ */
+namespace dispatcher {
+	typedef void (*Action)(double value);
+
+	// Wheel resolution, matching the scheduler's tick
+	const int tickPeriod_msec = 5;
+
+	/// @brief Schedules an action to be called with a value after a delay.
+	/// @return A handle to the action, or -1 if too many actions are pending.
+	int schedule(double delay_seconds, Action action, double value = 0);
+
+	/// @brief Cancels a pending action. Returns false if it has already fired or been cancelled.
+	bool cancel(int handle);
+
+	/// @brief Moves a pending action to fire after a new delay from now.
+	bool reschedule(int handle, double delay_seconds);
+
+	bool isPending(int handle);
+	int getPendingCount();
+
+	/// @brief Fires the actions that are due. Called every tick by the scheduler.
+	void runFrame();
+}
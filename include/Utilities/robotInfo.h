@@ -15,4 +15,12 @@ namespace botinfo {
 	extern const double trackingLookWheelSensorGearRatio;
 
 	extern const double chassisMotorRpm;
+
+	// Drivetrain feedforward per side (volts, tiles per second, tiles per second squared)
+	extern const double driveLeftKs_volt;
+	extern const double driveLeftKv_voltPerTilesPerSecond;
+	extern const double driveLeftKa_voltPerTilesPerSecondSquared;
+	extern const double driveRightKs_volt;
+	extern const double driveRightKv_voltPerTilesPerSecond;
+	extern const double driveRightKa_voltPerTilesPerSecondSquared;
 }
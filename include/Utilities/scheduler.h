@@ -0,0 +1,62 @@
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * @brief Runs periodic jobs from a single fixed-rate task.
+ *
+ * Jobs run at their declared period and, within a tick, in ascending order.
+ * Each job's execution time and release jitter are measured, and a job that
+ * doesn't finish before its next release is counted as a deadline overrun.
+ */
+namespace scheduler {
+	typedef void (*JobCallback)();
+
+	// Declared ordering within a tick
+	namespace order {
+		const int Simulation = -10;
+		const int Odometry = 0;
+		const int PathFollow = 10;
+		const int Commands = 15;
+		const int Drive = 20;
+		const int Dispatch = 25;
+		const int Mechanism = 30;
+		const int Feedback = 40;
+	}
+
+	// Base tick, all job periods are rounded up to a multiple of it
+	const int tickPeriod_msec = 5;
+
+	struct JobStats {
+		const char *name;
+		int period_msec;
+		int order;
+		uint32_t runCount;
+		uint32_t overrunCount;
+		double meanExecution_microseconds, maxExecution_microseconds;
+		double meanJitter_microseconds, maxJitter_microseconds;
+	};
+
+	/// @brief Registers a periodic job. Must not be called from inside a job.
+	/// @return The job's id, or -1 if the job table is full.
+	int addJob(const char *name, JobCallback callback, int period_msec, int order);
+	void setJobEnabled(int jobId, bool isEnabled);
+
+	/// @brief Returns the id of the first job with the name, or -1 if there is none.
+	int findJob(const char *name);
+
+	/// @brief Starts the scheduler task. Jobs may still be added afterwards.
+	void start();
+
+	/// @brief Runs the jobs released by a tick. Used as the stepped clock's tick callback,
+	/// the scheduler task pauses while the clock is stepped.
+	void tick(uint64_t tickStart_microseconds);
+
+	int getJobCount();
+	bool getJobStats(int jobId, JobStats &stats);
+	uint32_t getTickOverrunCount();
+	void resetStats();
+
+	/// @brief Prints every job's timing to the terminal.
+	void printStats();
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+// Generated by tools/sysidFit.py, don't edit by hand
+// Source: defaults
+
+namespace sysidconstants {
+	// DriveLeft, defaults
+	const double driveLeftKs_volt = 0.8000;
+	const double driveLeftKv_voltPerTilesPerSecond = 3.000000;
+	const double driveLeftKa_voltPerTilesPerSecondSquared = 0.600000;
+	const double driveLeftMaxVelocity_tilesPerSecond = 3.7000;
+	const double driveLeftMaxAcceleration_tilesPerSecondSquared = 4.0000;
+
+	// DriveRight, defaults
+	const double driveRightKs_volt = 0.8000;
+	const double driveRightKv_voltPerTilesPerSecond = 3.000000;
+	const double driveRightKa_voltPerTilesPerSecondSquared = 0.600000;
+	const double driveRightMaxVelocity_tilesPerSecond = 3.7000;
+	const double driveRightMaxAcceleration_tilesPerSecondSquared = 4.0000;
+
+	// Arm, defaults
+	const double armKs_volt = 0.5000;
+	const double armKv_voltPerDegreesPerSecond = 0.020000;
+	const double armKa_voltPerDegreesPerSecondSquared = 0.002000;
+	// Holds the arm level, scaled by the cosine of its angle above horizontal
+	const double armKg_volt = 0.0000;
+	const double armGearRatio = 1.0000;
+	const double armZeroAngle_degrees = -45.0000;
+	const double armMaxVelocity_degreesPerSecond = 500.0000;
+	const double armMaxAcceleration_degreesPerSecondSquared = 3000.0000;
+
+	// Intake, defaults
+	const double intakeKs_volt = 0.5000;
+	const double intakeKv_voltPerDegreesPerSecond = 0.003000;
+	const double intakeKa_voltPerDegreesPerSecondSquared = 0.000300;
+	const double intakeMaxVelocity_degreesPerSecond = 3600.0000;
+	const double intakeMaxAcceleration_degreesPerSecondSquared = 20000.0000;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+/**
+ * @brief Records system identification samples and saves them to the SD card.
+ *
+ * The file starts with a header {"SYID", uint16 version, uint16 record size},
+ * followed by little-endian records of
+ * {uint32 time (us), uint8 mechanism, uint8 test, uint16 reserved, float voltage, float velocity, float position}.
+ * Fit the samples with tools/sysidFit.py.
+ */
+namespace sysid {
+	enum Mechanism {
+		DriveLeft, // tiles, tiles per second
+		DriveRight, // tiles, tiles per second
+		Arm, // motor degrees, degrees per second
+		Intake, // motor degrees, degrees per second
+	};
+
+	enum Test {
+		QuasistaticForward,
+		QuasistaticReverse,
+		StepForward,
+		StepReverse,
+	};
+
+	const int fileVersion = 1;
+	const int recordSize = 20;
+	const int maxRecordCount = 12000;
+
+	/// @brief Clears the recorded samples and restarts the time base.
+	void begin();
+
+	/// @brief Records one sample. Returns false when the buffer is full.
+	bool record(Mechanism mechanism, Test test, double voltage_volt, double velocity, double position);
+
+	int getRecordCount();
+
+	/// @brief Writes the header and samples to a file on the SD card.
+	bool save(const char *fileName);
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "vex.h"
+
+#include <stdint.h>
+
+/**
+ * @brief Scoped timing probes for the control loops.
+ *
+ * Each probe aggregates min / mean / max and a fixed-bucket histogram of its samples.
+ * A probe is written by one task only, so its counters are plain fields read without a lock.
+ * Readers may see a snapshot that is one sample behind.
+ */
+namespace timing {
+	enum ProbeId {
+		OdometryFrame,
+		IntakeFrame,
+		ArmResolve,
+		PathFollowFrame,
+		SchedulerWake, // lateness of the scheduler's wake-up after its sleep
+		probeCount,
+	};
+
+	// Histogram bucket upper bounds, the last bucket holds everything above
+	const int bucketCount = 8;
+	const uint32_t bucketUpperBounds_microseconds[bucketCount - 1] = {50, 100, 250, 500, 1000, 2500, 5000};
+
+	struct ProbeStats {
+		uint32_t sampleCount;
+		uint32_t min_microseconds, max_microseconds;
+		uint64_t total_microseconds;
+		uint32_t bucketCounts[bucketCount];
+	};
+
+	void recordSample(int probeId, uint32_t duration_microseconds);
+
+	const char *getProbeName(int probeId);
+	const ProbeStats &getProbeStats(int probeId);
+	double getMean_microseconds(int probeId);
+	void resetStats();
+
+	/// @brief Prints every probe's timing to the terminal.
+	void printStats();
+
+	/// @brief Times the enclosing scope into a probe.
+	class ScopedProbe {
+	public:
+		ScopedProbe(int probeId) {
+			this->probeId = probeId;
+			start_microseconds = timer::systemHighResolution();
+		}
+
+		~ScopedProbe() {
+			recordSample(probeId, (uint32_t) (timer::systemHighResolution() - start_microseconds));
+		}
+
+	private:
+		int probeId;
+		uint64_t start_microseconds;
+	};
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * @brief Clock and sleep for the control code.
+ *
+ * By default it follows the system clock and sleeps the task.
+ * While stepped, time only moves when the stepping task sleeps. The sleep advances the
+ * clock tick by tick and runs the tick callback at every tick, the way the scheduler
+ * task would, so a routine runs through the same instants as on the robot, only as fast
+ * as the processor allows. Other tasks still sleep in real time.
+ */
+namespace vclock {
+	/// @brief Called at the start of every tick while stepped.
+	typedef void (*TickCallback)(uint64_t tickStart_microseconds);
+
+	// System clock, defined per platform (virtualClockPlatform.cpp on the brain)
+	namespace platform {
+		uint64_t getTime_microseconds();
+		void sleep(uint32_t msec);
+		void yield();
+		int32_t getTaskId();
+	}
+
+	uint64_t getTime_microseconds();
+	double getTime_seconds();
+
+	/// @brief Sleeps the task, or advances the clock if the task is stepping it.
+	void sleep(uint32_t msec);
+
+	/// @brief Freezes the clock at its current time. Only the calling task moves it afterwards.
+	void startStepping(TickCallback tickCallback, int tickPeriod_msec);
+	/// @brief Returns to the system clock, continuing from the stepped time.
+	void stopStepping();
+	bool isStepping();
+
+	/// @brief Moves the stepped clock forward, running every tick on the way.
+	/// A sleep from inside a tick moves the time without running ticks, like a job that blocks the scheduler.
+	void advance(uint64_t deltaTime_microseconds);
+
+	/// @brief Stopwatch on the clock, a drop-in for `vex::timer`.
+	class Timer {
+	public:
+		Timer();
+
+		void reset();
+		void clear();
+
+		/// @brief Elapsed seconds since the last reset.
+		double value();
+		/// @brief Elapsed milliseconds since the last reset.
+		uint32_t time();
+
+	private:
+		uint64_t start_microseconds;
+	};
+}
+
+/// @brief Like `waitUntil`, polling on the clock.
+#define clockWaitUntil(condition)                                              \
+	do {                                                                         \
+		vclock::sleep(5);                                                          \
+	} while (!(condition))
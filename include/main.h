@@ -30,6 +30,7 @@ extern Odometry mainOdometry;
 // Simulator
 extern RobotSimulator robotSimulator;
 extern bool mainUseSimulator;
+extern bool mainUseSteppedClock;
 
 // Trajectory
 extern TrajectoryPlanner testTrajectoryPlan;
@@ -0,0 +1,39 @@
+#include "AutonUtilities/alphaBetaFilter.h"
+
+AlphaBetaFilter::AlphaBetaFilter(double alpha, double beta) {
+	setGains(alpha, beta);
+	reset();
+}
+
+void AlphaBetaFilter::setGains(double alpha, double beta) {
+	this->alpha = alpha;
+	this->beta = beta;
+}
+
+void AlphaBetaFilter::reset(double value, double rate) {
+	estimatedValue = value;
+	estimatedRate = rate;
+}
+
+void AlphaBetaFilter::update(double measuredValue, double deltaTime_seconds) {
+	// Ignore invalid time steps
+	if (deltaTime_seconds <= 0) {
+		return;
+	}
+
+	// Predict
+	double predictedValue = estimatedValue + estimatedRate * deltaTime_seconds;
+
+	// Correct with residual
+	double residual = measuredValue - predictedValue;
+	estimatedValue = predictedValue + alpha * residual;
+	estimatedRate += (beta / deltaTime_seconds) * residual;
+}
+
+double AlphaBetaFilter::getValue() {
+	return estimatedValue;
+}
+
+double AlphaBetaFilter::getRate() {
+	return estimatedRate;
+}
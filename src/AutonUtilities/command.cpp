@@ -0,0 +1,310 @@
+#include "AutonUtilities/command.h"
+
+#include "Utilities/virtualClock.h"
+
+#include "main.h"
+
+namespace {
+	// Executor queues
+	const int maxCommandCount = 16;
+
+	Command *pendingCommands[maxCommandCount];
+	int pendingCommandCount = 0;
+
+	Command *runningCommands[maxCommandCount];
+	int runningCommandCount = 0;
+
+	// Commands taken from the queue and not yet running
+	int startingCommandCount = 0;
+
+	// Ids of the queued, starting and running commands, for other tasks to read
+	// Guarded by pendingMutex, with the queue
+	int pendingIds[maxCommandCount];
+	int startingIds[maxCommandCount];
+	int runningIds[maxCommandCount];
+	mutex pendingMutex;
+
+	int nextCommandId = 0;
+	volatile bool isCancelAllRequested = false;
+
+	void startPendingCommands();
+	void endRunningCommand(int runningIndex, bool isInterrupted);
+}
+
+
+// Sequential group
+
+SequentialCommandGroup::SequentialCommandGroup(std::initializer_list<Command *> commands) {
+	this->commands = std::vector<Command *>(commands);
+	currentIndex = 0;
+	for (Command *command : this->commands) {
+		requirements |= command->getRequirements();
+	}
+}
+
+SequentialCommandGroup::~SequentialCommandGroup() {
+	for (Command *command : commands) {
+		delete command;
+	}
+}
+
+void SequentialCommandGroup::initialize() {
+	currentIndex = 0;
+	if (currentIndex < (int) commands.size()) {
+		commands[currentIndex]->initialize();
+	}
+}
+
+void SequentialCommandGroup::execute() {
+	if (currentIndex >= (int) commands.size()) {
+		return;
+	}
+
+	// Step current command
+	Command *command = commands[currentIndex];
+	command->execute();
+	if (!command->isFinished()) {
+		return;
+	}
+
+	// Move to the next command
+	command->end(false);
+	currentIndex++;
+	if (currentIndex < (int) commands.size()) {
+		commands[currentIndex]->initialize();
+	}
+}
+
+bool SequentialCommandGroup::isFinished() {
+	return currentIndex >= (int) commands.size();
+}
+
+void SequentialCommandGroup::end(bool isInterrupted) {
+	if (isInterrupted && currentIndex < (int) commands.size()) {
+		commands[currentIndex]->end(true);
+	}
+}
+
+
+// Parallel group
+
+ParallelCommandGroup::ParallelCommandGroup(std::initializer_list<Command *> commands, EndCondition endCondition) {
+	this->commands = std::vector<Command *>(commands);
+	this->endCondition = endCondition;
+	isRunning = std::vector<bool>(this->commands.size(), false);
+	isGroupFinished = false;
+	for (Command *command : this->commands) {
+		requirements |= command->getRequirements();
+	}
+}
+
+ParallelCommandGroup::~ParallelCommandGroup() {
+	for (Command *command : commands) {
+		delete command;
+	}
+}
+
+void ParallelCommandGroup::initialize() {
+	isGroupFinished = commands.empty();
+	for (int i = 0; i < (int) commands.size(); i++) {
+		commands[i]->initialize();
+		isRunning[i] = true;
+	}
+}
+
+void ParallelCommandGroup::execute() {
+	bool isAllFinished = true;
+	for (int i = 0; i < (int) commands.size(); i++) {
+		if (!isRunning[i]) {
+			continue;
+		}
+
+		// Step command
+		commands[i]->execute();
+		if (!commands[i]->isFinished()) {
+			isAllFinished = false;
+			continue;
+		}
+		commands[i]->end(false);
+		isRunning[i] = false;
+
+		// Check end condition
+		if (endCondition == AnyFinished || (endCondition == FirstFinished && i == 0)) {
+			isGroupFinished = true;
+		}
+	}
+	if (isAllFinished) {
+		isGroupFinished = true;
+	}
+}
+
+bool ParallelCommandGroup::isFinished() {
+	return isGroupFinished;
+}
+
+void ParallelCommandGroup::end(bool isInterrupted) {
+	// Interrupt unfinished commands
+	for (int i = 0; i < (int) commands.size(); i++) {
+		if (isRunning[i]) {
+			commands[i]->end(true);
+			isRunning[i] = false;
+		}
+	}
+}
+
+
+// Executor
+
+namespace commands {
+	int schedule(Command *command) {
+		pendingMutex.lock();
+		if (pendingCommandCount >= maxCommandCount) {
+			pendingMutex.unlock();
+			delete command;
+			return -1;
+		}
+		int commandId = nextCommandId++;
+		command->setId(commandId);
+		pendingIds[pendingCommandCount] = commandId;
+		pendingCommands[pendingCommandCount] = command;
+		pendingCommandCount++;
+		pendingMutex.unlock();
+		return commandId;
+	}
+
+	void runAndWait(Command *command) {
+		int commandId = schedule(command);
+		while (isRunning(commandId)) {
+			vclock::sleep(5);
+		}
+	}
+
+	void cancelAll() {
+		// Drop the queue, the executor interrupts the rest
+		pendingMutex.lock();
+		for (int i = 0; i < pendingCommandCount; i++) {
+			delete pendingCommands[i];
+		}
+		pendingCommandCount = 0;
+		isCancelAllRequested = true;
+		pendingMutex.unlock();
+	}
+
+	bool isRunning(int commandId) {
+		if (commandId < 0) {
+			return false;
+		}
+		bool isFound = false;
+		pendingMutex.lock();
+		for (int i = 0; i < pendingCommandCount; i++) {
+			isFound = isFound || pendingIds[i] == commandId;
+		}
+		for (int i = 0; i < startingCommandCount; i++) {
+			isFound = isFound || startingIds[i] == commandId;
+		}
+		for (int i = 0; i < runningCommandCount; i++) {
+			isFound = isFound || runningIds[i] == commandId;
+		}
+		pendingMutex.unlock();
+		return isFound;
+	}
+
+	bool isIdle() {
+		pendingMutex.lock();
+		bool isEmpty = pendingCommandCount == 0 && startingCommandCount == 0 && runningCommandCount == 0;
+		pendingMutex.unlock();
+		return isEmpty;
+	}
+
+	void runFrame() {
+		// Cancel
+		if (isCancelAllRequested) {
+			isCancelAllRequested = false;
+			while (runningCommandCount > 0) {
+				endRunningCommand(runningCommandCount - 1, true);
+			}
+		}
+
+		// Start new commands
+		startPendingCommands();
+
+		// Step running commands
+		int runningIndex = 0;
+		while (runningIndex < runningCommandCount) {
+			Command *command = runningCommands[runningIndex];
+			command->execute();
+			if (command->isFinished()) {
+				endRunningCommand(runningIndex, false);
+			} else {
+				runningIndex++;
+			}
+		}
+	}
+}
+
+namespace {
+	/// @brief Starts the scheduled commands, interrupting those with shared requirements.
+	void startPendingCommands() {
+		// Take the queue, so commands may schedule while starting
+		// Taken commands stay listed as starting until they run
+		Command *startCommands[maxCommandCount];
+		pendingMutex.lock();
+		startingCommandCount = pendingCommandCount;
+		for (int i = 0; i < startingCommandCount; i++) {
+			startCommands[i] = pendingCommands[i];
+			startingIds[i] = pendingIds[i];
+		}
+		pendingCommandCount = 0;
+		pendingMutex.unlock();
+
+		for (int i = 0; i < startingCommandCount; i++) {
+			Command *command = startCommands[i];
+
+			// Interrupt conflicting commands
+			int runningIndex = 0;
+			while (runningIndex < runningCommandCount) {
+				if (runningCommands[runningIndex]->getRequirements() & command->getRequirements()) {
+					endRunningCommand(runningIndex, true);
+				} else {
+					runningIndex++;
+				}
+			}
+
+			// Start command
+			pendingMutex.lock();
+			startingIds[i] = -1;
+			bool isStarted = runningCommandCount < maxCommandCount;
+			if (isStarted) {
+				runningIds[runningCommandCount] = command->getId();
+				runningCommands[runningCommandCount] = command;
+				runningCommandCount++;
+			}
+			pendingMutex.unlock();
+			if (!isStarted) {
+				delete command;
+				continue;
+			}
+			command->initialize();
+		}
+
+		pendingMutex.lock();
+		startingCommandCount = 0;
+		pendingMutex.unlock();
+	}
+
+	/// @brief Ends a running command and removes it, keeping the run order.
+	void endRunningCommand(int runningIndex, bool isInterrupted) {
+		Command *command = runningCommands[runningIndex];
+		command->end(isInterrupted);
+
+		// Listed as running until it has ended
+		pendingMutex.lock();
+		for (int i = runningIndex; i < runningCommandCount - 1; i++) {
+			runningCommands[i] = runningCommands[i + 1];
+			runningIds[i] = runningIds[i + 1];
+		}
+		runningCommandCount--;
+		pendingMutex.unlock();
+		delete command;
+	}
+}
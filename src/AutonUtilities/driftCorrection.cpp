@@ -1,37 +1,167 @@
 #include "AutonUtilities/driftCorrection.h"
 
+#include "Utilities/generalUtility.h"
+#include "Utilities/virtualClock.h"
+
+// File-local variables
+
+namespace {
+	// Stationary time required before the gyro rate is treated as bias
+	const double stationarySettleTime_seconds = 0.25;
+
+	// Time constant of the bias low-pass filter
+	const double biasTimeConstant_seconds = 2.0;
+	const double maxBias_degreesPerSecond = 0.5;
+
+	// Scale estimation
+	const double scalePriorWeight = 720.0; // squared degrees
+	const double scaleForgetFactor = 0.9995;
+	const double scaleMinDelta_degrees = 0.05;
+	const double minScale = 0.9;
+	const double maxScale = 1.1;
+}
+
+
+// Public functions
+
 DriftCorrection::DriftCorrection(inertial &sensor, double perClockwiseRevolutionDrift, double perCCWRevolutionDrift) {
 	this->sensor = &sensor;
+	this->rotationCallback = nullptr;
+	this->perClockwiseRevolutionDrift = perClockwiseRevolutionDrift;
+	this->perCCWRevolutionDrift = perCCWRevolutionDrift;
+	_onInit();
+}
+
+DriftCorrection::DriftCorrection(double (*rotationCallback)(), double perClockwiseRevolutionDrift, double perCCWRevolutionDrift) {
+	this->sensor = nullptr;
+	this->rotationCallback = rotationCallback;
 	this->perClockwiseRevolutionDrift = perClockwiseRevolutionDrift;
 	this->perCCWRevolutionDrift = perCCWRevolutionDrift;
 	_onInit();
 }
 
 void DriftCorrection::_onInit() {
-	storedInitialRotation = sensor->rotation(deg);
+	storedInitialRotation = readRotation();
 	correctedRotation = storedInitialRotation;
+	storedTime_microseconds = vclock::getTime_microseconds();
+
+	stationaryHint = false;
+	stationaryDuration_seconds = 0;
+
+	bias_degreesPerSecond = 0;
+
+	// Use the per-revolution drifts as scale priors
+	hasReferenceDelta = false;
+	referenceDeltaRotation_degrees = 0;
+	clockwiseScaleSumXX = scalePriorWeight;
+	clockwiseScaleSumXY = scalePriorWeight * (1 - perClockwiseRevolutionDrift / 360.0);
+	ccwScaleSumXX = scalePriorWeight;
+	ccwScaleSumXY = scalePriorWeight * (1 + perCCWRevolutionDrift / 360.0);
 }
 
 void DriftCorrection::setInitial() {
-	storedInitialRotation = sensor->rotation();
+	storedInitialRotation = readRotation();
+	correctedRotation = storedInitialRotation;
+	storedTime_microseconds = vclock::getTime_microseconds();
+	stationaryDuration_seconds = 0;
+	hasReferenceDelta = false;
+}
+
+void DriftCorrection::setStationary(bool isStationary) {
+	stationaryHint = isStationary;
+}
+
+void DriftCorrection::setReferenceDeltaRotation(double referenceDeltaRotation_degrees) {
+	this->referenceDeltaRotation_degrees = referenceDeltaRotation_degrees;
+	hasReferenceDelta = true;
 }
 
 void DriftCorrection::correct() {
-	// Calculate change in rotation
-	double nowInitialRotation = sensor->rotation();
+	// Calculate change in rotation and time
+	double nowInitialRotation = readRotation();
 	double deltaRotation = nowInitialRotation - storedInitialRotation;
+	uint64_t nowTime_microseconds = vclock::getTime_microseconds();
+	double deltaTime_seconds = (nowTime_microseconds - storedTime_microseconds) * 1e-6;
 
-	// Calculate drifted rotation
-	double addRotation = deltaRotation / 360.0 * ((deltaRotation > 0) ? (-perClockwiseRevolutionDrift) : (perCCWRevolutionDrift));
-	double newRotation = nowInitialRotation + addRotation;
-	correctedRotation += addRotation;
-
-	// Update 
-	sensor->setRotation(newRotation, degrees);
+	// Update stored values
 	storedInitialRotation = nowInitialRotation;
+	storedTime_microseconds = nowTime_microseconds;
+
+	// Update stationary duration
+	if (stationaryHint) {
+		stationaryDuration_seconds += deltaTime_seconds;
+	} else {
+		stationaryDuration_seconds = 0;
+	}
+
+	// Zero-velocity update: the measured rate is bias, and the heading is held
+	if (stationaryDuration_seconds >= stationarySettleTime_seconds && deltaTime_seconds > 0) {
+		double measuredRate_degreesPerSecond = deltaRotation / deltaTime_seconds;
+		double biasGain = deltaTime_seconds / (biasTimeConstant_seconds + deltaTime_seconds);
+		bias_degreesPerSecond += biasGain * (measuredRate_degreesPerSecond - bias_degreesPerSecond);
+		bias_degreesPerSecond = genutil::clamp(bias_degreesPerSecond, -maxBias_degreesPerSecond, maxBias_degreesPerSecond);
+		hasReferenceDelta = false;
+		return;
+	}
+
+	// Remove bias
+	double unbiasedDelta = deltaRotation - bias_degreesPerSecond * fmax(0, deltaTime_seconds);
+
+	// Refine scales with the reference rotation
+	if (hasReferenceDelta) {
+		updateScaleSums(unbiasedDelta, referenceDeltaRotation_degrees);
+		hasReferenceDelta = false;
+	}
+
+	// Apply directional scale
+	double scale = (unbiasedDelta > 0) ? getClockwiseScale() : getCCWScale();
+	correctedRotation += unbiasedDelta * scale;
 }
 
 double DriftCorrection::getRotation() {
-	// return correctedRotation;
-	return sensor->rotation(deg);
+	return correctedRotation;
+}
+
+double DriftCorrection::getBias_degreesPerSecond() {
+	return bias_degreesPerSecond;
+}
+
+double DriftCorrection::getClockwiseScale() {
+	return genutil::clamp(clockwiseScaleSumXY / clockwiseScaleSumXX, minScale, maxScale);
+}
+
+double DriftCorrection::getCCWScale() {
+	return genutil::clamp(ccwScaleSumXY / ccwScaleSumXX, minScale, maxScale);
+}
+
+bool DriftCorrection::isStationary() {
+	return stationaryDuration_seconds >= stationarySettleTime_seconds;
+}
+
+
+// Private functions
+
+double DriftCorrection::readRotation() {
+	if (sensor != nullptr) {
+		return sensor->rotation(deg);
+	}
+	return rotationCallback();
+}
+
+void DriftCorrection::updateScaleSums(double measuredDelta_degrees, double referenceDelta_degrees) {
+	// Skip small rotations dominated by noise
+	if (std::fabs(measuredDelta_degrees) < scaleMinDelta_degrees) {
+		return;
+	}
+
+	// Least squares fit of reference = scale * measured, with forgetting
+	double xx = measuredDelta_degrees * measuredDelta_degrees;
+	double xy = measuredDelta_degrees * referenceDelta_degrees;
+	if (measuredDelta_degrees > 0) {
+		clockwiseScaleSumXX = clockwiseScaleSumXX * scaleForgetFactor + xx;
+		clockwiseScaleSumXY = clockwiseScaleSumXY * scaleForgetFactor + xy;
+	} else {
+		ccwScaleSumXX = ccwScaleSumXX * scaleForgetFactor + xx;
+		ccwScaleSumXY = ccwScaleSumXY * scaleForgetFactor + xy;
+	}
 }
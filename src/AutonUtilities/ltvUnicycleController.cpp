@@ -0,0 +1,60 @@
+#include "AutonUtilities/ltvUnicycleController.h"
+
+#include "AutonUtilities/linegular.h"
+#include "AutonUtilities/ltvUnicycleTable.h"
+#include "Utilities/generalUtility.h"
+
+#include <cmath>
+
+LtvUnicycleController::LtvUnicycleController() {}
+
+void LtvUnicycleController::setDirection(bool isReversed) {
+	if (isReversed) {
+		directionFactor = -1;
+	} else {
+		directionFactor = 1;
+	}
+}
+
+std::pair<double, double> LtvUnicycleController::getLinegularVelocity(
+	Linegular actual, Linegular desired,
+	double desiredLinearVelocity, double desiredAngularVelocity_radiansPerSecond
+) {
+	// Get local error
+	Linegular error = desired - actual;
+	error.rotateXYBy(genutil::toRadians(90 - actual.getThetaPolarAngle_degrees()));
+
+	// Get value alias
+	double v_desired = fabs(desiredLinearVelocity) * directionFactor;
+	double w_desired = desiredAngularVelocity_radiansPerSecond;
+	double e_forward = error.getY();
+	double e_left = -error.getX();
+	double e_theta = genutil::toRadians(genutil::modRange(error.getThetaPolarAngle_degrees(), 360, -180));
+
+	// Interpolate gains at the reference speed
+	double tablePosition = fabs(v_desired) / ltvtable::velocityStep_tilesPerSecond;
+	int lowIndex = (int) tablePosition;
+	if (lowIndex >= ltvtable::entryCount - 1) {
+		lowIndex = ltvtable::entryCount - 2;
+		tablePosition = ltvtable::entryCount - 1;
+	}
+	double ratio = tablePosition - lowIndex;
+	const double *lowGains = ltvtable::gains[lowIndex];
+	const double *highGains = ltvtable::gains[lowIndex + 1];
+	double kForward = lowGains[0] + (highGains[0] - lowGains[0]) * ratio;
+	double kLeft = lowGains[1] + (highGains[1] - lowGains[1]) * ratio;
+	double kTheta = lowGains[2] + (highGains[2] - lowGains[2]) * ratio;
+
+	// The lateral gain flips with the direction of travel
+	if (v_desired < 0) {
+		kLeft = -kLeft;
+	}
+
+	// Compute output velocities
+	double outputLinearVelocity = v_desired + kForward * e_forward;
+	double outputAngularVelocity = w_desired + kLeft * e_left + kTheta * e_theta;
+
+	// Return linegular velocities
+	std::pair<double, double> result = std::make_pair(outputLinearVelocity, outputAngularVelocity);
+	return result;
+}
@@ -0,0 +1,283 @@
+#include "AutonUtilities/mpcController.h"
+
+#include "AutonUtilities/linegular.h"
+#include "Utilities/generalUtility.h"
+#include "Utilities/sysidConstants.h"
+#include "Utilities/robotInfo.h"
+#include "Utilities/fieldInfo.h"
+
+#include <cmath>
+#include <algorithm>
+
+namespace {
+	// State weights on {along, left, heading} error, from tolerances of 0.1 tiles, 0.05 tiles and 0.1 rad
+	const double weightAlong = 1.0 / (0.1 * 0.1);
+	const double weightLeft = 1.0 / (0.05 * 0.05);
+	const double weightHeading = 1.0 / (0.1 * 0.1);
+
+	// Input weight on wheel velocity deviation, from a tolerance of 1 tile/s
+	const double weightWheel = 1.0;
+
+	// Solver limits
+	const int maxIterationCount = 25;
+	const int powerIterationCount = 6;
+	const double convergenceTolerance = 1e-3;
+
+	double wrapRadians(double angle_radians) {
+		return atan2(sin(angle_radians), cos(angle_radians));
+	}
+}
+
+MpcController::MpcController(int horizonSteps, double stepTime_seconds) {
+	this->horizonSteps = std::max(1, std::min(horizonSteps, maxHorizonSteps));
+	this->stepTime_seconds = stepTime_seconds;
+
+	// Wheel speed limited by the voltage left after static friction
+	double maxVoltageVelocity = std::min(
+		(12.0 - sysidconstants::driveLeftKs_volt) / sysidconstants::driveLeftKv_voltPerTilesPerSecond,
+		(12.0 - sysidconstants::driveRightKs_volt) / sysidconstants::driveRightKv_voltPerTilesPerSecond
+	);
+	maxWheelVelocity = std::min(maxVoltageVelocity, std::min(sysidconstants::driveLeftMaxVelocity_tilesPerSecond, sysidconstants::driveRightMaxVelocity_tilesPerSecond));
+	maxWheelAcceleration = std::min(sysidconstants::driveLeftMaxAcceleration_tilesPerSecondSquared, sysidconstants::driveRightMaxAcceleration_tilesPerSecondSquared);
+	halfTrackWidth = botinfo::halfRobotLengthIn * (1.0 / field::tileLengthIn);
+
+	for (int i = 0; i < maxHorizonSteps; i++) {
+		referenceX[i] = referenceY[i] = referenceTheta[i] = 0;
+		referenceLinear[i] = referenceAngular[i] = 0;
+	}
+	reset();
+}
+
+void MpcController::setDirection(bool isReversed) {
+	if (isReversed) {
+		directionFactor = -1;
+	} else {
+		directionFactor = 1;
+	}
+}
+
+void MpcController::reset() {
+	for (int i = 0; i < 2 * maxHorizonSteps; i++) {
+		solution[i] = 0;
+	}
+	hasSolution = false;
+	hasLastCommand = false;
+	lastLeftVelocity = lastRightVelocity = 0;
+	lastIterationCount = 0;
+}
+
+int MpcController::getHorizonSteps() {
+	return horizonSteps;
+}
+
+double MpcController::getStepTime_seconds() {
+	return stepTime_seconds;
+}
+
+void MpcController::setReference(
+	int stepIndex, Linegular desired,
+	double desiredLinearVelocity, double desiredAngularVelocity_radiansPerSecond
+) {
+	if (stepIndex < 0 || stepIndex >= horizonSteps) {
+		return;
+	}
+	referenceX[stepIndex] = desired.getX();
+	referenceY[stepIndex] = desired.getY();
+	referenceTheta[stepIndex] = desired.getThetaPolarAngle_radians();
+	referenceLinear[stepIndex] = fabs(desiredLinearVelocity) * directionFactor;
+	referenceAngular[stepIndex] = desiredAngularVelocity_radiansPerSecond;
+}
+
+std::pair<double, double> MpcController::getLinegularVelocity(Linegular actual) {
+	const int variableCount = 2 * horizonSteps;
+
+	// Get error in the reference frame
+	double deltaX = actual.getX() - referenceX[0];
+	double deltaY = actual.getY() - referenceY[0];
+	double initialError[3] = {
+		cos(referenceTheta[0]) * deltaX + sin(referenceTheta[0]) * deltaY,
+		-sin(referenceTheta[0]) * deltaX + cos(referenceTheta[0]) * deltaY,
+		wrapRadians(actual.getThetaPolarAngle_radians() - referenceTheta[0]),
+	};
+
+	// Warm start from the last solution, shifted by a step
+	double current[2 * maxHorizonSteps], previous[2 * maxHorizonSteps], momentum[2 * maxHorizonSteps];
+	double gradient[2 * maxHorizonSteps];
+	for (int i = 0; i < variableCount; i++) {
+		int shiftedIndex = std::min(i + 2, variableCount - 2 + (i % 2));
+		current[i] = hasSolution ? solution[shiftedIndex] : 0;
+	}
+	project(current);
+
+	// Estimate the gradient's Lipschitz constant by power iteration on the Hessian
+	double zeroError[3] = {0, 0, 0};
+	double direction[2 * maxHorizonSteps];
+	// Start with both the common and the differential wheel modes
+	for (int i = 0; i < variableCount; i++) {
+		direction[i] = (i % 2 == 0) ? 1 : -0.5;
+	}
+	double lipschitz = 1;
+	for (int iteration = 0; iteration < powerIterationCount; iteration++) {
+		computeGradient(zeroError, direction, gradient);
+		double norm = 0;
+		for (int i = 0; i < variableCount; i++) {
+			norm += gradient[i] * gradient[i];
+		}
+		norm = sqrt(norm);
+		if (norm < 1e-12) {
+			break;
+		}
+		double directionNorm = 0;
+		for (int i = 0; i < variableCount; i++) {
+			directionNorm += direction[i] * direction[i];
+		}
+		lipschitz = norm / sqrt(directionNorm);
+		for (int i = 0; i < variableCount; i++) {
+			direction[i] = gradient[i] / norm;
+		}
+	}
+	double stepSize = 1.0 / (lipschitz * 1.25);
+
+	// Accelerated projected gradient
+	for (int i = 0; i < variableCount; i++) {
+		previous[i] = momentum[i] = current[i];
+	}
+	double acceleration = 1;
+	int iteration = 0;
+	for (; iteration < maxIterationCount; iteration++) {
+		computeGradient(initialError, momentum, gradient);
+		for (int i = 0; i < variableCount; i++) {
+			current[i] = momentum[i] - stepSize * gradient[i];
+		}
+		project(current);
+
+		// Check convergence
+		double change = 0;
+		for (int i = 0; i < variableCount; i++) {
+			change = std::max(change, fabs(current[i] - previous[i]));
+		}
+
+		// Nesterov momentum
+		double nextAcceleration = 0.5 * (1 + sqrt(1 + 4 * acceleration * acceleration));
+		double momentumGain = (acceleration - 1) / nextAcceleration;
+		for (int i = 0; i < variableCount; i++) {
+			momentum[i] = current[i] + momentumGain * (current[i] - previous[i]);
+			previous[i] = current[i];
+		}
+		acceleration = nextAcceleration;
+
+		if (change < convergenceTolerance) {
+			iteration++;
+			break;
+		}
+	}
+	lastIterationCount = iteration;
+
+	// Store for warm start
+	for (int i = 0; i < variableCount; i++) {
+		solution[i] = current[i];
+	}
+	hasSolution = true;
+
+	// Apply the first step
+	double leftVelocity = referenceLinear[0] - referenceAngular[0] * halfTrackWidth + current[0];
+	double rightVelocity = referenceLinear[0] + referenceAngular[0] * halfTrackWidth + current[1];
+	lastLeftVelocity = leftVelocity;
+	lastRightVelocity = rightVelocity;
+	hasLastCommand = true;
+
+	// Return linegular velocities
+	double outputLinearVelocity = (leftVelocity + rightVelocity) / 2.0;
+	double outputAngularVelocity = (rightVelocity - leftVelocity) / (2.0 * halfTrackWidth);
+	std::pair<double, double> result = std::make_pair(outputLinearVelocity, outputAngularVelocity);
+	return result;
+}
+
+int MpcController::getLastIterationCount() {
+	return lastIterationCount;
+}
+
+/// @brief Returns the cost and fills its gradient with respect to the wheel deviations.
+double MpcController::computeGradient(const double initialError[3], const double *deviations, double *gradient) {
+	// Linearized error dynamics at each step
+	// e_along' = dv + w_r * e_left
+	// e_left' = -w_r * e_along + v_r * e_heading
+	// e_heading' = dw
+	double errors[maxHorizonSteps + 1][3];
+	errors[0][0] = initialError[0];
+	errors[0][1] = initialError[1];
+	errors[0][2] = initialError[2];
+	double cost = 0;
+
+	// Forward rollout
+	for (int k = 0; k < horizonSteps; k++) {
+		double dt = stepTime_seconds;
+		double linearDeviation = (deviations[2 * k] + deviations[2 * k + 1]) / 2.0;
+		double angularDeviation = (deviations[2 * k + 1] - deviations[2 * k]) / (2.0 * halfTrackWidth);
+		double *e = errors[k];
+		double *nextE = errors[k + 1];
+		nextE[0] = e[0] + dt * (referenceAngular[k] * e[1] + linearDeviation);
+		nextE[1] = e[1] + dt * (-referenceAngular[k] * e[0] + referenceLinear[k] * e[2]);
+		nextE[2] = e[2] + dt * angularDeviation;
+
+		cost += weightAlong * nextE[0] * nextE[0] + weightLeft * nextE[1] * nextE[1] + weightHeading * nextE[2] * nextE[2];
+		cost += weightWheel * (deviations[2 * k] * deviations[2 * k] + deviations[2 * k + 1] * deviations[2 * k + 1]);
+	}
+
+	// Backward adjoint pass
+	double adjoint[3] = {0, 0, 0};
+	for (int k = horizonSteps - 1; k >= 0; k--) {
+		double dt = stepTime_seconds;
+		double *nextE = errors[k + 1];
+
+		// Cost on the state after the step
+		adjoint[0] += 2 * weightAlong * nextE[0];
+		adjoint[1] += 2 * weightLeft * nextE[1];
+		adjoint[2] += 2 * weightHeading * nextE[2];
+
+		// Gradient of the step's inputs
+		double linearGradient = dt * adjoint[0];
+		double angularGradient = dt * adjoint[2];
+		gradient[2 * k] = 2 * weightWheel * deviations[2 * k] + 0.5 * linearGradient - angularGradient / (2.0 * halfTrackWidth);
+		gradient[2 * k + 1] = 2 * weightWheel * deviations[2 * k + 1] + 0.5 * linearGradient + angularGradient / (2.0 * halfTrackWidth);
+
+		// Propagate through the transposed dynamics
+		double previousAdjoint[3] = {
+			adjoint[0] - dt * referenceAngular[k] * adjoint[1],
+			adjoint[1] + dt * referenceAngular[k] * adjoint[0],
+			adjoint[2] + dt * referenceLinear[k] * adjoint[1],
+		};
+		adjoint[0] = previousAdjoint[0];
+		adjoint[1] = previousAdjoint[1];
+		adjoint[2] = previousAdjoint[2];
+	}
+
+	return cost;
+}
+
+/// @brief Clamps each wheel's velocity and change of velocity along the horizon.
+void MpcController::project(double *deviations) {
+	double previousLeft = lastLeftVelocity, previousRight = lastRightVelocity;
+	double maxChange = maxWheelAcceleration * stepTime_seconds;
+	for (int k = 0; k < horizonSteps; k++) {
+		double referenceLeft = referenceLinear[k] - referenceAngular[k] * halfTrackWidth;
+		double referenceRight = referenceLinear[k] + referenceAngular[k] * halfTrackWidth;
+		double left = referenceLeft + deviations[2 * k];
+		double right = referenceRight + deviations[2 * k + 1];
+
+		// Acceleration, only once a command has been applied
+		if (k > 0 || hasLastCommand) {
+			left = genutil::clamp(left, previousLeft - maxChange, previousLeft + maxChange);
+			right = genutil::clamp(right, previousRight - maxChange, previousRight + maxChange);
+		}
+
+		// Velocity
+		left = genutil::clamp(left, -maxWheelVelocity, maxWheelVelocity);
+		right = genutil::clamp(right, -maxWheelVelocity, maxWheelVelocity);
+
+		deviations[2 * k] = left - referenceLeft;
+		deviations[2 * k + 1] = right - referenceRight;
+		previousLeft = left;
+		previousRight = right;
+	}
+}
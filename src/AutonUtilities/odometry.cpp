@@ -5,6 +5,8 @@
 #include "Utilities/angleUtility.h"
 #include "Utilities/fieldInfo.h"
 #include "Utilities/generalUtility.h"
+#include "Utilities/timingProbe.h"
+#include "Utilities/virtualClock.h"
 #include "main.h"
 
 // File-local variables
@@ -13,6 +15,39 @@ namespace {
 	const double cosAngleWithinRange = 1e-2;
 	const double integralSmallAngle_degrees = 8;
 	const double inertialNoiseFilter_degrees = 1e-4;
+
+	const double stationaryWheelTravel_inches = 0.01;
+	const double parallelSensorAngleRange_degrees = 1;
+	const double minSensorRadiusDifference_inches = 1;
+
+	// Sensor health
+	const double healthGain = 0.05;
+	const double minHealth = 0.05;
+	const double positionResidualTolerance_inches = 0.05;
+	const double positionResidualTolerance_ratio = 0.3;
+	const double inertialResidualTolerance_degrees = 0.3;
+	const double inertialResidualTolerance_ratio = 0.3;
+
+	// Heading fusion
+	const double defaultHeadingKalmanProcessNoisePerDegree = 0.01;
+	const double defaultHeadingKalmanProcessNoisePerFrame = 1e-4;
+	const double defaultHeadingKalmanMeasurementNoise = 0.05;
+	const double headingConsistencyTolerance_degrees = 0.5;
+	const double headingConsistencyTolerance_ratio = 0.3;
+
+	double updateHealth(double health, bool isConsistent) {
+		health += healthGain * ((isConsistent ? 1.0 : 0.0) - health);
+		return genutil::clamp(health, minHealth, 1);
+	}
+
+	const double defaultMotionFilterAlpha = 0.3;
+	const double defaultMotionFilterBeta = 0.02;
+
+	// Sample refresh
+	const double maxStaleTime_seconds = 0.025;
+	const double mergedSamplePeriodRatio = 1.5;
+	const double samplePeriodFilterGain = 0.1;
+	const double updateRateFilterGain = 0.05;
 }
 
 
@@ -24,6 +59,7 @@ Odometry::Odometry() {
 	positionSensor_sensorToWheel_gearRatios.clear();
 	positionSensor_wheelDiameters_inches.clear();
 	positionSensor_normalRotateRadii_inches.clear();
+	positionSensor_timestampCallbacks.clear();
 	positionSensor_oldMeasurements.clear();
 	positionSensor_newMeasurements.clear();
 	positionSensor_count = 0;
@@ -34,14 +70,40 @@ Odometry::Odometry() {
 	inertialSensor_newMeasurements.clear();
 	inertialSensor_count = 0;
 
+	driveLeftRevolutionCallback = nullptr;
+	driveRightRevolutionCallback = nullptr;
+	driveMotorToWheel_gearRatio = driveWheelDiameter_inches = driveTrackWidth_inches = 0;
+	driveLeft_oldMeasurement = driveRight_oldMeasurement = 0;
+	driveLeft_newMeasurement = driveRight_newMeasurement = 0;
+	hasReferenceDeltaPolarAngle = useReferenceDeltaPolarAngle = false;
+	referenceDeltaPolarAngle_degrees = 0;
+	isLookOnDriveReference = false;
+	driveLookDelta_inches = 0;
+
+	setHeadingFusion(odometry::Complementary);
+	setHeadingKalmanNoise(defaultHeadingKalmanProcessNoisePerDegree, defaultHeadingKalmanProcessNoisePerFrame, defaultHeadingKalmanMeasurementNoise);
+	fusedPolarAngle_degrees = inertialPolarAngle_degrees = 0;
+	headingKalmanVariance = 0;
+	headingFusionRejectionCount = 0;
+
+	driveSpeedCallback = nullptr;
+	maxStationarySpeed = 0;
+
 	positionFactor = 1;
 	isStarted = false;
 
 	x = y = 0;
 	right_fieldAngle_degrees = 0;
+
+	setMotionFilterGains(defaultMotionFilterAlpha, defaultMotionFilterBeta);
+	lastFrameTime_microseconds = 0;
+	frameDeltaTime_seconds = 0;
+
+	effectiveUpdateRate_hertz = 0;
+	skippedFrameCount = mergedFrameCount = 0;
 }
 
-void Odometry::addPositionSensor2D(double polarAngle, double (*revolutionCallback)(), double sensorToWheel_gearRatio, double wheelDiameter_inches, double normalRotateRadius_inches) {
+void Odometry::addPositionSensor2D(double polarAngle, double (*revolutionCallback)(), double sensorToWheel_gearRatio, double wheelDiameter_inches, double normalRotateRadius_inches, uint32_t (*timestampCallback)()) {
 	// Double check if not started
 	if (isStarted) {
 		return;
@@ -53,6 +115,7 @@ void Odometry::addPositionSensor2D(double polarAngle, double (*revolutionCallbac
 	positionSensor_sensorToWheel_gearRatios.push_back(sensorToWheel_gearRatio);
 	positionSensor_wheelDiameters_inches.push_back(wheelDiameter_inches);
 	positionSensor_normalRotateRadii_inches.push_back(normalRotateRadius_inches);
+	positionSensor_timestampCallbacks.push_back(timestampCallback);
 }
 
 void Odometry::addInertialSensor(inertial &sensor, double perClockwiseRevolutionDrift, double perCCWRevolutionDrift) {
@@ -66,10 +129,57 @@ void Odometry::addInertialSensor(inertial &sensor, double perClockwiseRevolution
 	inertialSensor_driftCorrections.push_back(new DriftCorrection(sensor, perClockwiseRevolutionDrift, perCCWRevolutionDrift));
 }
 
+void Odometry::addInertialSensor(double (*rotationCallback)(), double perClockwiseRevolutionDrift, double perCCWRevolutionDrift) {
+	// Double check if not started
+	if (isStarted) {
+		return;
+	}
+
+	// Store values
+	inertialSensors.push_back(nullptr);
+	inertialSensor_driftCorrections.push_back(new DriftCorrection(rotationCallback, perClockwiseRevolutionDrift, perCCWRevolutionDrift));
+}
+
 void Odometry::setPositionFactor(double inchToValue_ratio) {
 	positionFactor = inchToValue_ratio;
 }
 
+void Odometry::setMotionFilterGains(double alpha, double beta) {
+	localRightVelocityFilter.setGains(alpha, beta);
+	localLookVelocityFilter.setGains(alpha, beta);
+	angularVelocityFilter.setGains(alpha, beta);
+}
+
+void Odometry::setStationarySpeedCallback(double (*driveSpeedCallback)(), double maxStationarySpeed) {
+	this->driveSpeedCallback = driveSpeedCallback;
+	this->maxStationarySpeed = maxStationarySpeed;
+}
+
+void Odometry::setHeadingFusion(odometry::HeadingFusionMode mode, double timeConstant_seconds) {
+	headingFusionMode = mode;
+	headingFusionTimeConstant_seconds = timeConstant_seconds;
+}
+
+void Odometry::setHeadingKalmanNoise(double processNoisePerDegree, double processNoisePerFrame, double measurementNoise) {
+	headingKalmanProcessNoisePerDegree = processNoisePerDegree;
+	headingKalmanProcessNoisePerFrame = processNoisePerFrame;
+	headingKalmanMeasurementNoise = measurementNoise;
+}
+
+void Odometry::setDriveReference(double (*leftRevolutionCallback)(), double (*rightRevolutionCallback)(), double motorToWheel_gearRatio, double wheelDiameter_inches, double trackWidth_inches) {
+	// Double check if not started
+	if (isStarted) {
+		return;
+	}
+
+	// Store values
+	driveLeftRevolutionCallback = leftRevolutionCallback;
+	driveRightRevolutionCallback = rightRevolutionCallback;
+	driveMotorToWheel_gearRatio = motorToWheel_gearRatio;
+	driveWheelDiameter_inches = wheelDiameter_inches;
+	driveTrackWidth_inches = trackWidth_inches;
+}
+
 void Odometry::startThreads() {
 	// task odometryTask(odometryThread);
 	// NOTE: task doesn't accept lamdas with captures, and workarounds are quite complicated
@@ -91,10 +201,27 @@ void Odometry::start() {
 
 	// Initialize old measurements
 	positionSensor_oldMeasurements.resize(positionSensor_count);
+	positionSensor_newMeasurements.resize(positionSensor_count);
 	for (int i = 0; i < positionSensor_count; i++) {
 		positionSensor_oldMeasurements[i] = positionSensor_RevolutionCallbacks[i]();
+		positionSensor_newMeasurements[i] = positionSensor_oldMeasurements[i];
+	}
+
+	// Initialize timestamps
+	positionSensor_oldTimestamps.assign(positionSensor_count, 0);
+	positionSensor_newTimestamps.assign(positionSensor_count, 0);
+	positionSensor_samplePeriods_milliseconds.assign(positionSensor_count, 0);
+	for (int i = 0; i < positionSensor_count; i++) {
+		if (positionSensor_timestampCallbacks[i] != nullptr) {
+			positionSensor_oldTimestamps[i] = positionSensor_newTimestamps[i] = positionSensor_timestampCallbacks[i]();
+		}
 	}
 
+	// Initialize health, keeping counts across restarts
+	positionSensor_healthScores.assign(positionSensor_count, 1);
+	positionSensor_frameWeights.assign(positionSensor_count, 1);
+	positionSensor_rejectionCounts.resize(positionSensor_count, 0);
+
 	/* Inertial sensors */
 
 	// Update sensors count
@@ -102,11 +229,43 @@ void Odometry::start() {
 
 	// Initialize old measurements with counter-clockwise being positive, assuming right turn type
 	inertialSensor_oldMeasurements.resize(inertialSensor_count);
+	inertialSensor_newMeasurements.resize(inertialSensor_count);
 	for (int i = 0; i < inertialSensor_count; i++) {
 		inertialSensor_driftCorrections[i]->setInitial();
 		// inertialSensor_oldMeasurements[i] = -inertialSensors[i]->rotation(deg);
 		inertialSensor_oldMeasurements[i] = -inertialSensor_driftCorrections[i]->getRotation();
+		inertialSensor_newMeasurements[i] = inertialSensor_oldMeasurements[i];
+	}
+
+	// Initialize timestamps
+	inertialSensor_oldTimestamps.resize(inertialSensor_count);
+	for (int i = 0; i < inertialSensor_count; i++) {
+		inertialSensor_oldTimestamps[i] = getInertialSensorTimestamp(i);
+	}
+
+	// Initialize health, keeping counts across restarts
+	inertialSensor_healthScores.assign(inertialSensor_count, 1);
+	inertialSensor_frameWeights.assign(inertialSensor_count, 1);
+	inertialSensor_rejectionCounts.resize(inertialSensor_count, 0);
+
+	/* Drive reference */
+
+	if (driveLeftRevolutionCallback != nullptr) {
+		driveLeft_oldMeasurement = driveLeft_newMeasurement = driveLeftRevolutionCallback();
+		driveRight_oldMeasurement = driveRight_newMeasurement = driveRightRevolutionCallback();
 	}
+
+	/* Heading fusion */
+
+	fusedPolarAngle_degrees = inertialPolarAngle_degrees = 0;
+	headingKalmanVariance = 0;
+
+	/* Motion estimation */
+
+	localRightVelocityFilter.reset();
+	localLookVelocityFilter.reset();
+	angularVelocityFilter.reset();
+	lastFrameTime_microseconds = vclock::getTime_microseconds();
 }
 
 void Odometry::restart() {
@@ -115,6 +274,8 @@ void Odometry::restart() {
 }
 
 void Odometry::odometryFrame() {
+	timing::ScopedProbe probe(timing::OdometryFrame);
+
 	// Make sure started
 	if (!isStarted) {
 		start();
@@ -122,24 +283,46 @@ void Odometry::odometryFrame() {
 
 	/* Sensor values */
 
-	// Get new sensor values
+	// Get new position sensor values
 	getNewPositionSensorMeasurements();
+
+	// Skip frames without fresh samples, so deltas aren't split across frames
+	if (!hasFreshSamples()) {
+		skippedFrameCount++;
+		return;
+	}
+
+	// Update frame time
+	updateFrameTime();
+
+	// Get other new sensor values
+	getNewDriveReferenceMeasurements();
+	updateDriftCorrectionHints();
 	getNewInertialSensorMeasurements();
 
+	// Check sensors against each other
+	updateSensorHealth();
+
 
 	/* Measurement differences */
 
-	// Get rotation difference from averages
-	double deltaPolarAngle_degrees = getDeltaPolarAngle_degrees();
+	// Get rotation difference from averages, fused with the tracking wheels
+	double deltaPolarAngle_degrees = getFusedDeltaPolarAngle_degrees(getDeltaPolarAngle_degrees());
 
 	// Get local distance difference from averages, multiplied by position factor
 	double localDeltaRight = getLocalDeltaX_inches(deltaPolarAngle_degrees) * positionFactor;
 	double localDeltaLook = getLocalDeltaY_inches(deltaPolarAngle_degrees) * positionFactor;
 	Linegular deltaDistances(localDeltaRight, localDeltaLook, deltaPolarAngle_degrees);
 
+	// Estimate body-frame velocities and accelerations
+	updateMotionEstimate(localDeltaRight, localDeltaLook, deltaPolarAngle_degrees);
+
 
 	/* Local to Absolute */
 
+	// Hold the pose until updated, so pose resets apply between frames
+	poseMutex.lock();
+
 	if (genutil::isWithin(deltaPolarAngle_degrees, 0, integralSmallAngle_degrees)) {
 		// Rotate by half angle (euler integration)
 		// see https://docs.ftclib.org/ftclib/master/kinematics/odometry
@@ -160,12 +343,19 @@ void Odometry::odometryFrame() {
 
 	// Update old sensor values
 	positionSensor_oldMeasurements = positionSensor_newMeasurements;
+	positionSensor_oldTimestamps = positionSensor_newTimestamps;
 	inertialSensor_oldMeasurements = inertialSensor_newMeasurements;
+	for (int i = 0; i < inertialSensor_count; i++) {
+		inertialSensor_oldTimestamps[i] = getInertialSensorTimestamp(i);
+	}
+	driveLeft_oldMeasurement = driveLeft_newMeasurement;
+	driveRight_oldMeasurement = driveRight_newMeasurement;
 
 	// Update odometry values
 	x += deltaDistances.getX();
 	y += deltaDistances.getY();
 	right_fieldAngle_degrees -= deltaPolarAngle_degrees;
+	poseMutex.unlock();
 }
 
 void Odometry::setPosition(double x, double y) {
@@ -193,24 +383,97 @@ double Odometry::getRightFieldAngle_degrees() {
 	return right_fieldAngle_degrees;
 }
 
+void Odometry::setPose(double x, double y, double lookFieldAngle_degrees) {
+	poseMutex.lock();
+	this->x = x;
+	this->y = y;
+	setLookAngle(lookFieldAngle_degrees);
+	poseMutex.unlock();
+}
+
 Linegular Odometry::getLookLinegular() {
-	return Linegular(x, y, angle::swapFieldPolar_degrees(getLookFieldAngle_degrees()));
+	poseMutex.lock();
+	Linegular lookLinegular(x, y, angle::swapFieldPolar_degrees(getLookFieldAngle_degrees()));
+	poseMutex.unlock();
+	return lookLinegular;
+}
+
+double Odometry::getLocalRightVelocity() {
+	return localRightVelocityFilter.getValue();
+}
+
+double Odometry::getLocalLookVelocity() {
+	return localLookVelocityFilter.getValue();
+}
+
+double Odometry::getAngularVelocity_radiansPerSecond() {
+	return angularVelocityFilter.getValue();
+}
+
+double Odometry::getLocalRightAcceleration() {
+	return localRightVelocityFilter.getRate();
+}
+
+double Odometry::getLocalLookAcceleration() {
+	return localLookVelocityFilter.getRate();
+}
+
+double Odometry::getAngularAcceleration_radiansPerSecondSquared() {
+	return angularVelocityFilter.getRate();
+}
+
+double Odometry::getPositionSensorHealth(int sensorIndex) {
+	if (sensorIndex < 0 || sensorIndex >= (int) positionSensor_healthScores.size()) return 0;
+	return positionSensor_healthScores[sensorIndex];
+}
+
+int Odometry::getPositionSensorRejectionCount(int sensorIndex) {
+	if (sensorIndex < 0 || sensorIndex >= (int) positionSensor_rejectionCounts.size()) return 0;
+	return positionSensor_rejectionCounts[sensorIndex];
+}
+
+double Odometry::getInertialSensorHealth(int sensorIndex) {
+	if (sensorIndex < 0 || sensorIndex >= (int) inertialSensor_healthScores.size()) return 0;
+	return inertialSensor_healthScores[sensorIndex];
+}
+
+int Odometry::getInertialSensorRejectionCount(int sensorIndex) {
+	if (sensorIndex < 0 || sensorIndex >= (int) inertialSensor_rejectionCounts.size()) return 0;
+	return inertialSensor_rejectionCounts[sensorIndex];
+}
+
+int Odometry::getHeadingFusionRejectionCount() {
+	return headingFusionRejectionCount;
+}
+
+double Odometry::getEffectiveUpdateRate_hertz() {
+	return effectiveUpdateRate_hertz;
+}
+
+int Odometry::getSkippedFrameCount() {
+	return skippedFrameCount;
+}
+
+int Odometry::getMergedFrameCount() {
+	return mergedFrameCount;
 }
 
 void Odometry::printDebug() {
 	// Print tracked values
 	printf("Track X: %07.3f, Y: %07.3f, Ang: %07.3f\n", getX(), getY(), getLookFieldAngle_degrees());
+	printf("Vel R: %07.3f, L: %07.3f, Ang: %07.3f\n", getLocalRightVelocity(), getLocalLookVelocity(), getAngularVelocity_radiansPerSecond());
+	printf("Rate: %.1f Hz, skipped: %d, merged: %d\n", getEffectiveUpdateRate_hertz(), getSkippedFrameCount(), getMergedFrameCount());
 
 	// Print position sensor readings
 	for (int i = 0; i < positionSensor_count; i++) {
 		double m = positionSensor_newMeasurements[i];
-		printf("POS %2d: %07.3f\n", i, m);
+		printf("POS %2d: %07.3f, health: %.2f, rejected: %d\n", i, m, positionSensor_healthScores[i], positionSensor_rejectionCounts[i]);
 	}
 
 	// Print inertial sensor readings
 	for (int i = 0; i < inertialSensor_count; i++) {
 		double m = inertialSensor_newMeasurements[i];
-		printf("INR %2d: %07.3f\n", i, m);
+		printf("INR %2d: %07.3f, health: %.2f, rejected: %d\n", i, m, inertialSensor_healthScores[i], inertialSensor_rejectionCounts[i]);
 	}
 }
 
@@ -221,23 +484,255 @@ void Odometry::odometryThread() {}
 
 void Odometry::getNewPositionSensorMeasurements() {
 	/* Position sensors */
-	positionSensor_newMeasurements.resize(positionSensor_count);
 	for (int i = 0; i < positionSensor_count; i++) {
 		positionSensor_newMeasurements[i] = positionSensor_RevolutionCallbacks[i]();
+		if (positionSensor_timestampCallbacks[i] != nullptr) {
+			positionSensor_newTimestamps[i] = positionSensor_timestampCallbacks[i]();
+		}
 	}
 }
 
 void Odometry::getNewInertialSensorMeasurements() {
 	/* Inertial sensors */
-	inertialSensor_newMeasurements.resize(inertialSensor_count);
 	for (int i = 0; i < inertialSensor_count; i++) {
 		inertialSensor_driftCorrections[i]->correct();
 		inertialSensor_newMeasurements[i] = -inertialSensor_driftCorrections[i]->getRotation();
 	}
 }
 
+void Odometry::getNewDriveReferenceMeasurements() {
+	/* Drive motor encoders */
+	if (driveLeftRevolutionCallback == nullptr) {
+		return;
+	}
+	driveLeft_newMeasurement = driveLeftRevolutionCallback();
+	driveRight_newMeasurement = driveRightRevolutionCallback();
+}
+
+uint32_t Odometry::getInertialSensorTimestamp(int sensorIndex) {
+	// Rotation callbacks have no timestamps
+	if (inertialSensors[sensorIndex] == nullptr) {
+		return 0;
+	}
+	return inertialSensors[sensorIndex]->timestamp();
+}
+
+double Odometry::getPositionSensorDeltaDistance_inches(int sensorIndex) {
+	double measuredDeltaDistance = positionSensor_newMeasurements[sensorIndex] - positionSensor_oldMeasurements[sensorIndex]; // sensor revolutions
+	measuredDeltaDistance *= positionSensor_sensorToWheel_gearRatios[sensorIndex]; // wheel revolutions
+	measuredDeltaDistance *= M_PI * positionSensor_wheelDiameters_inches[sensorIndex]; // wheel travel distance
+	return measuredDeltaDistance;
+}
+
+void Odometry::updateSensorHealth() {
+	// Reference rotation from parallel tracking wheels
+	hasReferenceDeltaPolarAngle = getTrackingWheelDeltaPolarAngle_degrees(referenceDeltaPolarAngle_degrees);
+	bool isTrackingWheelReference = hasReferenceDeltaPolarAngle;
+
+	// Otherwise, reference rotation from drive encoders
+	if (!hasReferenceDeltaPolarAngle && driveLeftRevolutionCallback != nullptr) {
+		double driveTravelFactor = driveMotorToWheel_gearRatio * M_PI * driveWheelDiameter_inches;
+		double leftDelta_inches = (driveLeft_newMeasurement - driveLeft_oldMeasurement) * driveTravelFactor;
+		double rightDelta_inches = (driveRight_newMeasurement - driveRight_oldMeasurement) * driveTravelFactor;
+		referenceDeltaPolarAngle_degrees = genutil::toDegrees((rightDelta_inches - leftDelta_inches) / driveTrackWidth_inches);
+		hasReferenceDeltaPolarAngle = true;
+	}
+
+	// Check inertial sensors first, as position sensors are checked with the fused rotation
+	updateInertialSensorHealth(isTrackingWheelReference);
+	updatePositionSensorHealth();
+}
+
+void Odometry::updateInertialSensorHealth(bool canReplaceSensors) {
+	useReferenceDeltaPolarAngle = false;
+
+	// Without reference, use all sensors equally
+	if (!hasReferenceDeltaPolarAngle) {
+		for (int i = 0; i < inertialSensor_count; i++) {
+			inertialSensor_frameWeights[i] = 1;
+		}
+		return;
+	}
+
+	// Compare each sensor with the reference rotation
+	int validSensorsCount = 0;
+	double tolerance_degrees = inertialResidualTolerance_degrees + inertialResidualTolerance_ratio * std::fabs(referenceDeltaPolarAngle_degrees);
+	for (int i = 0; i < inertialSensor_count; i++) {
+		double deltaAngle_degrees = inertialSensor_newMeasurements[i] - inertialSensor_oldMeasurements[i];
+		bool isConsistent = std::fabs(deltaAngle_degrees - referenceDeltaPolarAngle_degrees) <= tolerance_degrees;
+		inertialSensor_healthScores[i] = updateHealth(inertialSensor_healthScores[i], isConsistent);
+		inertialSensor_frameWeights[i] = isConsistent ? inertialSensor_healthScores[i] : 0;
+		if (isConsistent) validSensorsCount++;
+	}
+
+	// All sensors rejected: use the reference rotation if trusted, otherwise keep sensors by health
+	if (validSensorsCount == 0) {
+		useReferenceDeltaPolarAngle = canReplaceSensors;
+		for (int i = 0; i < inertialSensor_count; i++) {
+			inertialSensor_frameWeights[i] = inertialSensor_healthScores[i];
+		}
+		return;
+	}
+
+	// Count rejections
+	for (int i = 0; i < inertialSensor_count; i++) {
+		if (inertialSensor_frameWeights[i] == 0) inertialSensor_rejectionCounts[i]++;
+	}
+}
+
+void Odometry::updatePositionSensorHealth() {
+	// Without drive reference, use all sensors equally
+	isLookOnDriveReference = false;
+	if (driveLeftRevolutionCallback == nullptr) {
+		for (int i = 0; i < positionSensor_count; i++) {
+			positionSensor_frameWeights[i] = 1;
+		}
+		return;
+	}
+
+	// Drive travel, assuming no sideways motion
+	double driveTravelFactor = driveMotorToWheel_gearRatio * M_PI * driveWheelDiameter_inches;
+	double leftDelta_inches = (driveLeft_newMeasurement - driveLeft_oldMeasurement) * driveTravelFactor;
+	double rightDelta_inches = (driveRight_newMeasurement - driveRight_oldMeasurement) * driveTravelFactor;
+	driveLookDelta_inches = (leftDelta_inches + rightDelta_inches) / 2;
+	double deltaAngle_radians = genutil::toRadians(getDeltaPolarAngle_degrees());
+
+	// Compare each sensor with its predicted travel
+	double tolerance_inches = positionResidualTolerance_inches + positionResidualTolerance_ratio * std::fabs(driveLookDelta_inches);
+	for (int i = 0; i < positionSensor_count; i++) {
+		// equation: sensorDelta = translate · direction + normalRotateRadius * deltaAngle
+		double predictedDelta_inches = driveLookDelta_inches * sin(genutil::toRadians(positionSensor_polarAngles_degrees[i]));
+		predictedDelta_inches += positionSensor_normalRotateRadii_inches[i] * deltaAngle_radians;
+		double measuredDelta_inches = getPositionSensorDeltaDistance_inches(i);
+
+		bool isConsistent = std::fabs(measuredDelta_inches - predictedDelta_inches) <= tolerance_inches;
+		positionSensor_healthScores[i] = updateHealth(positionSensor_healthScores[i], isConsistent);
+		positionSensor_frameWeights[i] = isConsistent ? positionSensor_healthScores[i] : 0;
+	}
+
+	// Without a consistent look sensor, the drive travel stands in for the frame
+	isLookOnDriveReference = (getAxisFrameWeight(true) == 0);
+
+	// The drive can't measure sliding, so rejected sideways sensors are kept when none remain
+	restoreRejectedPositionSensors(false);
+
+	// Count rejections
+	for (int i = 0; i < positionSensor_count; i++) {
+		if (positionSensor_frameWeights[i] == 0) positionSensor_rejectionCounts[i]++;
+	}
+}
+
+double Odometry::getAxisFrameWeight(bool isLookAxis) {
+	double totalWeight = 0;
+	for (int i = 0; i < positionSensor_count; i++) {
+		double axisAngle_degrees = isLookAxis ? (90 - positionSensor_polarAngles_degrees[i]) : positionSensor_polarAngles_degrees[i];
+		double cosAngle = cos(genutil::toRadians(axisAngle_degrees));
+		if (genutil::isWithin(cosAngle, 0, cosAngleWithinRange)) {
+			continue;
+		}
+		totalWeight += positionSensor_frameWeights[i];
+	}
+	return totalWeight;
+}
+
+void Odometry::restoreRejectedPositionSensors(bool isLookAxis) {
+	// Check whether any sensor on the axis is kept
+	if (getAxisFrameWeight(isLookAxis) > 0) {
+		return;
+	}
+
+	// Restore all sensors on the axis by health
+	for (int i = 0; i < positionSensor_count; i++) {
+		double axisAngle_degrees = isLookAxis ? (90 - positionSensor_polarAngles_degrees[i]) : positionSensor_polarAngles_degrees[i];
+		double cosAngle = cos(genutil::toRadians(axisAngle_degrees));
+		if (genutil::isWithin(cosAngle, 0, cosAngleWithinRange)) {
+			continue;
+		}
+		positionSensor_frameWeights[i] = positionSensor_healthScores[i];
+	}
+}
+
+void Odometry::updateDriftCorrectionHints() {
+	// Check motion
+	bool isStationary = isPositionSensorsStationary();
+	if (driveSpeedCallback != nullptr && driveSpeedCallback() > maxStationarySpeed) {
+		isStationary = false;
+	}
+
+	// Rotation measured by the tracking wheels, clockwise being positive
+	double wheelDeltaPolarAngle_degrees;
+	bool hasWheelRotation = getTrackingWheelDeltaPolarAngle_degrees(wheelDeltaPolarAngle_degrees);
+
+	// Pass to drift correctors
+	for (int i = 0; i < inertialSensor_count; i++) {
+		inertialSensor_driftCorrections[i]->setStationary(isStationary);
+		if (hasWheelRotation) {
+			inertialSensor_driftCorrections[i]->setReferenceDeltaRotation(-wheelDeltaPolarAngle_degrees);
+		}
+	}
+}
+
+bool Odometry::isPositionSensorsStationary() {
+	for (int i = 0; i < positionSensor_count; i++) {
+		// Calculate measured raw difference in inches
+		double measuredDeltaDistance = getPositionSensorDeltaDistance_inches(i);
+
+		// Check travel
+		if (!genutil::isWithin(measuredDeltaDistance, 0, stationaryWheelTravel_inches)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool Odometry::getTrackingWheelDeltaPolarAngle_degrees(double &deltaPolarAngle_degrees) {
+	for (int i = 0; i < positionSensor_count; i++) {
+		for (int j = i + 1; j < positionSensor_count; j++) {
+			// equation: sensorDelta = translate · direction + normalRotateRadius * deltaAngle
+			// parallel sensors: deltaAngle = (delta_i - delta_j) / (radius_i - radius_j)
+			// opposite sensors: deltaAngle = (delta_i + delta_j) / (radius_i + radius_j)
+
+			// Check parallel
+			double angleDifference = genutil::modRange(positionSensor_polarAngles_degrees[i] - positionSensor_polarAngles_degrees[j], 360, -180);
+			double directionSign;
+			if (genutil::isWithin(angleDifference, 0, parallelSensorAngleRange_degrees)) {
+				directionSign = 1;
+			} else if (genutil::isWithin(std::fabs(angleDifference), 180, parallelSensorAngleRange_degrees)) {
+				directionSign = -1;
+			} else {
+				continue;
+			}
+
+			// Check separation
+			double radiusDifference = positionSensor_normalRotateRadii_inches[i] - directionSign * positionSensor_normalRotateRadii_inches[j];
+			if (std::fabs(radiusDifference) < minSensorRadiusDifference_inches) {
+				continue;
+			}
+
+			// Calculate measured raw differences in inches
+			double deltaDistances[2];
+			int indices[2] = {i, j};
+			for (int k = 0; k < 2; k++) {
+				deltaDistances[k] = getPositionSensorDeltaDistance_inches(indices[k]);
+			}
+
+			// Calculate rotation
+			double deltaAngle_radians = (deltaDistances[0] - directionSign * deltaDistances[1]) / radiusDifference;
+			deltaPolarAngle_degrees = genutil::toDegrees(deltaAngle_radians);
+			return true;
+		}
+	}
+	return false;
+}
+
 double Odometry::getDeltaPolarAngle_degrees() {
+	// Inertial sensors rejected
+	if (useReferenceDeltaPolarAngle) {
+		return referenceDeltaPolarAngle_degrees;
+	}
+
 	double totalDeltaAngle = 0;
+	double totalWeight = 0;
 	for (int i = 0; i < inertialSensor_count; i++) {
 		// Angle difference
 		double deltaAngle_degrees = inertialSensor_newMeasurements[i] - inertialSensor_oldMeasurements[i];
@@ -245,8 +740,9 @@ double Odometry::getDeltaPolarAngle_degrees() {
 		// Small noise filter
 		// if (genutil::isWithin(deltaAngle_degrees, 0, inertialNoiseFilter_degrees)) continue;
 
-		// Add to total
-		totalDeltaAngle += deltaAngle_degrees;
+		// Add to total by health
+		totalDeltaAngle += inertialSensor_frameWeights[i] * deltaAngle_degrees;
+		totalWeight += inertialSensor_frameWeights[i];
 	}
 
 	// Return
@@ -254,11 +750,51 @@ double Odometry::getDeltaPolarAngle_degrees() {
 		printf("Error: no inertial sensors available.");
 		return 0;
 	}
-	return totalDeltaAngle / inertialSensor_count;
+	return totalDeltaAngle / totalWeight;
+}
+
+double Odometry::getFusedDeltaPolarAngle_degrees(double inertialDeltaPolarAngle_degrees) {
+	// Track inertial heading
+	inertialPolarAngle_degrees += inertialDeltaPolarAngle_degrees;
+
+	// Get short-term rotation from the tracking wheels
+	double wheelDeltaPolarAngle_degrees;
+	bool hasWheelRotation = getTrackingWheelDeltaPolarAngle_degrees(wheelDeltaPolarAngle_degrees);
+	if (headingFusionMode == odometry::InertialOnly || !hasWheelRotation) {
+		fusedPolarAngle_degrees = inertialPolarAngle_degrees;
+		headingKalmanVariance = 0;
+		return inertialDeltaPolarAngle_degrees;
+	}
+
+	// Consistency check, falling back to the inertial rotation when the wheels slip
+	double tolerance_degrees = headingConsistencyTolerance_degrees + headingConsistencyTolerance_ratio * std::fabs(inertialDeltaPolarAngle_degrees);
+	if (!genutil::isWithin(wheelDeltaPolarAngle_degrees, inertialDeltaPolarAngle_degrees, tolerance_degrees)) {
+		wheelDeltaPolarAngle_degrees = inertialDeltaPolarAngle_degrees;
+		headingFusionRejectionCount++;
+	}
+
+	// Predict with the tracking wheels
+	double oldFusedPolarAngle_degrees = fusedPolarAngle_degrees;
+	double predictedPolarAngle_degrees = fusedPolarAngle_degrees + wheelDeltaPolarAngle_degrees;
+
+	// Correct with the inertial sensors
+	double gain;
+	if (headingFusionMode == odometry::Kalman) {
+		headingKalmanVariance += headingKalmanProcessNoisePerFrame + headingKalmanProcessNoisePerDegree * std::fabs(wheelDeltaPolarAngle_degrees);
+		gain = headingKalmanVariance / (headingKalmanVariance + headingKalmanMeasurementNoise);
+		headingKalmanVariance *= (1 - gain);
+	} else {
+		gain = frameDeltaTime_seconds / (headingFusionTimeConstant_seconds + frameDeltaTime_seconds);
+	}
+	fusedPolarAngle_degrees = predictedPolarAngle_degrees + gain * (inertialPolarAngle_degrees - predictedPolarAngle_degrees);
+
+	// Return
+	return fusedPolarAngle_degrees - oldFusedPolarAngle_degrees;
 }
 
 double Odometry::getLocalDeltaX_inches(double deltaPolarAngle_degrees) {
 	double totalDeltaX_inches = 0;
+	double totalWeight = 0;
 	int validSensorsCount = 0;
 	for (int i = 0; i < positionSensor_count; i++) {
 		// equation: localDeltaX * cos(angle) = sensorDeltaTranslate
@@ -271,18 +807,23 @@ double Odometry::getLocalDeltaX_inches(double deltaPolarAngle_degrees) {
 			continue;
 		}
 
+		// Skip rejected sensors
+		double weight = positionSensor_frameWeights[i];
+		if (weight <= 0) {
+			continue;
+		}
+
 		// Calculate measured raw difference in inches
-		double measuredDeltaDistance = positionSensor_newMeasurements[i] - positionSensor_oldMeasurements[i]; // sensor revolutions
-		measuredDeltaDistance *= positionSensor_sensorToWheel_gearRatios[i]; // wheel revolutions
-		measuredDeltaDistance *= M_PI * positionSensor_wheelDiameters_inches[i]; // wheel travel distance
+		double measuredDeltaDistance = getPositionSensorDeltaDistance_inches(i);
 
 		// Decrease by rotated arc distance
 		double rotatedDeltaDistance = positionSensor_normalRotateRadii_inches[i] * genutil::toRadians(deltaPolarAngle_degrees);
 		double sensorDeltaTranslate = measuredDeltaDistance - rotatedDeltaDistance;
 
-		// Add to total
+		// Add to total by health
 		double localDeltaX = sensorDeltaTranslate / cosAngle;
-		totalDeltaX_inches += localDeltaX;
+		totalDeltaX_inches += weight * localDeltaX;
+		totalWeight += weight;
 		validSensorsCount++;
 	}
 
@@ -291,11 +832,17 @@ double Odometry::getLocalDeltaX_inches(double deltaPolarAngle_degrees) {
 		printf("Error: no position sensors available for delta X.");
 		return 0;
 	}
-	return totalDeltaX_inches / validSensorsCount;
+	return totalDeltaX_inches / totalWeight;
 }
 
 double Odometry::getLocalDeltaY_inches(double deltaPolarAngle_degrees) {
+	// Drive travel in place of rejected look sensors
+	if (isLookOnDriveReference) {
+		return driveLookDelta_inches;
+	}
+
 	double totalDeltaY_inches = 0;
+	double totalWeight = 0;
 	int validSensorsCount = 0;
 	for (int i = 0; i < positionSensor_count; i++) {
 		// equation: localDeltaY * cos(90 - angle) = sensorDeltaTranslate
@@ -308,18 +855,23 @@ double Odometry::getLocalDeltaY_inches(double deltaPolarAngle_degrees) {
 			continue;
 		}
 
+		// Skip rejected sensors
+		double weight = positionSensor_frameWeights[i];
+		if (weight <= 0) {
+			continue;
+		}
+
 		// Calculate measured raw difference in inches
-		double measuredDeltaDistance = positionSensor_newMeasurements[i] - positionSensor_oldMeasurements[i]; // sensor revolutions
-		measuredDeltaDistance *= positionSensor_sensorToWheel_gearRatios[i]; // wheel revolutions
-		measuredDeltaDistance *= M_PI * positionSensor_wheelDiameters_inches[i]; // wheel travel distance
+		double measuredDeltaDistance = getPositionSensorDeltaDistance_inches(i);
 
 		// Decrease by rotated arc distance
 		double rotatedDeltaDistance = positionSensor_normalRotateRadii_inches[i] * genutil::toRadians(deltaPolarAngle_degrees);
 		double sensorDeltaTranslate = measuredDeltaDistance - rotatedDeltaDistance;
 
-		// Add to total
+		// Add to total by health
 		double localDeltaY = sensorDeltaTranslate / cosAngle;
-		totalDeltaY_inches += localDeltaY;
+		totalDeltaY_inches += weight * localDeltaY;
+		totalWeight += weight;
 		validSensorsCount++;
 	}
 
@@ -328,5 +880,82 @@ double Odometry::getLocalDeltaY_inches(double deltaPolarAngle_degrees) {
 		printf("Error: no position sensors available for delta Y.");
 		return 0;
 	}
-	return totalDeltaY_inches / validSensorsCount;
+	return totalDeltaY_inches / totalWeight;
+}
+
+bool Odometry::hasFreshSamples() {
+	// Position sensors: timestamps where available, change detection otherwise
+	bool hasTimestampedSensor = false;
+	bool isFresh = false;
+	for (int i = 0; i < positionSensor_count; i++) {
+		if (positionSensor_timestampCallbacks[i] != nullptr) {
+			hasTimestampedSensor = true;
+			if (positionSensor_newTimestamps[i] != positionSensor_oldTimestamps[i]) isFresh = true;
+		} else if (positionSensor_newMeasurements[i] != positionSensor_oldMeasurements[i]) {
+			isFresh = true;
+		}
+	}
+
+	// Inertial sensors only decide when no position sensor has timestamps
+	if (!hasTimestampedSensor) {
+		for (int i = 0; i < inertialSensor_count; i++) {
+			if (getInertialSensorTimestamp(i) != inertialSensor_oldTimestamps[i]) isFresh = true;
+		}
+	}
+
+	// Integrate stale frames occasionally, so estimates settle when the robot is still
+	double staleTime_seconds = (vclock::getTime_microseconds() - lastFrameTime_microseconds) * 1e-6;
+	return isFresh || staleTime_seconds >= maxStaleTime_seconds;
+}
+
+void Odometry::updateFrameTime() {
+	// Get elapsed time from the control clock
+	uint64_t frameTime_microseconds = vclock::getTime_microseconds();
+	frameDeltaTime_seconds = (frameTime_microseconds - lastFrameTime_microseconds) * 1e-6;
+	lastFrameTime_microseconds = frameTime_microseconds;
+
+	// Prefer the sample period of a fresh timestamped sensor
+	bool hasSampleTime = false;
+	for (int i = 0; i < positionSensor_count; i++) {
+		if (positionSensor_timestampCallbacks[i] == nullptr) continue;
+		uint32_t deltaTimestamp_milliseconds = positionSensor_newTimestamps[i] - positionSensor_oldTimestamps[i];
+		if (deltaTimestamp_milliseconds == 0) continue;
+
+		// Detect missed samples merged into this frame
+		double &samplePeriod_milliseconds = positionSensor_samplePeriods_milliseconds[i];
+		if (samplePeriod_milliseconds <= 0) {
+			samplePeriod_milliseconds = deltaTimestamp_milliseconds;
+		} else {
+			if (deltaTimestamp_milliseconds > mergedSamplePeriodRatio * samplePeriod_milliseconds) {
+				mergedFrameCount++;
+			} else {
+				samplePeriod_milliseconds += samplePeriodFilterGain * (deltaTimestamp_milliseconds - samplePeriod_milliseconds);
+			}
+		}
+
+		// Use the first sensor's sample time
+		if (!hasSampleTime) {
+			frameDeltaTime_seconds = deltaTimestamp_milliseconds * 1e-3;
+			hasSampleTime = true;
+		}
+	}
+
+	// Update effective rate
+	if (frameDeltaTime_seconds > 0) {
+		effectiveUpdateRate_hertz += updateRateFilterGain * (1.0 / frameDeltaTime_seconds - effectiveUpdateRate_hertz);
+	}
+}
+
+void Odometry::updateMotionEstimate(double localDeltaRight, double localDeltaLook, double deltaPolarAngle_degrees) {
+	double deltaTime_seconds = frameDeltaTime_seconds;
+
+	// Skip frames without elapsed time
+	if (deltaTime_seconds <= 0) {
+		return;
+	}
+
+	// Update filters with measured rates
+	localRightVelocityFilter.update(localDeltaRight / deltaTime_seconds, deltaTime_seconds);
+	localLookVelocityFilter.update(localDeltaLook / deltaTime_seconds, deltaTime_seconds);
+	angularVelocityFilter.update(genutil::toRadians(deltaPolarAngle_degrees) / deltaTime_seconds, deltaTime_seconds);
 }
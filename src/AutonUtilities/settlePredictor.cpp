@@ -0,0 +1,147 @@
+#include "AutonUtilities/settlePredictor.h"
+
+#include <stdio.h>
+#include <cmath>
+
+namespace {
+	// Error filter gains, tuned for 10-20 ms frames
+	const double filterAlpha = 0.6;
+	const double filterBeta = 0.3;
+
+	// Recorded moves
+	settlestats::MoveStats moves[settlestats::maxMoveCount];
+	int moveCount = 0;
+	int handedOffCount = 0;
+	double totalSaved_seconds = 0;
+	double totalMeasuredSaved_seconds = 0;
+}
+
+SettlePredictor::SettlePredictor(double settleRange, double brakeDeceleration, double maxSettleRate, double settleConfirm_seconds, int confirmFrameCount)
+: errorFilter(filterAlpha, filterBeta) {
+	this->settleRange = std::fabs(settleRange);
+	this->brakeDeceleration = std::fmax(1e-6, std::fabs(brakeDeceleration));
+	this->maxSettleRate = std::fabs(maxSettleRate);
+	this->settleConfirm_seconds = settleConfirm_seconds;
+	this->confirmFrameCount = confirmFrameCount;
+	reset();
+}
+
+void SettlePredictor::reset() {
+	errorFilter.reset(0, 0);
+	hasError = false;
+	elapsed_seconds = 0;
+	predictedFinalError = 1e9;
+	predictedFrameCount = 0;
+	firstPredicted_seconds = -1;
+}
+
+void SettlePredictor::update(double error, double deltaTime_seconds) {
+	// Filter error and rate, starting from the first error
+	if (!hasError) {
+		errorFilter.reset(error, 0);
+		hasError = true;
+	} else {
+		errorFilter.update(error, deltaTime_seconds);
+	}
+	elapsed_seconds += std::fmax(0, deltaTime_seconds);
+	double filteredError = errorFilter.getValue();
+	double errorRate = errorFilter.getRate();
+
+	// Error left after braking to a stop
+	double stoppingError = errorRate * std::fabs(errorRate) / (2 * brakeDeceleration);
+	predictedFinalError = filteredError + stoppingError;
+
+	// Require the prediction to hold over consecutive frames
+	bool willSettle = std::fabs(predictedFinalError) < settleRange && std::fabs(errorRate) < maxSettleRate;
+	if (willSettle) {
+		predictedFrameCount++;
+	} else {
+		predictedFrameCount = 0;
+	}
+	if (isPredictedSettled() && firstPredicted_seconds < 0) {
+		firstPredicted_seconds = elapsed_seconds;
+	}
+}
+
+bool SettlePredictor::isPredictedSettled() {
+	return predictedFrameCount >= confirmFrameCount;
+}
+
+double SettlePredictor::getPredictedFinalError() {
+	return predictedFinalError;
+}
+
+double SettlePredictor::getErrorRate() {
+	return errorFilter.getRate();
+}
+
+double SettlePredictor::getRemainingTime_seconds() {
+	// Time to enter the range at the current rate, then the settle check's own wait
+	double outsideRange = std::fabs(errorFilter.getValue()) - settleRange;
+	double errorSpeed = std::fabs(errorFilter.getRate());
+	double entry_seconds = 0;
+	if (outsideRange > 0) {
+		entry_seconds = (errorSpeed > 1e-6) ? (outsideRange / errorSpeed) : settleConfirm_seconds;
+	}
+	return entry_seconds + settleConfirm_seconds;
+}
+
+void SettlePredictor::recordMove(const char *moveName, bool isHandedOff) {
+	if (isHandedOff) {
+		settlestats::recordMove(moveName, elapsed_seconds, getRemainingTime_seconds(), true, false);
+	} else if (firstPredicted_seconds >= 0) {
+		settlestats::recordMove(moveName, elapsed_seconds, elapsed_seconds - firstPredicted_seconds, false, true);
+	} else {
+		settlestats::recordMove(moveName, elapsed_seconds, 0, false, false);
+	}
+}
+
+
+namespace settlestats {
+	void recordMove(const char *name, double duration_seconds, double saved_seconds, bool isHandedOff, bool isMeasured) {
+		if (moveCount < maxMoveCount) {
+			MoveStats &move = moves[moveCount];
+			move.name = name;
+			move.duration_seconds = duration_seconds;
+			move.saved_seconds = saved_seconds;
+			move.isHandedOff = isHandedOff;
+			move.isMeasured = isMeasured;
+		}
+		moveCount++;
+
+		// Totals
+		if (isHandedOff) {
+			handedOffCount++;
+			totalSaved_seconds += saved_seconds;
+		} else if (isMeasured) {
+			totalMeasuredSaved_seconds += saved_seconds;
+		}
+	}
+
+	int getMoveCount() {
+		return moveCount;
+	}
+
+	double getTotalSaved_seconds() {
+		return totalSaved_seconds;
+	}
+
+	void resetStats() {
+		moveCount = 0;
+		handedOffCount = 0;
+		totalSaved_seconds = 0;
+		totalMeasuredSaved_seconds = 0;
+	}
+
+	void printStats() {
+		printf("Settle: %d moves, %d handed off, saved %.3f s (estimated), %.3f s (measured)\n",
+			moveCount, handedOffCount, totalSaved_seconds, totalMeasuredSaved_seconds
+		);
+		int printCount = moveCount < maxMoveCount ? moveCount : maxMoveCount;
+		for (int i = 0; i < printCount; i++) {
+			const MoveStats &move = moves[i];
+			const char *kind = move.isHandedOff ? "handoff" : (move.isMeasured ? "measured" : "-");
+			printf("  %2d %-10s %6.3f s  saved %6.3f s  %s\n", i, move.name, move.duration_seconds, move.saved_seconds, kind);
+		}
+	}
+}
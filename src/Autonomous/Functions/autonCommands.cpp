@@ -0,0 +1,184 @@
+#include "Autonomous/autonCommands.h"
+
+#include "Autonomous/autonFunctions.h"
+
+#include "main.h"
+
+namespace {
+	using namespace autonfunctions;
+
+	/// @brief Finishes after a fixed time.
+	class WaitCommand : public Command {
+	public:
+		WaitCommand(double seconds) {
+			duration_seconds = seconds;
+		}
+
+		void initialize() override {
+			waitTimer.reset();
+		}
+
+		bool isFinished() override {
+			return waitTimer.value() >= duration_seconds;
+		}
+
+	private:
+		double duration_seconds;
+		vclock::Timer waitTimer;
+	};
+
+	/// @brief Finishes once a condition holds.
+	class WaitForCommand : public Command {
+	public:
+		WaitForCommand(bool (*condition)()) {
+			this->condition = condition;
+		}
+
+		bool isFinished() override {
+			return condition();
+		}
+
+	private:
+		bool (*condition)();
+	};
+
+	/// @brief Runs an action once and finishes.
+	class InstantCommand : public Command {
+	public:
+		InstantCommand(void (*action)(), int requirements) {
+			this->action = action;
+			this->requirements = requirements;
+		}
+
+		void initialize() override {
+			action();
+		}
+
+	private:
+		void (*action)();
+	};
+
+	/// @brief Finishes once the running drive-turn is within a distance of its target.
+	class WaitForDriveTurnDistanceCommand : public Command {
+	public:
+		WaitForDriveTurnDistanceCommand(double distanceError_tiles) {
+			this->distanceError_tiles = distanceError_tiles;
+		}
+
+		bool isFinished() override {
+			return driveturn::_linearPathDistanceError < distanceError_tiles;
+		}
+
+	private:
+		double distanceError_tiles;
+	};
+
+	/// @brief Follows the current spline path until it completes.
+	class FollowSplinePathCommand : public Command {
+	public:
+		FollowSplinePathCommand(bool reverseHeading) {
+			this->reverseHeading = reverseHeading;
+			requirements = commandsubsystem::Drive;
+		}
+
+		void initialize() override {
+			autonfunctions::followSplinePath(reverseHeading);
+		}
+
+		bool isFinished() override {
+			return _pathFollowCompleted;
+		}
+
+		void end(bool isInterrupted) override {
+			// Stop the follower
+			if (isInterrupted) {
+				_pathFollowCompleted = true;
+			}
+		}
+
+	private:
+		bool reverseHeading;
+	};
+
+	/// @brief Sets a mechanism state once.
+	class SetStateCommand : public Command {
+	public:
+		SetStateCommand(void (*setState)(int, double), int state, int requirements) {
+			this->setState = setState;
+			this->state = state;
+			this->requirements = requirements;
+		}
+
+		void initialize() override {
+			setState(state, 0);
+		}
+
+	private:
+		void (*setState)(int, double);
+		int state;
+	};
+}
+
+namespace autoncommands {
+	/// @brief Runs commands one after another.
+	Command *sequence(std::initializer_list<Command *> commands) {
+		return new SequentialCommandGroup(commands);
+	}
+
+	/// @brief Runs commands together, until all of them finish.
+	Command *parallel(std::initializer_list<Command *> commands) {
+		return new ParallelCommandGroup(commands, ParallelCommandGroup::AllFinished);
+	}
+
+	/// @brief Runs commands together, until any of them finishes.
+	Command *race(std::initializer_list<Command *> commands) {
+		return new ParallelCommandGroup(commands, ParallelCommandGroup::AnyFinished);
+	}
+
+	/// @brief Runs commands together, until the first one finishes.
+	Command *deadline(std::initializer_list<Command *> commands) {
+		return new ParallelCommandGroup(commands, ParallelCommandGroup::FirstFinished);
+	}
+
+	Command *waitSeconds(double seconds) {
+		return new WaitCommand(seconds);
+	}
+
+	Command *waitFor(bool (*condition)()) {
+		return new WaitForCommand(condition);
+	}
+
+	Command *instant(void (*action)(), int requirements) {
+		return new InstantCommand(action, requirements);
+	}
+
+	Command *driveTurnToFace(double x_tiles, double y_tiles, bool isReverse, double maxVelocityPct, double maxTurnVelocityPct, double runTimeout) {
+		return driveturn::createDriveTurnToFaceCommand(x_tiles, y_tiles, isReverse, maxVelocityPct, maxTurnVelocityPct, runTimeout);
+	}
+
+	Command *waitForDriveTurnDistance(double distanceError_tiles) {
+		return new WaitForDriveTurnDistanceCommand(distanceError_tiles);
+	}
+
+	Command *followSplinePath(bool reverseHeading) {
+		return new FollowSplinePathCommand(reverseHeading);
+	}
+
+	Command *setIntakeState(int state) {
+		return new SetStateCommand([](int state, double delaySec) {
+			autonfunctions::setIntakeState(state, delaySec);
+		}, state, commandsubsystem::Intake);
+	}
+
+	Command *setArmStage(int stage) {
+		return new SetStateCommand([](int stage, double delaySec) {
+			autonfunctions::setArmStage(stage, delaySec);
+		}, stage, commandsubsystem::Arm);
+	}
+
+	Command *setGoalClampState(bool state) {
+		return new SetStateCommand([](int state, double delaySec) {
+			autonfunctions::setGoalClampState(state, delaySec);
+		}, state, commandsubsystem::Clamp);
+	}
+}
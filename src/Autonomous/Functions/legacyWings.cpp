@@ -1,85 +1,64 @@
 #include "Autonomous/autonFunctions.h"
 
+#include "Utilities/dispatcher.h"
+
 #include "main.h"
 
 namespace {
-	double setFrontWings_DelaySec;
-	double setLeftWing_DelaySec;
-	double setRightWing_DelaySec;
-	double setWings_DelaySec;
-	bool setFrontWings_WingState;
-	bool setLeftWing_LeftWingState;
-	bool setRightWing_RightWingState;
-	bool setWings_WingsState;
+	// Pending delayed sets
+	int frontWingsStateHandle = -1;
+	int leftWingStateHandle = -1;
+	int rightWingStateHandle = -1;
+	int backWingsStateHandle = -1;
 }
 
 namespace autonfunctions {
 	/// @brief Set the state of Front Wings's pneumatic.
 	/// @param state Expanded: true, retracted: false.
-	/// @param delaySec Number of seconds to wait before setting the pneumatic state (in a task).
+	/// @param delaySec Number of seconds to wait before setting the pneumatic state.
 	void setFrontWingsState(bool state, double delaySec) {
-		setFrontWings_WingState = state;
-		setFrontWings_DelaySec = delaySec;
-		task setPneumaticState([]() -> int {
-			int taskState = setFrontWings_WingState;
+		// Replace an earlier delayed set
+		dispatcher::cancel(frontWingsStateHandle);
 
-			if (setFrontWings_DelaySec > 1e-9) {
-				task::sleep(setFrontWings_DelaySec * 1000);
-			}
+		frontWingsStateHandle = dispatcher::schedule(delaySec, [](double taskState) {
 			FrontWingsPneumatic.set(taskState);
-			return 1;
-		});
+		}, state);
 	}
 
 	/// @brief Set the state of Left Wing's pneumatic.
 	/// @param state Expanded: true, retracted: false.
-	/// @param delaySec Number of seconds to wait before setting the pneumatic state (in a task).
+	/// @param delaySec Number of seconds to wait before setting the pneumatic state.
 	void setLeftWingState(bool state, double delaySec) {
-		setLeftWing_LeftWingState = state;
-		setLeftWing_DelaySec = delaySec;
-		task setPneumaticState([]() -> int {
-			int taskState = setLeftWing_LeftWingState;
+		// Replace an earlier delayed set
+		dispatcher::cancel(leftWingStateHandle);
 
-			if (setLeftWing_DelaySec > 1e-9) {
-				task::sleep(setLeftWing_DelaySec * 1000);
-			}
+		leftWingStateHandle = dispatcher::schedule(delaySec, [](double taskState) {
 			LeftWingPneumatic.set(taskState);
-			return 1;
-		});
+		}, state);
 	}
 
 	/// @brief Set the state of Right Wing's pneumatic.
 	/// @param state Expanded: true, retracted: false.
-	/// @param delaySec Number of seconds to wait before setting the pneumatic state (in a task).
+	/// @param delaySec Number of seconds to wait before setting the pneumatic state.
 	void setRightWingState(bool state, double delaySec) {
-		setRightWing_RightWingState = state;
-		setRightWing_DelaySec = delaySec;
-		task setPneumaticState([]() -> int {
-			int taskState = setRightWing_RightWingState;
+		// Replace an earlier delayed set
+		dispatcher::cancel(rightWingStateHandle);
 
-			if (setRightWing_DelaySec > 1e-9) {
-				task::sleep(setRightWing_DelaySec * 1000);
-			}
+		rightWingStateHandle = dispatcher::schedule(delaySec, [](double taskState) {
 			RightWingPneumatic.set(taskState);
-			return 1;
-		});
+		}, state);
 	}
 
 	/// @brief Set the state of Left and Right Wing's pneumatic.
 	/// @param state Expanded: true, retracted: false.
-	/// @param delaySec Number of seconds to wait before setting the pneumatic state (in a task).
+	/// @param delaySec Number of seconds to wait before setting the pneumatic state.
 	void setBackWingsState(bool state, double delaySec) {
-		setWings_WingsState = state;
-		setWings_DelaySec = delaySec;
-		task setPneumaticsState([]() -> int {
-			int taskState = setWings_WingsState;
+		// Replace an earlier delayed set
+		dispatcher::cancel(backWingsStateHandle);
 
-			if (setWings_DelaySec > 1e-9) {
-				task::sleep(setWings_DelaySec * 1000);
-			}
+		backWingsStateHandle = dispatcher::schedule(delaySec, [](double taskState) {
 			LeftWingPneumatic.set(taskState);
 			RightWingPneumatic.set(taskState);
-			return 1;
-		});
+		}, state);
 	}
 }
@@ -19,11 +19,11 @@ namespace autonfunctions {
 		mainOdometry.setLookAngle(rotation);
 	}
 
-	timer _autonTimer;
+	vclock::Timer _autonTimer;
 
 	/// @brief Set the state of the intake.
 	/// @param state Forward: 1, released: 0, reversed: -1
-	/// @param delaySec Number of seconds to wait before setting the state (in a task).
+	/// @param delaySec Number of seconds to wait before setting the state.
 	void setIntakeState(int state, double delaySec) {
 		if (intakePart == 1) botintake::setState(state, delaySec);
 		else botintake2::setState(state, delaySec);
@@ -32,7 +32,7 @@ namespace autonfunctions {
 
 	/// @brief Set the state of the top intake.
 	/// @param state Forward: 1, released: 0, reversed: -1
-	/// @param delaySec Number of seconds to wait before setting the state (in a task).
+	/// @param delaySec Number of seconds to wait before setting the state.
 	void setIntakeTopState(int state, double delaySec) {
 		if (intakePart == 1) return;
 		else botintake2::setState2(state, delaySec);
@@ -41,7 +41,7 @@ namespace autonfunctions {
 
 	/// @brief Set the state of the bottom intake.
 	/// @param state Forward: 1, released: 0, reversed: -1
-	/// @param delaySec Number of seconds to wait before setting the state (in a task).
+	/// @param delaySec Number of seconds to wait before setting the state.
 	void setIntakeBottomState(int state, double delaySec) {
 		if (intakePart == 1) return;
 		else botintake2::setState3(state, delaySec);
@@ -78,7 +78,7 @@ namespace autonfunctions {
 
 	/// @brief Set the state of Left Wing's pneumatic.
 	/// @param state Expanded: true, retracted: false.
-	/// @param delaySec Number of seconds to wait before setting the pneumatic state (in a task).
+	/// @param delaySec Number of seconds to wait before setting the pneumatic state.
 	void setGoalClampState(bool state, double delaySec) {
 		goalclamp::setState(state, delaySec);
 	}
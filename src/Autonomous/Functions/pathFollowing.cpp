@@ -1,6 +1,8 @@
 #include "Autonomous/autonFunctions.h"
 
 #include "AutonUtilities/ramseteController.h"
+#include "AutonUtilities/ltvUnicycleController.h"
+#include "AutonUtilities/mpcController.h"
 #include "AutonUtilities/linegular.h"
 #include "AutonUtilities/odometry.h"
 
@@ -11,17 +13,59 @@
 #include "Mechanics/botDrive.h"
 
 #include "Utilities/generalUtility.h"
-
-#include "Simulation/robotSimulator.h"
+#include "Utilities/scheduler.h"
+#include "Utilities/timingProbe.h"
 
 #include "main.h"
 
 namespace {
-	// Controller
+	// Controllers
 	RamseteController robotController;
+	LtvUnicycleController ltvController;
+	bool useLtvController = false;
+	MpcController mpcController;
+	bool useMpcController = false;
+
+	// Path samples, for modes that follow by progress
+	std::vector<CurvePoint> pathPoints;
+	int closestPointIndex = 0;
+
+	const double pathPointSpacing_tiles = 0.05;
+	const int closestPointSearchWindow = 20;
+	const double minFollowVelocity_tilesPerSecond = 0.3;
+
+	// Progress indexing
+	bool useProgressIndex = false;
+
+	const double progressMinLead_tiles = 0.05;
+	const double progressMaxLead_tiles = 0.3;
+	const double progressLeadPerVelocity_seconds = 0.1;
+	const double progressEndTolerance_tiles = 0.05;
+	const double progressEndHeadingTolerance_degrees = 5;
+
+	// Pure pursuit
+	bool usePurePursuit = false;
 
-	// Simulator
-	bool useSimulator = mainUseSimulator;
+	const double pursuitMinLookahead_tiles = 0.25;
+	const double pursuitMaxLookahead_tiles = 1.0;
+	const double pursuitLookaheadPerVelocity_seconds = 0.3;
+	const double pursuitLookaheadCurvatureGain_tiles = 1.5;
+	const double pursuitEndTolerance_tiles = 0.05;
+
+	// Path handoff
+	// Set when the new path starts at the speed the previous one ended at
+	bool willContinueTimeline = false;
+	double nextPathStartTime_seconds = 0;
+
+	// Scheduler job, registered disabled at startup
+	int pathFollowJobId = -1;
+
+	void followPathFrame();
+	void followPurePursuitFrame();
+	std::pair<double, double> getPurePursuitVelocity(Linegular robotLg);
+	void setMpcReferences(double traj_time, double traj_distance);
+	double updateClosestPoint(double x, double y);
+	bool isPastGiveUpTime();
 }
 
 namespace autonfunctions {
@@ -31,6 +75,16 @@ namespace autonfunctions {
 	}
 
 	void setSplinePath(UniformCubicSpline &splinePath, TrajectoryPlanner &trajectoryPlan, CurveSampler &curveSampler) {
+		// Hand off from a timed path that ended moving into this one
+		willContinueTimeline = (
+			!usePurePursuit && !useProgressIndex
+			&& _pathFollowStarted && _pathFollowCompleted
+			&& _trajectoryPlan.getEndVelocity() > 0 && trajectoryPlan.getStartVelocity() > 0
+		);
+		if (willContinueTimeline) {
+			nextPathStartTime_seconds = _splinePathStartTime_seconds + _trajectoryPlan.getTotalTime();
+		}
+
 		_splinePath = splinePath;
 		_trajectoryPlan = trajectoryPlan;
 		_curveSampler = curveSampler;
@@ -44,82 +98,339 @@ namespace autonfunctions {
 		_pathToPctFactor = factor;
 	}
 
+	void setPathFollowUseLtv(bool useLtv) {
+		useLtvController = useLtv;
+	}
+
+	void setPathFollowUseMpc(bool useMpc) {
+		useMpcController = useMpc;
+	}
+
+	void setPathFollowUsePurePursuit(bool usePursuit) {
+		usePurePursuit = usePursuit;
+	}
+
+	void setPathFollowUseProgress(bool useProgress) {
+		useProgressIndex = useProgress;
+	}
+
 	void followSplinePath(bool reverseHeading) {
+		// Precompute path samples
+		if (usePurePursuit || useProgressIndex) {
+			pathPoints = _curveSampler.getUniformPoints(pathPointSpacing_tiles);
+			closestPointIndex = 0;
+		}
+
 		// Initialize config
-		_pathFollowStarted = true;
-		_pathFollowCompleted = false;
 		_reverseHeading = reverseHeading;
 		robotController.setDirection(reverseHeading);
-
-		// Follow path in thread
-		task followPathTask([]() -> int {
-			// Reset timer
+		ltvController.setDirection(reverseHeading);
+		mpcController.setDirection(reverseHeading);
+		mpcController.reset();
+		if (willContinueTimeline) {
+			_splinePathStartTime_seconds = nextPathStartTime_seconds;
+		} else {
 			_splinePathTimer.reset();
+			_splinePathStartTime_seconds = 0;
+		}
+		willContinueTimeline = false;
+		_pathFollowCompleted = false;
+		_pathFollowStarted = true;
 
-			// Get total distance
-			double totalDistance_tiles = _curveSampler.getDistanceRange().second;
+		// Run the follower job, which may be called from inside a job so only enables it
+		if (pathFollowJobId < 0) {
+			pathFollowJobId = scheduler::findJob("path follow");
+		}
+		scheduler::setJobEnabled(pathFollowJobId, true);
+	}
 
-			// Follow path
-			while (true) {
-				// Get time
-				double traj_time = _splinePathTimer.value();
+	void runPathFollowFrame() {
+		followPathFrame();
+	}
 
-				// Exit when path completed
-				if (traj_time > _trajectoryPlan.getTotalTime() + _pathFollowDelay_seconds) {
-					_pathFollowCompleted = true;
+	vclock::Timer _splinePathTimer;
+	double _splinePathStartTime_seconds = 0;
+	UniformCubicSpline _splinePath;
+	TrajectoryPlanner _trajectoryPlan;
+	CurveSampler _curveSampler;
+	bool _reverseHeading;
+	double _pathToPctFactor = autonvals::tilesPerSecond_to_pct;
+	bool _pathFollowStarted;
+	bool _pathFollowCompleted;
+	double _pathFollowDistanceRemaining_tiles;
+	double _pathFollowDelay_seconds = 0.010;
+}
+
+
+namespace {
+	using namespace autonfunctions;
+
+	/// @brief Follows the spline path for one frame. Called every 10 ms by the scheduler.
+	void followPathFrame() {
+		// Check following
+		if (!_pathFollowStarted || _pathFollowCompleted) {
+			return;
+		}
+		timing::ScopedProbe probe(timing::PathFollowFrame);
+
+		// Pure pursuit mode
+		if (usePurePursuit) {
+			followPurePursuitFrame();
+			return;
+		}
+
+		// Get robot linegular
+		Linegular robotLg = mainOdometry.getLookLinegular();
+
+		// Get reference distance and velocity
+		double totalDistance_tiles = _curveSampler.getDistanceRange().second;
+		double traj_time = 0, traj_distance, traj_velocity, traj_acceleration;
+		if (useProgressIndex) {
+			// Exit if stuck for too long
+			if (pathPoints.empty() || isPastGiveUpTime()) {
+				_pathFollowDistanceRemaining_tiles = 0;
+				_pathFollowCompleted = true;
+				return;
+			}
+
+			// Project the robot onto the path
+			double progress_distance = updateClosestPoint(robotLg.getX(), robotLg.getY());
+			_pathFollowDistanceRemaining_tiles = totalDistance_tiles - progress_distance;
+
+			// Exit when arrived at the end pose
+			if (_pathFollowDistanceRemaining_tiles < progressEndTolerance_tiles) {
+				Linegular endLg = _splinePath.getLinegularAt(_curveSampler.getTRange().second, _reverseHeading);
+				double headingError_degrees = genutil::modRange(endLg.getThetaPolarAngle_degrees() - robotLg.getThetaPolarAngle_degrees(), 360, -180);
+				if (fabs(headingError_degrees) < progressEndHeadingTolerance_degrees) {
 					_pathFollowDistanceRemaining_tiles = 0;
-					break;
+					_pathFollowCompleted = true;
+					return;
 				}
+			}
+
+			// Lead the projection by a bounded distance
+			double progress_velocity = _trajectoryPlan.getMotionAtDistance(progress_distance)[1];
+			double lead_tiles = genutil::clamp(
+				progress_velocity * progressLeadPerVelocity_seconds,
+				progressMinLead_tiles, progressMaxLead_tiles
+			);
+			traj_distance = std::min(progress_distance + lead_tiles, totalDistance_tiles);
+
+			// Use the planned velocity at the reference
+			std::vector<double> motion = _trajectoryPlan.getMotionAtDistance(traj_distance);
+			traj_velocity = motion[1];
+			traj_acceleration = motion[2];
+			if (totalDistance_tiles - traj_distance > progressEndTolerance_tiles) {
+				traj_velocity = std::max(traj_velocity, minFollowVelocity_tilesPerSecond);
+			}
+		} else {
+			// Get time
+			traj_time = _splinePathTimer.value() - _splinePathStartTime_seconds;
 
-				// Get trajectory motion
-				std::vector<double> motion = _trajectoryPlan.getMotionAtTime(traj_time);
-				double traj_distance = motion[0];
-				double traj_velocity = motion[1];
-				double traj_tvalue = _curveSampler.distanceToParam(traj_distance);
-				double traj_angularVelocity = traj_velocity * _splinePath.getCurvatureAt(traj_tvalue);
+			// Exit when path completed
+			// A path ending in motion exits on time, so the next path takes over without a gap
+			double exitDelay_seconds = (_trajectoryPlan.getEndVelocity() > 0) ? 0 : _pathFollowDelay_seconds;
+			if (traj_time > _trajectoryPlan.getTotalTime() + exitDelay_seconds) {
+				_pathFollowDistanceRemaining_tiles = 0;
+				_pathFollowCompleted = true;
+				return;
+			}
 
-				// Update distance remaining
-				_pathFollowDistanceRemaining_tiles = totalDistance_tiles - traj_distance;
+			// Get trajectory motion
+			std::vector<double> motion = _trajectoryPlan.getMotionAtTime(traj_time);
+			traj_distance = motion[0];
+			traj_velocity = motion[1];
+			traj_acceleration = motion[2];
 
-				// Get robot and target linegular
-				Linegular robotLg = mainOdometry.getLookLinegular();
-				Linegular targetLg = _splinePath.getLinegularAt(traj_tvalue, _reverseHeading);
+			// Update distance remaining
+			_pathFollowDistanceRemaining_tiles = totalDistance_tiles - traj_distance;
+		}
+		double traj_tvalue = _curveSampler.distanceToParam(traj_distance);
+		double traj_curvature = _splinePath.getCurvatureAt(traj_tvalue);
+		double traj_angularVelocity = traj_velocity * traj_curvature;
 
-				if (useSimulator) {
-					robotLg = Linegular(robotSimulator.position.x, robotSimulator.position.y, genutil::toDegrees(robotSimulator.angularPosition));
-				}
+		// Get target linegular
+		Linegular targetLg = _splinePath.getLinegularAt(traj_tvalue, _reverseHeading);
 
-				// Get desired robot motion (linear and angular)
-				std::pair<double, double> linegularVelocity = robotController.getLinegularVelocity(robotLg, targetLg, traj_velocity, traj_angularVelocity);
+		// Get desired robot motion (linear and angular)
+		std::pair<double, double> linegularVelocity;
+		if (useMpcController) {
+			setMpcReferences(traj_time, traj_distance);
+			linegularVelocity = mpcController.getLinegularVelocity(robotLg);
+		} else if (useLtvController) {
+			linegularVelocity = ltvController.getLinegularVelocity(robotLg, targetLg, traj_velocity, traj_angularVelocity);
+		} else {
+			linegularVelocity = robotController.getLinegularVelocity(robotLg, targetLg, traj_velocity, traj_angularVelocity);
+		}
 
-				// Convert linear velocity units
-				linegularVelocity.first *= _pathToPctFactor;
+		// Drive, into the simulator's drive model when simulating
+		// Feedforward on the planned acceleration, in the direction of travel
+		double velocityScale = _pathToPctFactor / autonvals::tilesPerSecond_to_pct;
+		double linearAcceleration = (_reverseHeading ? -traj_acceleration : traj_acceleration) * velocityScale;
+		double angularAcceleration = traj_acceleration * traj_curvature;
+		botdrive::driveLinegularMotion(linegularVelocity.first * velocityScale, linegularVelocity.second, linearAcceleration, angularAcceleration);
+	}
+
+	/// @brief Fills the MPC horizon with the reference ahead of the current one.
+	void setMpcReferences(double traj_time, double traj_distance) {
+		int horizonSteps = mpcController.getHorizonSteps();
+		double stepTime_seconds = mpcController.getStepTime_seconds();
+		double totalDistance_tiles = _curveSampler.getDistanceRange().second;
 
-				// Drive
-				if (!useSimulator) {
-					botdrive::driveLinegularVelocity(linegularVelocity.first, linegularVelocity.second);
-				} else {
-					robotSimulator.position = Vector3(targetLg.getX(), targetLg.getY());
-					robotSimulator.angularPosition = targetLg.getThetaPolarAngle_radians();
+		double step_distance = traj_distance;
+		for (int k = 0; k < horizonSteps; k++) {
+			// Get reference motion at the step, by time or by distance
+			std::vector<double> motion;
+			if (useProgressIndex) {
+				motion = _trajectoryPlan.getMotionAtDistance(step_distance);
+				if (totalDistance_tiles - step_distance > progressEndTolerance_tiles) {
+					motion[1] = std::max(motion[1], minFollowVelocity_tilesPerSecond);
 				}
+			} else {
+				motion = _trajectoryPlan.getMotionAtTime(traj_time + k * stepTime_seconds);
+				step_distance = motion[0];
+			}
 
-				// Wait
-				wait(20, msec);
+			// Set reference
+			double step_tvalue = _curveSampler.distanceToParam(step_distance);
+			double step_curvature = _splinePath.getCurvatureAt(step_tvalue);
+			Linegular stepLg = _splinePath.getLinegularAt(step_tvalue, _reverseHeading);
+			mpcController.setReference(k, stepLg, motion[1], motion[1] * step_curvature);
+
+			// Advance by the planned velocity when following by progress
+			if (useProgressIndex) {
+				step_distance = std::min(step_distance + motion[1] * stepTime_seconds, totalDistance_tiles);
 			}
+		}
+	}
+
+	/// @brief Follows the spline path by pure pursuit for one frame.
+	void followPurePursuitFrame() {
+		// Exit if stuck for too long
+		if (pathPoints.empty() || isPastGiveUpTime()) {
+			_pathFollowDistanceRemaining_tiles = 0;
+			_pathFollowCompleted = true;
+			return;
+		}
+
+		// Get robot linegular
+		Linegular robotLg = mainOdometry.getLookLinegular();
+
+		// Get desired robot motion (linear and angular)
+		std::pair<double, double> linegularVelocity = getPurePursuitVelocity(robotLg);
+
+		// Exit when path completed
+		if (_pathFollowCompleted) {
+			return;
+		}
 
-			// Return int
-			return 1;
-		});
+		// Drive
+		double velocityScale = _pathToPctFactor / autonvals::tilesPerSecond_to_pct;
+		botdrive::driveLinegularMotion(linegularVelocity.first * velocityScale, linegularVelocity.second);
 	}
 
-	timer _splinePathTimer;
-	UniformCubicSpline _splinePath;
-	TrajectoryPlanner _trajectoryPlan;
-	CurveSampler _curveSampler;
-	bool _reverseHeading;
-	double _pathToPctFactor = autonvals::tilesPerSecond_to_pct;
-	bool _pathFollowStarted;
-	bool _pathFollowCompleted;
-	double _pathFollowDistanceRemaining_tiles;
-	double _pathFollowDelay_seconds = 0.010;
+	/// @brief Returns the pure pursuit {linear (tiles/s), angular (rad/s)} velocity.
+	std::pair<double, double> getPurePursuitVelocity(Linegular robotLg) {
+		int pointCount = (int) pathPoints.size();
+		double robotX = robotLg.getX();
+		double robotY = robotLg.getY();
+
+		// Find the closest point
+		updateClosestPoint(robotX, robotY);
+		CurvePoint &closestPoint = pathPoints[closestPointIndex];
+
+		// Update distance remaining
+		double totalDistance_tiles = pathPoints.back().distance;
+		_pathFollowDistanceRemaining_tiles = totalDistance_tiles - closestPoint.distance;
+
+		// Exit when the end is reached
+		double endDistance = hypot(pathPoints.back().x - robotX, pathPoints.back().y - robotY);
+		if (closestPointIndex == pointCount - 1 || endDistance < pursuitEndTolerance_tiles) {
+			_pathFollowDistanceRemaining_tiles = 0;
+			_pathFollowCompleted = true;
+			return std::make_pair(0, 0);
+		}
+
+		// Get planned velocity at the current progress
+		double velocity = _trajectoryPlan.getMotionAtDistance(closestPoint.distance)[1];
+		velocity = std::max(velocity, minFollowVelocity_tilesPerSecond);
+
+		// Scale lookahead up with velocity and down with curvature
+		double lookahead = pursuitMinLookahead_tiles + pursuitLookaheadPerVelocity_seconds * velocity;
+		lookahead /= 1 + pursuitLookaheadCurvatureGain_tiles * fabs(closestPoint.curvature);
+		lookahead = genutil::clamp(lookahead, pursuitMinLookahead_tiles, pursuitMaxLookahead_tiles);
+
+		// Find the first point beyond the lookahead, within a bounded window
+		int lookaheadWindow = (int) ceil(pursuitMaxLookahead_tiles / pathPointSpacing_tiles) * 2;
+		int targetEnd = std::min(pointCount, closestPointIndex + lookaheadWindow + 1);
+		int targetIndex = targetEnd - 1;
+		for (int i = closestPointIndex; i < targetEnd; i++) {
+			double distance = hypot(pathPoints[i].x - robotX, pathPoints[i].y - robotY);
+			if (distance >= lookahead) {
+				targetIndex = i;
+				break;
+			}
+		}
+		CurvePoint &targetPoint = pathPoints[targetIndex];
+
+		// Get target offset in the direction of travel
+		double travelAngle_radians = robotLg.getThetaPolarAngle_radians();
+		if (_reverseHeading) {
+			travelAngle_radians += M_PI;
+		}
+		double deltaX = targetPoint.x - robotX;
+		double deltaY = targetPoint.y - robotY;
+		double leftOffset = -deltaX * sin(travelAngle_radians) + deltaY * cos(travelAngle_radians);
+		double targetDistanceSquared = deltaX * deltaX + deltaY * deltaY;
+
+		// Curvature of the arc through the target
+		// k = 2x / L^2
+		double arcCurvature = 0;
+		if (targetDistanceSquared > 1e-6) {
+			arcCurvature = 2 * leftOffset / targetDistanceSquared;
+		}
+
+		// Convert to linegular velocity
+		double linearVelocity = _reverseHeading ? -velocity : velocity;
+		double angularVelocity = velocity * arcCurvature;
+		return std::make_pair(linearVelocity, angularVelocity);
+	}
+
+	/// @brief Moves the closest path sample forward to the robot, searching a bounded window.
+	/// @return The robot's projected distance along the path.
+	double updateClosestPoint(double x, double y) {
+		int pointCount = (int) pathPoints.size();
+
+		// Find the closest point, searching forward from the last one
+		int searchEnd = std::min(pointCount, closestPointIndex + closestPointSearchWindow + 1);
+		double closestDistance = 1e9;
+		for (int i = closestPointIndex; i < searchEnd; i++) {
+			double distance = hypot(pathPoints[i].x - x, pathPoints[i].y - y);
+			if (distance < closestDistance) {
+				closestDistance = distance;
+				closestPointIndex = i;
+			}
+		}
+		CurvePoint &closestPoint = pathPoints[closestPointIndex];
+		if (closestPointIndex + 1 >= pointCount) {
+			return closestPoint.distance;
+		}
+
+		// Project onto the segment to the next point
+		CurvePoint &nextPoint = pathPoints[closestPointIndex + 1];
+		double segmentX = nextPoint.x - closestPoint.x;
+		double segmentY = nextPoint.y - closestPoint.y;
+		double segmentLength = hypot(segmentX, segmentY);
+		if (segmentLength < 1e-6) {
+			return closestPoint.distance;
+		}
+		double projection = ((x - closestPoint.x) * segmentX + (y - closestPoint.y) * segmentY) / segmentLength;
+		projection = genutil::clamp(projection, 0, nextPoint.distance - closestPoint.distance);
+		return closestPoint.distance + projection;
+	}
+
+	/// @brief Whether a progress-based follow has run well past its planned time.
+	bool isPastGiveUpTime() {
+		return _splinePathTimer.value() - _splinePathStartTime_seconds > _trajectoryPlan.getTotalTime() * 2 + 1;
+	}
 }
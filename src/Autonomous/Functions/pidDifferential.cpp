@@ -1,16 +1,19 @@
 #include "Autonomous/autonFunctions.h"
 
-#include "AutonUtilities/driftCorrection.h"
 #include "AutonUtilities/pidController.h"
 #include "AutonUtilities/linegular.h"
 #include "AutonUtilities/patienceController.h"
+#include "AutonUtilities/settlePredictor.h"
 
 #include "Mechanics/botDrive.h"
 
+#include "GraphUtilities/trajectoryPlanner.h"
+
 #include "Utilities/angleUtility.h"
 #include "Utilities/robotInfo.h"
 #include "Utilities/fieldInfo.h"
 #include "Utilities/generalUtility.h"
+#include "Utilities/sysidConstants.h"
 
 #include "Simulation/robotSimulator.h"
 
@@ -23,19 +26,41 @@ namespace {
 	bool useRotationSensorForPid = false;
 	bool useEncoderForPid = false;
 
-	// DriftCorrection driftCorrector(InertialSensor, -3.276, 3.651);
-	DriftCorrection driftCorrector(InertialSensor, 0, 0);
-
 	// Some controllers
 	PatienceController angleError_degreesPatience(8, 1.0, false);
 	PatienceController driveError_inchesPatience(4, 1.0, false);
 
-	PIDController turnToAngle_rotateTargetAngleVoltPid(2.5, 0.0, 0.16, autonvals::defaultTurnAngleErrorRange);
-	PIDController turnToAngle_rotateTargetAngleVelocityPctPid(0.4, 0.0, 0.03, autonvals::defaultTurnAngleErrorRange);
+	PIDControllerCore<pidfeature::DerivativeFilter> turnToAngle_rotateTargetAngleVoltPid(2.5, 0.0, 0.16, autonvals::defaultTurnAngleErrorRange);
+	PIDControllerCore<pidfeature::DerivativeFilter> turnToAngle_rotateTargetAngleVelocityPctPid(0.4, 0.0, 0.03, autonvals::defaultTurnAngleErrorRange);
+
+	PIDControllerCore<pidfeature::DerivativeFilter> driveAndTurn_driveTargetDistancePid(17, 0, 1.6, autonvals::defaultMoveWithInchesErrorRange);
+	PIDControllerCore<pidfeature::DerivativeFilter | pidfeature::IntegralClamp> driveAndTurn_rotateTargetAnglePid(1.0, 0.05, 0.01, autonvals::defaultTurnAngleErrorRange);
+	PIDControllerCore<pidfeature::SlewLimit> driveAndTurn_synchronizeVelocityPid(0.4, 0, 0, 5.0);
+
+	// Controller config
+	const double derivativeFilter_seconds = 0.04;
+	const double rotateIntegralLimit_pct = 10;
+	const double synchronizeSlewRate_pctPerSecond = 200;
+
+	// Settle prediction, braking at half the drive's acceleration
+	const double settleBrakeDecel_tilesPerSecondSquared = 0.5 * fmin(sysidconstants::driveLeftMaxAcceleration_tilesPerSecondSquared, sysidconstants::driveRightMaxAcceleration_tilesPerSecondSquared);
+	const double settleBrakeDecel_degreesPerSecondSquared = genutil::toDegrees(settleBrakeDecel_tilesPerSecondSquared / (botinfo::halfRobotLengthIn / field::tileLengthIn));
+	const double settleMaxRate_tilesPerSecond = 0.4;
+	const double settleMaxRate_degreesPerSecond = 90;
+	const double settleConfirm_seconds = 7 * 0.020; // PIDs' default settle frames at 20 ms
+
+	SettlePredictor turnToAngle_settlePredictor(autonvals::defaultTurnAngleErrorRange, settleBrakeDecel_degreesPerSecondSquared, settleMaxRate_degreesPerSecond, settleConfirm_seconds);
+	SettlePredictor driveAndTurn_settlePredictor(autonvals::defaultMoveWithInchesErrorRange, settleBrakeDecel_tilesPerSecondSquared * field::tileLengthIn, settleMaxRate_tilesPerSecond * field::tileLengthIn, settleConfirm_seconds);
 
-	PIDController driveAndTurn_driveTargetDistancePid(17, 0, 1.6, autonvals::defaultMoveWithInchesErrorRange);
-	PIDController driveAndTurn_rotateTargetAnglePid(1.0, 0.05, 0.01, autonvals::defaultTurnAngleErrorRange);
-	PIDController driveAndTurn_synchronizeVelocityPid(0.4, 0, 0, 5.0);
+	// Profiled turn
+	PIDControllerCore<pidfeature::Feedforward | pidfeature::DerivativeFilter> turnProfiled_rotateTargetAnglePid(2.0, 0, 0.08);
+
+	const double turnProfiled_maxVelocity_degreesPerSecond = 360;
+	const double turnProfiled_maxAccel_degreesPerSecondSquared = 1200;
+	const double turnProfiled_maxDecel_degreesPerSecondSquared = 900;
+	const double turnProfiled_brakeDecel_degreesPerSecondSquared = 2000;
+	const double turnProfiled_settleError_degrees = 1.5;
+	const double turnProfiled_maxSettleVelocity_degreesPerSecond = 30;
 
 	// Simulator
 	bool useSimulator = mainUseSimulator;
@@ -58,9 +83,6 @@ namespace autonfunctions {
 	/// @param rotateCenterOffsetIn The offset of the center of rotation.
 	/// @param runTimeout Maximum seconds the function will run for.
 	void turnToAngleVelocity(double rotation, double maxVelocityPct, double rotateCenterOffsetIn, double runTimeout) {
-		// Set corrector
-		driftCorrector.setInitial();
-
 		// Center of rotations
 		double leftRotateRadiusIn = botinfo::halfRobotLengthIn + rotateCenterOffsetIn;
 		double rightRotateRadiusIn = botinfo::halfRobotLengthIn - rotateCenterOffsetIn;
@@ -79,25 +101,32 @@ namespace autonfunctions {
 		bool useVolt = maxVelocityPct > 25.0;
 
 		// Reset PID
+		turnToAngle_rotateTargetAngleVoltPid.setDerivativeFilter(derivativeFilter_seconds);
+		turnToAngle_rotateTargetAngleVelocityPctPid.setDerivativeFilter(derivativeFilter_seconds);
 		turnToAngle_rotateTargetAngleVoltPid.resetErrorToZero();
 		turnToAngle_rotateTargetAngleVelocityPctPid.resetErrorToZero();
 
 		// Reset patience
 		angleError_degreesPatience.reset();
+		turnToAngle_settlePredictor.reset();
+		bool isHandedOff = false;
 
 		// Reset timer
-		timer timeout;
+		vclock::Timer timeout;
+		vclock::Timer frameTimer;
 
 		while (!turnToAngle_rotateTargetAngleVoltPid.isSettled() && timeout.value() < runTimeout) {
+			// Frame time
+			double deltaTime_seconds = frameTimer.value();
+			frameTimer.reset();
+
 			// Check exhausted
 			if (angleError_degreesPatience.isExhausted()) {
 				break;
 			}
 
-			// printf("Inertial value: %.3f\n", InertialSensor.rotation(degrees));
-
 			// Get current robot heading
-			double currentRotation_degrees = InertialSensor.rotation(degrees);
+			double currentRotation_degrees = mainOdometry.getLookFieldAngle_degrees();
 
 			// Compute heading error
 			double rotateError = rotation - currentRotation_degrees;
@@ -106,12 +135,19 @@ namespace autonfunctions {
 			}
 
 			// Compute heading pid-value from error
-			turnToAngle_rotateTargetAngleVoltPid.computeFromError(rotateError);
-			turnToAngle_rotateTargetAngleVelocityPctPid.computeFromError(rotateError);
+			turnToAngle_rotateTargetAngleVoltPid.computeFromError(rotateError, deltaTime_seconds);
+			turnToAngle_rotateTargetAngleVelocityPctPid.computeFromError(rotateError, deltaTime_seconds);
 
 			// Update error patience
 			angleError_degreesPatience.computePatience(std::fabs(rotateError));
 
+			// Hand off once predicted to settle
+			turnToAngle_settlePredictor.update(rotateError, deltaTime_seconds);
+			if (_usePredictiveSettle && turnToAngle_settlePredictor.isPredictedSettled()) {
+				isHandedOff = true;
+				break;
+			}
+
 			// Compute motor rotate velocities
 			double averageMotorVelocityPct;
 			if (useVolt) {
@@ -134,14 +170,87 @@ namespace autonfunctions {
 				botdrive::driveVelocity(leftMotorVelocityPct, rightMotorVelocityPct);
 			}
 
-			task::sleep(20);
+			vclock::sleep(20);
 		}
 
 		// Stop
-		LeftRightMotors.stop(brake);
+		botdrive::stopDrive(brake);
+		turnToAngle_settlePredictor.recordMove("turn", isHandedOff);
+	}
+
+	/// @brief Turn the robot to face a specified angle, following a trapezoidal angular profile.
+	/// @param rotation The target angle to face in degrees.
+	/// @param maxVelocityPct Maximum velocity of the rotation, as a percentage of the profile's velocity.
+	/// @param runTimeout Maximum seconds the function will run for.
+	void turnToAngleProfiled(double rotation, double maxVelocityPct, double runTimeout) {
+		// Compute rotation to travel
+		double startRotation_degrees = mainOdometry.getLookFieldAngle_degrees();
+		double travelRotation_degrees = rotation - startRotation_degrees;
+		if (_useRelativeRotation) {
+			travelRotation_degrees = genutil::modRange(travelRotation_degrees, 360, -180);
+		}
+		double direction = genutil::signum(travelRotation_degrees);
+		double targetRotation_degrees = startRotation_degrees + travelRotation_degrees;
+
+		// Generate profile over the rotation's magnitude
+		double maxVelocity_degreesPerSecond = turnProfiled_maxVelocity_degreesPerSecond * genutil::clamp(maxVelocityPct, 1, 100) / 100.0;
+		TrajectoryPlanner turnProfile = TrajectoryPlanner(std::fabs(travelRotation_degrees))
+			.addDesiredMotionConstraints(0, maxVelocity_degreesPerSecond, turnProfiled_maxAccel_degreesPerSecondSquared, turnProfiled_maxDecel_degreesPerSecondSquared)
+			.calculateMotion();
+		double profileTime_seconds = turnProfile.getTotalTime();
+
+		// Feedforward from drive geometry: percent velocity per degree per second
+		double kV_pctPerDegreesPerSecond = genutil::toRadians(1) * botinfo::halfRobotLengthIn * (1.0 / field::tileLengthIn) * autonvals::tilesPerSecond_to_pct;
+		turnProfiled_rotateTargetAnglePid.setFeedforward(0, kV_pctPerDegreesPerSecond, 0);
+		turnProfiled_rotateTargetAnglePid.setDerivativeFilter(derivativeFilter_seconds);
+		turnProfiled_rotateTargetAnglePid.resetErrorToZero();
+
+		// Set stopping
+		LeftRightMotors.setStopping(brake);
 
-		// Correct
-		driftCorrector.correct();
+		// Reset timer
+		vclock::Timer timeout;
+		vclock::Timer frameTimer;
+
+		while (timeout.value() < runTimeout) {
+			// Frame time
+			double deltaTime_seconds = frameTimer.value();
+			frameTimer.reset();
+
+			// Get current state
+			double currentRotation_degrees = mainOdometry.getLookFieldAngle_degrees();
+			double currentVelocity_degreesPerSecond = -genutil::toDegrees(mainOdometry.getAngularVelocity_radiansPerSecond());
+
+			// Exit when the robot is predicted to stop within range
+			double stoppingRotation_degrees = currentVelocity_degreesPerSecond * std::fabs(currentVelocity_degreesPerSecond) / (2 * turnProfiled_brakeDecel_degreesPerSecondSquared);
+			double predictedError_degrees = targetRotation_degrees - (currentRotation_degrees + stoppingRotation_degrees);
+			bool isProfileDone = timeout.value() >= profileTime_seconds;
+			if (isProfileDone && std::fabs(predictedError_degrees) < turnProfiled_settleError_degrees && std::fabs(currentVelocity_degreesPerSecond) < turnProfiled_maxSettleVelocity_degreesPerSecond) {
+				break;
+			}
+
+			// Get profile state
+			std::vector<double> motion = turnProfile.getMotionAtTime(timeout.value());
+			double profileRotation_degrees = startRotation_degrees + direction * motion[0];
+			double profileVelocity_degreesPerSecond = direction * motion[1];
+			double profileAccel_degreesPerSecondSquared = direction * motion[2];
+
+			// Track profile with feedforward and feedback
+			double rotateError = profileRotation_degrees - currentRotation_degrees;
+			turnProfiled_rotateTargetAnglePid.setFeedforwardReference(profileVelocity_degreesPerSecond, profileAccel_degreesPerSecondSquared);
+			turnProfiled_rotateTargetAnglePid.computeFromError(rotateError, deltaTime_seconds);
+			double averageMotorVelocityPct = turnProfiled_rotateTargetAnglePid.getValue();
+
+			// Drive with voltages
+			double leftMotorVelocityPct = averageMotorVelocityPct;
+			double rightMotorVelocityPct = -averageMotorVelocityPct;
+			botdrive::driveVoltage(genutil::pctToVolt(leftMotorVelocityPct), genutil::pctToVolt(rightMotorVelocityPct), 12);
+
+			vclock::sleep(10);
+		}
+
+		// Stop
+		botdrive::stopDrive(brake);
 	}
 
 	/// @brief Drive straight in the direction of the robot for a specified tile distance.
@@ -149,7 +258,7 @@ namespace autonfunctions {
 	/// @param maxVelocityPct Maximum velocity of the drive. (can > 100)
 	/// @param runTimeout Maximum seconds the function will run for.
 	void driveDistanceTiles(double distanceTiles, double maxVelocityPct, double runTimeout) {
-		driveAndTurnDistanceTiles(distanceTiles, InertialSensor.rotation(), maxVelocityPct, 100.0, runTimeout);
+		driveAndTurnDistanceTiles(distanceTiles, mainOdometry.getLookFieldAngle_degrees(), maxVelocityPct, 100.0, runTimeout);
 	}
 
 	/// @brief Drive the robot for a specified tile distance and rotate it to a specified rotation in degrees.
@@ -169,9 +278,6 @@ namespace autonfunctions {
 	/// @param maxTurnVelocityPct Maximum rotational velocity of the drive. (can > 100)
 	/// @param runTimeout Maximum seconds the function will run for.
 	void driveAndTurnDistanceWithInches(double distanceInches, double targetRotation, double maxVelocityPct, double maxTurnVelocityPct, double runTimeout) {
-		// Set corrector
-		driftCorrector.setInitial();
-
 		// Variables
 		// double motorTargetDistanceRev = distanceInches * (1.0 / driveWheelCircumIn) * (driveWheelMotorGearRatio);
 		std::vector<double> initRevolutions = getMotorRevolutions();
@@ -179,20 +285,31 @@ namespace autonfunctions {
 		double lookEncoderInitialRevolution = LookEncoder.rotation(rev);
 		double lookRotationInitialRevolution = LookRotation.position(rev);
 		// double rightRotationInitialRevolution = RightRotation.position(rev);
-		Vector3 initalSimulatorPosition = robotSimulator.position;
+		double simulatorLookInitialRevolution = robotSimulator.driveModel.getLookWheelPosition_revolutions();
 
 		// Reset PID
+		driveAndTurn_driveTargetDistancePid.setDerivativeFilter(derivativeFilter_seconds);
+		driveAndTurn_rotateTargetAnglePid.setDerivativeFilter(derivativeFilter_seconds);
+		driveAndTurn_rotateTargetAnglePid.setIntegralLimit(rotateIntegralLimit_pct);
+		driveAndTurn_synchronizeVelocityPid.setSlewRate(synchronizeSlewRate_pctPerSecond);
 		driveAndTurn_driveTargetDistancePid.resetErrorToZero();
 		driveAndTurn_rotateTargetAnglePid.resetErrorToZero();
 		driveAndTurn_synchronizeVelocityPid.resetErrorToZero();
 
 		// Reset patience
 		driveError_inchesPatience.reset();
+		driveAndTurn_settlePredictor.reset();
+		bool isHandedOff = false;
 
 		// Reset timer
-		timer timeout;
+		vclock::Timer timeout;
+		vclock::Timer frameTimer;
 
 		while (!(driveAndTurn_driveTargetDistancePid.isSettled() && driveAndTurn_rotateTargetAnglePid.isSettled()) && timeout.value() < runTimeout) {
+			// Frame time
+			double deltaTime_seconds = frameTimer.value();
+			frameTimer.reset();
+
 			// Check exhausted
 			if (driveError_inchesPatience.isExhausted()) {
 				break;
@@ -205,8 +322,12 @@ namespace autonfunctions {
 			double distanceError;
 			double targetDistanceInches = distanceInches;
 			if (useSimulator) {
-				double travelDistance_tiles = (robotSimulator.position - initalSimulatorPosition).getMagnitude() * genutil::signum(targetDistanceInches);
-				distanceError = targetDistanceInches - travelDistance_tiles * field::tileLengthIn;
+				// Compute current travel distance from the simulated look wheel
+				double lookCurrentRevolution = robotSimulator.driveModel.getLookWheelPosition_revolutions() - simulatorLookInitialRevolution;
+				double currentTravelDistanceInches = lookCurrentRevolution * botinfo::trackingLookWheelCircumIn;
+
+				// Compute error
+				distanceError = targetDistanceInches - currentTravelDistanceInches;
 			} else if (useRotationSensorForPid) {
 				// Compute current travel distance in inches
 				double lookCurrentRevolution = LookRotation.position(rev) - lookRotationInitialRevolution;
@@ -234,7 +355,7 @@ namespace autonfunctions {
 			}
 
 			// Compute motor velocity pid-value from error
-			driveAndTurn_driveTargetDistancePid.computeFromError(distanceError);
+			driveAndTurn_driveTargetDistancePid.computeFromError(distanceError, deltaTime_seconds);
 			double velocityPct = fmin(maxVelocityPct, fmax(-maxVelocityPct, driveAndTurn_driveTargetDistancePid.getValue()));
 
 			// Update error patience
@@ -244,8 +365,7 @@ namespace autonfunctions {
 			/* Angular */
 
 			// Get current robot heading
-			double currentRotation_degrees = InertialSensor.rotation(degrees);
-			if (useSimulator) currentRotation_degrees = angle::swapFieldPolar_degrees(genutil::toDegrees(robotSimulator.angularPosition));
+			double currentRotation_degrees = mainOdometry.getLookFieldAngle_degrees();
 
 			// Compute heading error
 			double rotateError = targetRotation - currentRotation_degrees;
@@ -254,9 +374,17 @@ namespace autonfunctions {
 			}
 
 			// Compute heading pid-value from error
-			driveAndTurn_rotateTargetAnglePid.computeFromError(rotateError);
+			driveAndTurn_rotateTargetAnglePid.computeFromError(rotateError, deltaTime_seconds);
 			double rotateVelocityPct = fmin(maxTurnVelocityPct, fmax(-maxTurnVelocityPct, driveAndTurn_rotateTargetAnglePid.getValue()));
 
+			// Hand off once the distance is predicted to settle with the heading in range
+			driveAndTurn_settlePredictor.update(distanceError, deltaTime_seconds);
+			bool isHeadingInRange = std::fabs(rotateError) < autonvals::defaultTurnAngleErrorRange;
+			if (_usePredictiveSettle && driveAndTurn_settlePredictor.isPredictedSettled() && isHeadingInRange) {
+				isHandedOff = true;
+				break;
+			}
+
 
 			/* Combined */
 
@@ -273,7 +401,7 @@ namespace autonfunctions {
 
 				// Compute final delta motor velocities
 				double velocityDifferenceError = finalVelocityDifferenceInchesPerSecond - velocityDifferenceInchesPerSecond;
-				driveAndTurn_synchronizeVelocityPid.computeFromError(velocityDifferenceError);
+				driveAndTurn_synchronizeVelocityPid.computeFromError(velocityDifferenceError, deltaTime_seconds);
 				double finalDeltaVelocityPct = driveAndTurn_synchronizeVelocityPid.getValue();
 
 				// Update final motor velocities
@@ -285,14 +413,12 @@ namespace autonfunctions {
 			// printf("DisErr: %.3f, AngErr: %.3f\n", distanceError, rotateError);
 			botdrive::driveVoltage(genutil::pctToVolt(leftVelocityPct), genutil::pctToVolt(rightVelocityPct), 10);
 
-			task::sleep(20);
+			vclock::sleep(20);
 		}
 
 		// Stop
-		LeftRightMotors.stop(coast);
-
-		// Correct
-		driftCorrector.correct();
+		botdrive::stopDrive(coast);
+		driveAndTurn_settlePredictor.recordMove("drive", isHandedOff);
 	}
 
 
@@ -300,7 +426,13 @@ namespace autonfunctions {
 		_useRelativeRotation = useRelativeRotation;
 	}
 
+	void setUsePredictiveSettle(bool usePredictiveSettle) {
+		_usePredictiveSettle = usePredictiveSettle;
+	}
+
 	bool _useRelativeRotation = false;
+	// Off until the saved time is measured on the robot
+	bool _usePredictiveSettle = false;
 }
 
 
@@ -1,9 +1,10 @@
 #include "Autonomous/autonFunctions.h"
 
-#include "AutonUtilities/driftCorrection.h"
 #include "AutonUtilities/pidController.h"
 #include "AutonUtilities/linegular.h"
 #include "AutonUtilities/patienceController.h"
+#include "AutonUtilities/settlePredictor.h"
+#include "AutonUtilities/command.h"
 
 #include "Mechanics/botDrive.h"
 
@@ -11,160 +12,204 @@
 #include "Utilities/robotInfo.h"
 #include "Utilities/fieldInfo.h"
 #include "Utilities/generalUtility.h"
+#include "Utilities/sysidConstants.h"
 
 namespace {
 	using namespace autonfunctions::driveturn;
 
-	// Correctors
-	DriftCorrection driftCorrector(InertialSensor, 0, 0);
-
 	// Controllers
 	PatienceController driveError_tilesPatience(4, 0.01, false);
 
-	PIDController driveTurn_driveTargetDistance_voltPid(90, 0, 6, autonvals::defaultMoveTilesErrorRange, 3);
-	PIDController driveTurn_rotateTargetAngle_voltPid(2.0, 0, 0, autonvals::defaultTurnAngleErrorRange, 3);
+	PIDControllerCore<pidfeature::DerivativeFilter> driveTurn_driveTargetDistance_voltPid(90, 0, 6, autonvals::defaultMoveTilesErrorRange, 3);
+	PIDControllerCore<pidfeature::None> driveTurn_rotateTargetAngle_voltPid(2.0, 0, 0, autonvals::defaultTurnAngleErrorRange, 3);
+
+	PIDControllerCore<pidfeature::None> driveTurn_driveTargetDistance_velocityPid(70, 0, 0, autonvals::defaultMoveTilesErrorRange);
+	PIDControllerCore<pidfeature::DerivativeFilter> driveTurn_rotateTargetAngle_velocityPid(0.3, 0.0, 0.03, autonvals::defaultTurnAngleErrorRange);
+
+	const double derivativeFilter_seconds = 0.04;
 
-	PIDController driveTurn_driveTargetDistance_velocityPid(70, 0, 0, autonvals::defaultMoveTilesErrorRange);
-	PIDController driveTurn_rotateTargetAngle_velocityPid(0.3, 0.0, 0.03, autonvals::defaultTurnAngleErrorRange);
+	// Settle prediction, braking at half the drive's acceleration, confirming as long as the PIDs' 3 settle frames
+	SettlePredictor driveTurn_settlePredictor(
+		autonvals::defaultMoveTilesErrorRange,
+		0.5 * fmin(sysidconstants::driveLeftMaxAcceleration_tilesPerSecondSquared, sysidconstants::driveRightMaxAcceleration_tilesPerSecondSquared),
+		0.4, 3 * 0.020
+	);
 
 	bool useVolt = true;
 
 	// Constraints
 	const double turnTo_distanceThreshold = 0.3;
 
-	// Function
-	void runDriveTurnToFace();
-}
+	// Linear path chaining, off until measured against stopping at each waypoint
+	bool useLinearPathChaining = false;
+	double chainExitVelocity_pct = 50;
+	double chainExitRadius_tiles = 0.2;
 
-namespace autonfunctions {
-	namespace driveturn {
-		void async_driveTurnToFace_tiles(double x_tiles, double y_tiles, bool isReverse, double maxVelocity_pct, double maxTurnVelocity_pct, double runTimeout) {
-			_linearPathDistanceError = 1e9;
-			_targetX = x_tiles;
-			_targetY = y_tiles;
-			_isReverseHeading = isReverse;
-			_maxVelocity_pct = maxVelocity_pct;
-			_maxTurnVelocity_pct = maxTurnVelocity_pct;
-			_runTimeout = runTimeout;
-			_isDriveTurnSettled = false;
-			task driveTurn([] () -> int {
-				runDriveTurnToFace();
-				return 1;
-			});
-		}
+	// Corners sharper than this stop and turn in place
+	const double chainMaxCornerAngle_degrees = 60;
 
-		void driveTurnToFace_tiles(double x_tiles, double y_tiles, bool isReverse, double maxVelocity_pct, double maxTurnVelocity_pct, double runTimeout) {
-			async_driveTurnToFace_tiles(x_tiles, y_tiles, isReverse, maxVelocity_pct, maxTurnVelocity_pct, runTimeout);
-			waitUntil(_isDriveTurnSettled);
-		}
+	double getCornerAngle_degrees(double fromX, double fromY, double cornerX, double cornerY, double toX, double toY);
 
-		double _linearPathDistanceError;
-		double _targetX, _targetY;
-		bool _isReverseHeading;
-		double _maxVelocity_pct, _maxTurnVelocity_pct;
-		double _runTimeout;
+	// Drive-turn reporting to _linearPathDistanceError and _isDriveTurnSettled, the newest one started
+	// Tokens are only handed out by the executor, which starts the drive-turns
+	int statusOwnerToken = 0;
+	int lastStatusToken = 0;
 
-		bool _isDriveTurnSettled;
-	}
+	bool ownsStatus(DriveTurnToFaceState &state);
+	void releaseStatus();
 
-	void turnToFace_tiles(double x_tiles, double y_tiles, bool isReverse, double maxTurnVelocity_pct) {
-		Linegular lg = mainOdometry.getLookLinegular();
-		double angle_degrees = angle::swapFieldPolar_degrees(genutil::toDegrees(atan2(y_tiles - lg.getY(), x_tiles - lg.getX())));
-		if (isReverse) angle_degrees += 180;
-		turnToAngleVelocity(angle_degrees, maxTurnVelocity_pct);
-	}
+	/// @brief Command wrapping one drive-turn, so it is stepped by the executor.
+	class DriveTurnToFaceCommand : public Command {
+	public:
+		DriveTurnToFaceCommand(DriveTurnToFaceState &state) {
+			this->state = state;
+			requirements = commandsubsystem::Drive;
+			isDone = false;
+		}
 
-	void runLinearPIDPath(std::vector<std::vector<double>> waypoints, double maxVelocity, bool isReverse) {
-		Linegular lg(0, 0, 0);
-		for (std::vector<double> point : waypoints) {
-			// Rotation
-			turnToFace_tiles(point[0], point[1], isReverse);
+		void initialize() override {
+			startDriveTurnToFace(state);
+			frameTimer.reset();
+			isDone = false;
+		}
 
-			// Linear
-			lg = mainOdometry.getLookLinegular();
-			// double drive_distance = genutil::euclideanDistance({lg.getX(), lg.getY()}, {point[0], point[1]}) * (isReverse ? -1 : 1);
-			// printf("ST: X: %.3f, Y: %.3f, dist: %.3f\n", lg.getX(), lg.getY(), drive_distance);
-			// driveAndTurnDistanceTiles(drive_distance, angle_degrees, maxVelocity);
-			driveturn::driveTurnToFace_tiles(point[0], point[1], isReverse, maxVelocity);
+		void execute() override {
+			double deltaTime_seconds = frameTimer.value();
+			frameTimer.reset();
+			isDone = stepDriveTurnToFace(state, deltaTime_seconds);
+		}
 
-			// Info
-			lg = mainOdometry.getLookLinegular();
-			printf("ED: X: %.3f, Y: %.3f\n", lg.getX(), lg.getY());
+		bool isFinished() override {
+			return isDone;
 		}
-	}
-}
 
-namespace {
-	void runDriveTurnToFace() {
-		// Get global variables
-		double x_tiles = _targetX;
-		double y_tiles = _targetY;
-		bool isReverse = _isReverseHeading;
-		double maxVelocity_pct = _maxVelocity_pct;
-		double maxTurnVelocity_pct = _maxTurnVelocity_pct;
-		double runTimeout = _runTimeout;
+		void end(bool isInterrupted) override {
+			finishDriveTurnToFace(state, isInterrupted);
+		}
 
-		// Set corrector
-		driftCorrector.setInitial();
+	private:
+		DriveTurnToFaceState state;
+		vclock::Timer frameTimer;
+		bool isDone;
+	};
+}
 
-		// Initial state
-		Linegular startLg = mainOdometry.getLookLinegular();
+namespace autonfunctions {
+	namespace driveturn {
+		void async_driveTurnToFace_tiles(double x_tiles, double y_tiles, bool isReverse, double maxVelocity_pct, double maxTurnVelocity_pct, double runTimeout, double exitVelocity_pct, double exitRadius_tiles) {
+			releaseStatus();
+			commands::schedule(createDriveTurnToFaceCommand(x_tiles, y_tiles, isReverse, maxVelocity_pct, maxTurnVelocity_pct, runTimeout, exitVelocity_pct, exitRadius_tiles));
+		}
 
-		// Target state
-		const double targetDistance = genutil::euclideanDistance({startLg.getX(), startLg.getY()}, {x_tiles, y_tiles});
-		double targetRotation_degrees = genutil::toDegrees(atan2(y_tiles - startLg.getY(), x_tiles - startLg.getX()));
-		_linearPathDistanceError = targetDistance;
+		void driveTurnToFace_tiles(double x_tiles, double y_tiles, bool isReverse, double maxVelocity_pct, double maxTurnVelocity_pct, double runTimeout, double exitVelocity_pct, double exitRadius_tiles) {
+			// Wait on this drive-turn's command, not the shared status
+			releaseStatus();
+			commands::runAndWait(createDriveTurnToFaceCommand(x_tiles, y_tiles, isReverse, maxVelocity_pct, maxTurnVelocity_pct, runTimeout, exitVelocity_pct, exitRadius_tiles));
+		}
 
-		// Config
-		const double velocityFactor = (isReverse ? -1 : 1);
-		const double rotationOffset_degrees = (isReverse ? 180 : 0);
+		Command *createDriveTurnToFaceCommand(double x_tiles, double y_tiles, bool isReverse, double maxVelocity_pct, double maxTurnVelocity_pct, double runTimeout, double exitVelocity_pct, double exitRadius_tiles) {
+			DriveTurnToFaceState state;
+			state.targetX_tiles = x_tiles;
+			state.targetY_tiles = y_tiles;
+			state.isReverse = isReverse;
+			state.maxVelocity_pct = maxVelocity_pct;
+			state.maxTurnVelocity_pct = maxTurnVelocity_pct;
+			state.runTimeout_seconds = runTimeout;
+			state.exitVelocity_pct = exitVelocity_pct;
+			state.exitRadius_tiles = exitRadius_tiles;
+			state.statusToken = -1;
+			return new DriveTurnToFaceCommand(state);
+		}
 
-		// Reset PID
-		driveTurn_driveTargetDistance_voltPid.resetErrorToZero();
-		driveTurn_rotateTargetAngle_voltPid.resetErrorToZero();
+		/// @brief Resets the controllers and computes the target from the current pose.
+		void startDriveTurnToFace(DriveTurnToFaceState &state) {
+			// Initial state
+			Linegular startLg = mainOdometry.getLookLinegular();
+			state.startX_tiles = startLg.getX();
+			state.startY_tiles = startLg.getY();
+
+			// Target state
+			state.targetDistance_tiles = genutil::euclideanDistance({state.startX_tiles, state.startY_tiles}, {state.targetX_tiles, state.targetY_tiles});
+			state.targetRotation_degrees = genutil::toDegrees(atan2(state.targetY_tiles - state.startY_tiles, state.targetX_tiles - state.startX_tiles));
+			state.elapsedTime_seconds = 0;
+			state.isHandedOff = false;
+
+			// Take over the shared status
+			state.statusToken = ++lastStatusToken;
+			statusOwnerToken = state.statusToken;
+			_linearPathDistanceError = state.targetDistance_tiles;
+			_isDriveTurnSettled = false;
 
-		// Reset patience
-		driveError_tilesPatience.reset();
+			// Reset PID
+			driveTurn_driveTargetDistance_voltPid.setDerivativeFilter(derivativeFilter_seconds);
+			driveTurn_rotateTargetAngle_velocityPid.setDerivativeFilter(derivativeFilter_seconds);
+			driveTurn_driveTargetDistance_voltPid.resetErrorToZero();
+			driveTurn_rotateTargetAngle_voltPid.resetErrorToZero();
+			driveTurn_driveTargetDistance_velocityPid.resetErrorToZero();
+			driveTurn_rotateTargetAngle_velocityPid.resetErrorToZero();
+
+			// Reset patience
+			driveError_tilesPatience.reset();
+			driveTurn_settlePredictor.reset();
+		}
 
-		// Reset timer
-		timer timeout;
+		/// @brief Runs one control frame. Returns whether the drive-turn is done.
+		bool stepDriveTurnToFace(DriveTurnToFaceState &state, double deltaTime_seconds) {
+			// Check timeout
+			state.elapsedTime_seconds += deltaTime_seconds;
+			if (state.elapsedTime_seconds >= state.runTimeout_seconds) {
+				return true;
+			}
 
-		while (timeout.value() < runTimeout) {
 			// Check settled
 			if (driveTurn_driveTargetDistance_voltPid.isSettled() && driveTurn_rotateTargetAngle_voltPid.isSettled()) {
 				printf("Settled\n");
-				break;
+				return true;
 			}
 
 			// Check exhausted
 			if (driveError_tilesPatience.isExhausted()) {
-				break;
+				return true;
 			}
 
+			// Config
+			const double velocityFactor = (state.isReverse ? -1 : 1);
+			const double rotationOffset_degrees = (state.isReverse ? 180 : 0);
+			const bool isChained = state.exitRadius_tiles > 0;
+
 			// Get current state
 			Linegular currentLg = mainOdometry.getLookLinegular();
 			double currentX = currentLg.getX();
 			double currentY = currentLg.getY();
 
+			// Pass a chained target once within its radius
+			if (isChained && hypot(state.targetX_tiles - currentX, state.targetY_tiles - currentY) < state.exitRadius_tiles) {
+				return true;
+			}
+
 
 			/* Linear */
 
 			// Compute linear distance error
-			double travelDistance = genutil::euclideanDistance({startLg.getX(), startLg.getY()}, {currentX, currentY});
-			double distanceError = targetDistance - travelDistance;
-			_linearPathDistanceError = distanceError;
+			double travelDistance = genutil::euclideanDistance({state.startX_tiles, state.startY_tiles}, {currentX, currentY});
+			double distanceError = state.targetDistance_tiles - travelDistance;
+			if (ownsStatus(state)) {
+				_linearPathDistanceError = distanceError;
+			}
 
 			// Compute motor velocity pid-value from error
-			driveTurn_driveTargetDistance_voltPid.computeFromError(distanceError);
-			driveTurn_driveTargetDistance_velocityPid.computeFromError(distanceError);
+			driveTurn_driveTargetDistance_voltPid.computeFromError(distanceError, deltaTime_seconds);
+			driveTurn_driveTargetDistance_velocityPid.computeFromError(distanceError, deltaTime_seconds);
 			double velocity_pct;
 			if (useVolt) {
 				velocity_pct = driveTurn_driveTargetDistance_voltPid.getValue();
 			} else {
 				velocity_pct = driveTurn_driveTargetDistance_velocityPid.getValue();
 			}
-			velocity_pct = genutil::clamp(velocity_pct, -maxVelocity_pct, maxVelocity_pct);
-			velocity_pct *= velocityFactor;
+			if (isChained) {
+				velocity_pct = std::max(velocity_pct, state.exitVelocity_pct);
+			}
+			velocity_pct = genutil::clamp(velocity_pct, -state.maxVelocity_pct, state.maxVelocity_pct);
 
 			// Update error patience
 			driveError_tilesPatience.computePatience(std::fabs(distanceError));
@@ -174,30 +219,44 @@ namespace {
 
 			// Compute target polar heading
 			if (distanceError > turnTo_distanceThreshold) {
-				targetRotation_degrees = genutil::toDegrees(std::atan2(y_tiles - currentY, x_tiles - currentX)) + rotationOffset_degrees;
+				state.targetRotation_degrees = genutil::toDegrees(std::atan2(state.targetY_tiles - currentY, state.targetX_tiles - currentX)) + rotationOffset_degrees;
 			}
 
 			// Compute polar heading error
-			double rotateError = targetRotation_degrees - currentLg.getThetaPolarAngle_degrees();
+			double rotateError = state.targetRotation_degrees - currentLg.getThetaPolarAngle_degrees();
 			if (autonfunctions::_useRelativeRotation) {
 				rotateError = genutil::modRange(rotateError, 360, -180);
 			}
 
 			// Compute heading pid-value from error
-			driveTurn_rotateTargetAngle_voltPid.computeFromError(rotateError);
-			driveTurn_rotateTargetAngle_velocityPid.computeFromError(rotateError);
+			driveTurn_rotateTargetAngle_voltPid.computeFromError(rotateError, deltaTime_seconds);
+			driveTurn_rotateTargetAngle_velocityPid.computeFromError(rotateError, deltaTime_seconds);
 			double rotateVelocity_pct;
 			if (useVolt) {
 				rotateVelocity_pct = driveTurn_rotateTargetAngle_voltPid.getValue();
 			} else {
 				rotateVelocity_pct = driveTurn_rotateTargetAngle_velocityPid.getValue();
 			}
-			rotateVelocity_pct = genutil::clamp(rotateVelocity_pct, -maxTurnVelocity_pct, maxTurnVelocity_pct);
+			rotateVelocity_pct = genutil::clamp(rotateVelocity_pct, -state.maxTurnVelocity_pct, state.maxTurnVelocity_pct);
+
+			// Hand off once the distance is predicted to settle with the heading in range
+			driveTurn_settlePredictor.update(distanceError, deltaTime_seconds);
+			bool isHeadingInRange = std::fabs(rotateError) < autonvals::defaultTurnAngleErrorRange;
+			if (!isChained && autonfunctions::_usePredictiveSettle && driveTurn_settlePredictor.isPredictedSettled() && isHeadingInRange) {
+				state.isHandedOff = true;
+				return true;
+			}
+
+			// Blend a chained leg's turn into the drive, slowing while the heading is off
+			if (isChained) {
+				velocity_pct *= std::max(0.0, cos(genutil::toRadians(rotateError)));
+			}
+			velocity_pct *= velocityFactor;
 
 
 			/* Debug print */
-			// printf("DIS TR: %.3f, TGT: %.3f, DE: %.3f, VLin: %.3f, VRot: %.3f\n", travelDistance, targetDistance, distanceError, velocity_pct, rotateVelocity_pct);
-			// printf("ANG CUR: %.3f, TGT: %.3f, DE: %.3f\n", currentLg.getThetaPolarAngle_degrees(), targetRotation_degrees, rotateError);
+			// printf("DIS TR: %.3f, TGT: %.3f, DE: %.3f, VLin: %.3f, VRot: %.3f\n", travelDistance, state.targetDistance_tiles, distanceError, velocity_pct, rotateVelocity_pct);
+			// printf("ANG CUR: %.3f, TGT: %.3f, DE: %.3f\n", currentLg.getThetaPolarAngle_degrees(), state.targetRotation_degrees, rotateError);
 
 
 			/* Combined */
@@ -213,18 +272,107 @@ namespace {
 				botdrive::driveVelocity(leftVelocity_pct, rightVelocity_pct);
 			}
 
-			// Delay
-			task::sleep(20);
+			return false;
+		}
+
+		/// @brief Stops the drive. An interrupted drive-turn leaves the drive to the command replacing it.
+		void finishDriveTurnToFace(DriveTurnToFaceState &state, bool isInterrupted) {
+			// Stop, a chained drive-turn keeps driving into the next one
+			bool isChained = state.exitRadius_tiles > 0;
+			if (!isInterrupted && !isChained) {
+				botdrive::stopDrive(coast);
+			}
+
+			// Record settle statistics
+			if (!isInterrupted && !isChained) {
+				driveTurn_settlePredictor.recordMove("driveTurn", state.isHandedOff);
+			}
+
+			// Settled, unless a newer drive-turn reports instead
+			if (ownsStatus(state)) {
+				_linearPathDistanceError = 0;
+				_isDriveTurnSettled = true;
+			}
 		}
 
-		// Stop
-		LeftRightMotors.stop(coast);
+		double _linearPathDistanceError;
+		bool _isDriveTurnSettled;
+	}
+
+	void turnToFace_tiles(double x_tiles, double y_tiles, bool isReverse, double maxTurnVelocity_pct) {
+		Linegular lg = mainOdometry.getLookLinegular();
+		double angle_degrees = angle::swapFieldPolar_degrees(genutil::toDegrees(atan2(y_tiles - lg.getY(), x_tiles - lg.getX())));
+		if (isReverse) angle_degrees += 180;
+		turnToAngleVelocity(angle_degrees, maxTurnVelocity_pct);
+	}
+
+	void runLinearPIDPath(std::vector<std::vector<double>> waypoints, double maxVelocity, bool isReverse) {
+		Linegular lg = mainOdometry.getLookLinegular();
+		double previousX = lg.getX(), previousY = lg.getY();
+		bool isMoving = false;
+		vclock::Timer pathTimer;
 
-		// Correct
-		driftCorrector.correct();
+		int waypointCount = (int) waypoints.size();
+		for (int i = 0; i < waypointCount; i++) {
+			std::vector<double> &point = waypoints[i];
+
+			// Rotation, blended into the drive when arriving from a chained leg
+			if (!isMoving) {
+				turnToFace_tiles(point[0], point[1], isReverse);
+			}
+
+			// Chain into the next leg through a shallow corner, slower for sharper corners
+			double exitVelocity_pct = 0, exitRadius_tiles = 0;
+			if (useLinearPathChaining && i + 1 < waypointCount) {
+				std::vector<double> &nextPoint = waypoints[i + 1];
+				double cornerAngle_degrees = getCornerAngle_degrees(previousX, previousY, point[0], point[1], nextPoint[0], nextPoint[1]);
+				if (cornerAngle_degrees < chainMaxCornerAngle_degrees) {
+					exitVelocity_pct = std::min(maxVelocity, chainExitVelocity_pct * cos(genutil::toRadians(cornerAngle_degrees)));
+					exitRadius_tiles = chainExitRadius_tiles;
+				}
+			}
+
+			// Linear
+			// double drive_distance = genutil::euclideanDistance({lg.getX(), lg.getY()}, {point[0], point[1]}) * (isReverse ? -1 : 1);
+			// printf("ST: X: %.3f, Y: %.3f, dist: %.3f\n", lg.getX(), lg.getY(), drive_distance);
+			// driveAndTurnDistanceTiles(drive_distance, angle_degrees, maxVelocity);
+			driveturn::driveTurnToFace_tiles(point[0], point[1], isReverse, maxVelocity, 100, 3, exitVelocity_pct, exitRadius_tiles);
+			isMoving = exitRadius_tiles > 0;
+			previousX = point[0];
+			previousY = point[1];
+
+			// Info
+			lg = mainOdometry.getLookLinegular();
+			printf("ED: X: %.3f, Y: %.3f, T: %.3f\n", lg.getX(), lg.getY(), pathTimer.value());
+		}
+	}
+
+	void setLinearPathChaining(bool useChaining, double exitVelocityPct, double exitRadius_tiles) {
+		useLinearPathChaining = useChaining;
+		chainExitVelocity_pct = exitVelocityPct;
+		chainExitRadius_tiles = exitRadius_tiles;
+	}
+}
+
+
+namespace {
+	/// @brief Returns the change of direction at a corner, from 0 (straight on) to 180 (doubling back).
+	double getCornerAngle_degrees(double fromX, double fromY, double cornerX, double cornerY, double toX, double toY) {
+		double inAngle_radians = atan2(cornerY - fromY, cornerX - fromX);
+		double outAngle_radians = atan2(toY - cornerY, toX - cornerX);
+		double turn_degrees = genutil::modRange(genutil::toDegrees(outAngle_radians - inAngle_radians), 360, -180);
+		return std::fabs(turn_degrees);
+	}
+
+	bool ownsStatus(DriveTurnToFaceState &state) {
+		return state.statusToken == statusOwnerToken;
+	}
 
-		// Settled
-		_linearPathDistanceError = 0;
-		_isDriveTurnSettled = true;
+	/// @brief Resets the shared status for a drive-turn about to be scheduled.
+	/// The drive-turn it replaces stops reporting, before the new one has started.
+	void releaseStatus() {
+		statusOwnerToken = 0;
+		_linearPathDistanceError = 1e9;
+		_isDriveTurnSettled = false;
 	}
 }
@@ -0,0 +1,220 @@
+#include "Autonomous/autonFunctions.h"
+
+#include "AutonUtilities/linegular.h"
+
+#include "Utilities/angleUtility.h"
+#include "Utilities/fieldInfo.h"
+#include "Utilities/generalUtility.h"
+
+#include "main.h"
+
+namespace {
+	// Registered sensors
+	const int maxWallResetSensors = 4;
+
+	struct WallResetSensor {
+		distance *sensor;
+		double rightOffset_inches, lookOffset_inches;
+		double mountAngle_degrees;
+	};
+
+	WallResetSensor wallResetSensors[maxWallResetSensors];
+	int wallResetSensorCount = 0;
+
+	// Field walls, in tiles
+	const double fieldMinCoordinate_tiles = 0;
+	const double fieldMaxCoordinate_tiles = 6;
+
+	// Validation
+	const double minReading_inches = 1;
+	const double maxReading_inches = 70;
+	const double maxBeamToWallNormal_degrees = 20;
+	const double minHitSeparation_inches = 2;
+	const double maxHeadingCorrection_degrees = 10;
+
+	// A distance reading against a field wall
+	struct WallHit {
+		int wallIndex; // 0: north, 1: east, 2: south, 3: west
+		double hitRight_inches, hitLook_inches; // robot frame
+		double sensorRight_inches, sensorLook_inches;
+		double beamFieldAngle_degrees;
+		double distance_inches;
+	};
+
+	bool getWallHit(WallResetSensor &resetSensor, double lookFieldAngle_degrees, WallHit &hit);
+	double getExpectedDistance_inches(double x_tiles, double y_tiles, double lookFieldAngle_degrees, WallHit &hit);
+	double getWallFieldAngle_degrees(int wallIndex);
+}
+
+namespace autonfunctions {
+	/// @brief Register a distance sensor for wall resets.
+	/// @param sensor The distance sensor.
+	/// @param rightOffset_inches The sensor's offset to the right of the tracking center.
+	/// @param lookOffset_inches The sensor's offset to the front of the tracking center.
+	/// @param mountAngle_degrees The sensor's facing direction relative to the robot's front, clockwise being positive.
+	void addWallResetSensor(distance &sensor, double rightOffset_inches, double lookOffset_inches, double mountAngle_degrees) {
+		if (wallResetSensorCount >= maxWallResetSensors) {
+			return;
+		}
+		WallResetSensor &resetSensor = wallResetSensors[wallResetSensorCount];
+		resetSensor.sensor = &sensor;
+		resetSensor.rightOffset_inches = rightOffset_inches;
+		resetSensor.lookOffset_inches = lookOffset_inches;
+		resetSensor.mountAngle_degrees = mountAngle_degrees;
+		wallResetSensorCount++;
+	}
+
+	/// @brief Correct the robot's pose from distance sensors that see a field wall. Cheap enough to call while driving.
+	/// @param maxDistanceError_inches Largest difference from the expected reading for a sensor to be trusted.
+	/// @param resetHeading Whether two sensors seeing the same wall may also correct the heading.
+	/// @return Whether any part of the pose was corrected.
+	bool resetPoseFromWalls(double maxDistanceError_inches, bool resetHeading) {
+		// Current pose
+		Linegular robotLg = mainOdometry.getLookLinegular();
+		double x_tiles = robotLg.getX();
+		double y_tiles = robotLg.getY();
+		double lookFieldAngle_degrees = angle::swapFieldPolar_degrees(robotLg.getThetaPolarAngle_degrees());
+
+		// Collect valid wall hits
+		WallHit hits[maxWallResetSensors];
+		int hitCount = 0;
+		for (int i = 0; i < wallResetSensorCount; i++) {
+			WallHit &hit = hits[hitCount];
+			if (!getWallHit(wallResetSensors[i], lookFieldAngle_degrees, hit)) {
+				continue;
+			}
+
+			// Check reading against the expected distance
+			double expectedDistance_inches = getExpectedDistance_inches(x_tiles, y_tiles, lookFieldAngle_degrees, hit);
+			if (!genutil::isWithin(hit.distance_inches, expectedDistance_inches, maxDistanceError_inches)) {
+				continue;
+			}
+			hitCount++;
+		}
+		if (hitCount == 0) {
+			return false;
+		}
+
+		// Heading from two hits on the same wall
+		double correctedAngle_degrees = lookFieldAngle_degrees;
+		if (resetHeading) {
+			for (int i = 0; i < hitCount; i++) {
+				for (int j = i + 1; j < hitCount; j++) {
+					if (hits[i].wallIndex != hits[j].wallIndex) {
+						continue;
+					}
+
+					// Wall direction in the robot frame
+					double wallRight_inches = hits[j].hitRight_inches - hits[i].hitRight_inches;
+					double wallLook_inches = hits[j].hitLook_inches - hits[i].hitLook_inches;
+					if (sqrt(wallRight_inches * wallRight_inches + wallLook_inches * wallLook_inches) < minHitSeparation_inches) {
+						continue;
+					}
+					double localWallAngle_degrees = genutil::toDegrees(atan2(wallRight_inches, wallLook_inches));
+
+					// Match with the known wall direction, modulo 180
+					double wallFieldAngle_degrees = getWallFieldAngle_degrees(hits[i].wallIndex);
+					double headingError_degrees = genutil::modRange(wallFieldAngle_degrees - localWallAngle_degrees - lookFieldAngle_degrees, 180, -90);
+					if (std::fabs(headingError_degrees) <= maxHeadingCorrection_degrees) {
+						correctedAngle_degrees = lookFieldAngle_degrees + headingError_degrees;
+					}
+					break;
+				}
+			}
+		}
+
+		// Position from each hit, using the corrected heading
+		double totalX_tiles = 0, totalY_tiles = 0;
+		int xCount = 0, yCount = 0;
+		double correctedAngle_radians = genutil::toRadians(correctedAngle_degrees);
+		for (int i = 0; i < hitCount; i++) {
+			WallHit &hit = hits[i];
+
+			// Wall contact point from the tracking center, in field inches
+			double beamAngle_radians = correctedAngle_radians + genutil::toRadians(hit.beamFieldAngle_degrees - lookFieldAngle_degrees);
+			double offsetX_inches = hit.sensorRight_inches * cos(correctedAngle_radians) + hit.sensorLook_inches * sin(correctedAngle_radians);
+			double offsetY_inches = -hit.sensorRight_inches * sin(correctedAngle_radians) + hit.sensorLook_inches * cos(correctedAngle_radians);
+			double reachX_tiles = (offsetX_inches + hit.distance_inches * sin(beamAngle_radians)) / field::tileLengthIn;
+			double reachY_tiles = (offsetY_inches + hit.distance_inches * cos(beamAngle_radians)) / field::tileLengthIn;
+
+			// Wall coordinate minus reach
+			if (hit.wallIndex == 0) {
+				totalY_tiles += fieldMaxCoordinate_tiles - reachY_tiles;
+				yCount++;
+			} else if (hit.wallIndex == 1) {
+				totalX_tiles += fieldMaxCoordinate_tiles - reachX_tiles;
+				xCount++;
+			} else if (hit.wallIndex == 2) {
+				totalY_tiles += fieldMinCoordinate_tiles - reachY_tiles;
+				yCount++;
+			} else {
+				totalX_tiles += fieldMinCoordinate_tiles - reachX_tiles;
+				xCount++;
+			}
+		}
+
+		// Apply in one update
+		double correctedX_tiles = (xCount > 0) ? (totalX_tiles / xCount) : x_tiles;
+		double correctedY_tiles = (yCount > 0) ? (totalY_tiles / yCount) : y_tiles;
+		mainOdometry.setPose(correctedX_tiles, correctedY_tiles, correctedAngle_degrees);
+		return true;
+	}
+}
+
+namespace {
+	/// @brief Read a sensor and find the wall its beam points at. Returns false if the reading can't be trusted.
+	bool getWallHit(WallResetSensor &resetSensor, double lookFieldAngle_degrees, WallHit &hit) {
+		// Check sensor
+		distance *sensor = resetSensor.sensor;
+		if (!sensor->installed() || !sensor->isObjectDetected()) {
+			return false;
+		}
+		double distance_inches = sensor->objectDistance(inches);
+		if (distance_inches < minReading_inches || distance_inches > maxReading_inches) {
+			return false;
+		}
+
+		// Find the wall the beam is closest to facing
+		double beamFieldAngle_degrees = lookFieldAngle_degrees + resetSensor.mountAngle_degrees;
+		double wrappedAngle_degrees = genutil::modRange(beamFieldAngle_degrees, 360, -45);
+		int wallIndex = (int) ((wrappedAngle_degrees + 45) / 90) % 4;
+		double beamToWallNormal_degrees = wrappedAngle_degrees - wallIndex * 90;
+		if (std::fabs(beamToWallNormal_degrees) > maxBeamToWallNormal_degrees) {
+			return false;
+		}
+
+		// Store hit in the robot frame
+		double mountAngle_radians = genutil::toRadians(resetSensor.mountAngle_degrees);
+		hit.wallIndex = wallIndex;
+		hit.sensorRight_inches = resetSensor.rightOffset_inches;
+		hit.sensorLook_inches = resetSensor.lookOffset_inches;
+		hit.hitRight_inches = resetSensor.rightOffset_inches + distance_inches * sin(mountAngle_radians);
+		hit.hitLook_inches = resetSensor.lookOffset_inches + distance_inches * cos(mountAngle_radians);
+		hit.beamFieldAngle_degrees = beamFieldAngle_degrees;
+		hit.distance_inches = distance_inches;
+		return true;
+	}
+
+	/// @brief Returns the reading expected from the current pose estimate.
+	double getExpectedDistance_inches(double x_tiles, double y_tiles, double lookFieldAngle_degrees, WallHit &hit) {
+		// Sensor position in field inches
+		double lookAngle_radians = genutil::toRadians(lookFieldAngle_degrees);
+		double sensorX_inches = x_tiles * field::tileLengthIn + hit.sensorRight_inches * cos(lookAngle_radians) + hit.sensorLook_inches * sin(lookAngle_radians);
+		double sensorY_inches = y_tiles * field::tileLengthIn - hit.sensorRight_inches * sin(lookAngle_radians) + hit.sensorLook_inches * cos(lookAngle_radians);
+
+		// Distance along the beam to the wall
+		double beamAngle_radians = genutil::toRadians(hit.beamFieldAngle_degrees);
+		double wallMax_inches = fieldMaxCoordinate_tiles * field::tileLengthIn;
+		double wallMin_inches = fieldMinCoordinate_tiles * field::tileLengthIn;
+		if (hit.wallIndex == 0) return (wallMax_inches - sensorY_inches) / cos(beamAngle_radians);
+		if (hit.wallIndex == 1) return (wallMax_inches - sensorX_inches) / sin(beamAngle_radians);
+		if (hit.wallIndex == 2) return (wallMin_inches - sensorY_inches) / cos(beamAngle_radians);
+		return (wallMin_inches - sensorX_inches) / sin(beamAngle_radians);
+	}
+
+	/// @brief Returns the field angle along which a wall runs.
+	double getWallFieldAngle_degrees(int wallIndex) {
+		// North and south walls run east-west, east and west walls run north-south
+		return (wallIndex % 2 == 0) ? 90 : 0;
+	}
+}
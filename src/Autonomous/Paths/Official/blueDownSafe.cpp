@@ -27,7 +27,7 @@ void autonpaths::runAutonBlueDownSafe() {
 	setDifferentialUseRelativeRotation(true);
 
 	// Wait for arm reset
-	// waitUntil(isArmResetted());
+	// clockWaitUntil(isArmResetted());
 
 
 	/* Auton */
@@ -62,13 +62,13 @@ namespace {
 		async_driveTurnToFace_tiles(3.78, 0.93);
 
 		// Deploy
-		waitUntil(_linearPathDistanceError < 0.15);
+		clockWaitUntil(_linearPathDistanceError < 0.15);
 		setSwing2State(1);
 		turnToAngle(-111.7);
-		wait(autonvals::rushGoalDeployDelay_msec, msec);
+		vclock::sleep(autonvals::rushGoalDeployDelay_msec);
 
 		// Go back & un-deploy
-		waitUntil(_isDriveTurnSettled);
+		clockWaitUntil(_isDriveTurnSettled);
 		setSwing2State(0, 0.8);
 		driveTurnToFace_tiles(4.76, 1.41, true, 60);
 		setSwing2State(0);
@@ -27,7 +27,7 @@ void autonpaths::runAutonBlueUp() {
 	setDifferentialUseRelativeRotation(true);
 
 	// Wait for arm reset
-	// waitUntil(isArmResetted());
+	// clockWaitUntil(isArmResetted());
 	setArmResetDefaultStage(2);
 
 
@@ -72,7 +72,7 @@ namespace {
 		// Score on alliance wall stake
 		runFollowLinearYield();
 		setIntakeStoreRing(0, 0.5);
-		wait(50, msec);
+		vclock::sleep(50);
 		runFollowLinearYield();
 		driveDistanceTiles(-0.4);
 
@@ -28,7 +28,7 @@ void autonpaths::runRedSoloAWP() {
 	setDifferentialUseRelativeRotation(true);
 
 	// Wait for arm reset
-	// waitUntil(isArmResetted());
+	// clockWaitUntil(isArmResetted());
 	setArmResetDefaultStage(2);
 
 
@@ -78,7 +78,7 @@ namespace {
 		// Score on alliance wall stake
 		runFollowLinearYield();
 		setIntakeStoreRing(0, 0.5);
-		wait(50, msec);
+		vclock::sleep(50);
 		runFollowLinearYield();
 		setIntakeState(-1, 0.1);
 		driveDistanceTiles(-0.5);
@@ -32,7 +32,7 @@ void autonpaths::runAutonSkills() {
 	setDifferentialUseRelativeRotation(true);
 
 	// Wait for arm reset
-	waitUntil(isArmResetted());
+	clockWaitUntil(isArmResetted());
 
 
 	/* Skills */
@@ -135,7 +135,7 @@ namespace {
 	void firstCorner() {
 		// Wall stake
 		setArmStage(2);
-		wait(600, msec);
+		vclock::sleep(600);
 		runFollowLinearYield();
 		driveDistanceTiles(-0.5);
 
@@ -230,7 +230,7 @@ namespace {
 		setIntakeState(1);
 		setArmStage(2);
 		turnToAngle(90);
-		wait(200, msec);
+		vclock::sleep(200);
 		setGoalClampState(0);
 		setIntakeState(0);
 
@@ -29,7 +29,7 @@ void autonpaths::runAutonSkills59() {
 	setDifferentialUseRelativeRotation(true);
 
 	// Wait for arm reset
-	// waitUntil(isArmResetted());
+	// clockWaitUntil(isArmResetted());
 	setArmResetDefaultStage(2);
 
 
@@ -131,8 +131,8 @@ namespace {
 
 	void firstCorner() {
 		// Wall stake
-		waitUntil(isArmResetted());
-		wait(600, msec);
+		clockWaitUntil(isArmResetted());
+		vclock::sleep(600);
 		runFollowLinearYield();
 		driveDistanceTiles(-0.5);
 
@@ -40,7 +40,7 @@ void autonpaths::runAutonSkillsLong() {
 	setDifferentialUseRelativeRotation(true);
 
 	// Wait for arm reset
-	waitUntil(isArmResetted());
+	clockWaitUntil(isArmResetted());
 
 
 	/* Skills */
@@ -146,7 +146,7 @@ namespace {
 
 		// Score preload on alliance wall stake
 		setArmStage(2);
-		task::sleep(600);
+		vclock::sleep(600);
 		driveAndTurnDistanceTiles(1.0, -90.0, 100.0, 100.0, 0.5);
 		driveAndTurnDistanceTiles(-0.5, -90.0, 70.0, 100.0, 0.5);
 		setArmStage(1, 0.5);
@@ -157,7 +157,7 @@ namespace {
 
 		// Grab goal
 		setGoalClampState(1);
-		wait(200, msec);
+		vclock::sleep(200);
 
 
 		/* Redirect 1 ring */
@@ -183,7 +183,7 @@ namespace {
 		runFollowSpline();
 
 		// Wait
-		waitUntil(_pathFollowCompleted);
+		clockWaitUntil(_pathFollowCompleted);
 
 
 		/* Score on neutral wall stake */
@@ -258,7 +258,7 @@ namespace {
 		// Grab goal
 		setGoalClampState(1);
 		setArmStage(2);
-		wait(200, msec);
+		vclock::sleep(200);
 
 
 		/* Score on alliance wall stake */
@@ -355,7 +355,7 @@ namespace {
 
 		// Grab goal
 		setGoalClampState(1);
-		wait(200, msec);
+		vclock::sleep(200);
 
 
 		/* Score on neutral wall stake */
@@ -424,7 +424,7 @@ namespace {
 		runFollowSpline();
 
 		// Wait
-		waitUntil(_pathFollowCompleted);
+		clockWaitUntil(_pathFollowCompleted);
 
 		// Climb
 		turnToAngle(45);
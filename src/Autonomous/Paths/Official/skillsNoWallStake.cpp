@@ -29,7 +29,7 @@ void autonpaths::runAutonSkillsNoWallStake() {
 	setDifferentialUseRelativeRotation(true);
 
 	// Wait for arm reset
-	waitUntil(isArmResetted());
+	clockWaitUntil(isArmResetted());
 
 
 	/* Skills */
@@ -110,7 +110,7 @@ namespace {
 	void firstCorner() {
 		// Wall stake
 		setArmStage(2);
-		wait(600, msec);
+		vclock::sleep(600);
 		runFollowLinearYield();
 		driveDistanceTiles(-0.5);
 
@@ -26,7 +26,7 @@ void autonpaths::runTemplate() {
 	setDifferentialUseRelativeRotation(true);
 
 	// Wait for arm reset
-	waitUntil(isArmResetted());
+	clockWaitUntil(isArmResetted());
 
 
 	/* Auton */
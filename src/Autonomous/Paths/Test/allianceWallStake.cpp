@@ -3,7 +3,7 @@
 namespace {}
 
 void autonpaths::runAllianceWallStake() {
-	timer autontimer;
+	vclock::Timer autontimer;
 	setRobotRotation(-180.0);
 
 
@@ -16,7 +16,7 @@ void autonpaths::runAllianceWallStake() {
 	setIntakeState(1);
 
 	while (autontimer.value() < 12.0) {
-		task::sleep(20);
+		vclock::sleep(20);
 	}
 
 
@@ -39,7 +39,7 @@ void autonpaths::runFieldTour() {
 	followSplinePath();
 
 	// Wait
-	waitUntil(_pathFollowCompleted);
+	clockWaitUntil(_pathFollowCompleted);
 
 	// Turn to 0
 	turnToAngle(0);
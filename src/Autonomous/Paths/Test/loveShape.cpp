@@ -52,7 +52,7 @@ void autonpaths::runLoveShape() {
 	followSplinePath();
 
 	// Wait
-	waitUntil(_pathFollowCompleted);
+	clockWaitUntil(_pathFollowCompleted);
 	printf("done\n");
 
 	// Follow path again
@@ -60,7 +60,7 @@ void autonpaths::runLoveShape() {
 	followSplinePath(true);
 
 	// Wait
-	waitUntil(_pathFollowCompleted);
+	clockWaitUntil(_pathFollowCompleted);
 	printf("done\n");
 
 	// Follow path
@@ -69,7 +69,7 @@ void autonpaths::runLoveShape() {
 	followSplinePath();
 
 	// Wait
-	waitUntil(_pathFollowCompleted);
+	clockWaitUntil(_pathFollowCompleted);
 	printf("done\n");
 
 	// Turn to 0
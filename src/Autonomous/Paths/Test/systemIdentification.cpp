@@ -0,0 +1,174 @@
+#include "Autonomous/autonPaths.h"
+
+#include "Autonomous/autonValues.h"
+
+#include "Mechanics/drivePipeline.h"
+
+#include "Utilities/sysidLog.h"
+#include "Utilities/scheduler.h"
+#include "Utilities/fieldInfo.h"
+
+namespace {
+	using sysid::Mechanism;
+	using sysid::Test;
+
+	// Mechanisms tested together
+	enum TestTarget {
+		Drive,
+		Arm,
+		Intake,
+	};
+
+	const int samplePeriod_msec = 10;
+
+	// Scheduler jobs that command the tested motors
+	const char *pausedJobNames[] = {"drive", "arm", "intake"};
+	const int pausedJobCount = 3;
+
+	void setJobsPaused(bool isPaused);
+	void runQuasistatic(TestTarget target, bool isReverse, double rampRate_voltPerSecond, double maxVoltage_volt, double maxTravel);
+	void runStep(TestTarget target, bool isReverse, double stepVoltage_volt, double maxTime_seconds, double maxTravel);
+	void applyVoltage(TestTarget target, double voltage_volt);
+	void stopTarget(TestTarget target);
+	void recordTarget(TestTarget target, Test test, double voltage_volt);
+	double getTravel(TestTarget target);
+	double motorDegreesToTiles(double degrees);
+}
+
+/// @brief Runs quasistatic and step-voltage tests on the drivetrain, arm and intake, and saves the samples to sysid.bin.
+void autonpaths::systemIdentification() {
+	setJobsPaused(true);
+	sysid::begin();
+
+	// Drivetrain, driving forward then back
+	runQuasistatic(Drive, false, 0.5, 7, 1.5);
+	runQuasistatic(Drive, true, 0.5, 7, 1.5);
+	runStep(Drive, false, 6, 2, 1.5);
+	runStep(Drive, true, 6, 2, 1.5);
+
+	// Arm, within a limited swing
+	runQuasistatic(Arm, false, 1, 6, 120);
+	runQuasistatic(Arm, true, 1, 6, 120);
+	runStep(Arm, false, 4, 1, 120);
+	runStep(Arm, true, 4, 1, 120);
+
+	// Intake, spinning freely
+	runQuasistatic(Intake, false, 1, 10, 1e9);
+	runQuasistatic(Intake, true, 1, 10, 1e9);
+	runStep(Intake, false, 8, 1.5, 1e9);
+	runStep(Intake, true, 8, 1.5, 1e9);
+
+	sysid::save("sysid.bin");
+	setJobsPaused(false);
+
+	// The motors were driven around the pipeline
+	drivepipeline::reset();
+}
+
+namespace {
+	void setJobsPaused(bool isPaused) {
+		for (int i = 0; i < pausedJobCount; i++) {
+			scheduler::setJobEnabled(scheduler::findJob(pausedJobNames[i]), !isPaused);
+		}
+	}
+
+	/// @brief Ramps the voltage slowly, so acceleration stays near zero.
+	void runQuasistatic(TestTarget target, bool isReverse, double rampRate_voltPerSecond, double maxVoltage_volt, double maxTravel) {
+		Test test = isReverse ? sysid::QuasistaticReverse : sysid::QuasistaticForward;
+		double direction = isReverse ? -1 : 1;
+		double startTravel = getTravel(target);
+
+		vclock::Timer testTimer;
+		while (true) {
+			double voltage_volt = rampRate_voltPerSecond * testTimer.value();
+			if (voltage_volt > maxVoltage_volt || fabs(getTravel(target) - startTravel) > maxTravel) {
+				break;
+			}
+			applyVoltage(target, direction * voltage_volt);
+			recordTarget(target, test, direction * voltage_volt);
+			vclock::sleep(samplePeriod_msec);
+		}
+
+		stopTarget(target);
+		vclock::sleep(1000);
+	}
+
+	/// @brief Applies a constant voltage from rest, measuring the acceleration.
+	void runStep(TestTarget target, bool isReverse, double stepVoltage_volt, double maxTime_seconds, double maxTravel) {
+		Test test = isReverse ? sysid::StepReverse : sysid::StepForward;
+		double voltage_volt = isReverse ? -stepVoltage_volt : stepVoltage_volt;
+		double startTravel = getTravel(target);
+
+		vclock::Timer testTimer;
+		while (testTimer.value() < maxTime_seconds && fabs(getTravel(target) - startTravel) < maxTravel) {
+			applyVoltage(target, voltage_volt);
+			recordTarget(target, test, voltage_volt);
+			vclock::sleep(samplePeriod_msec);
+		}
+
+		stopTarget(target);
+		vclock::sleep(1000);
+	}
+
+	void applyVoltage(TestTarget target, double voltage_volt) {
+		switch (target) {
+			case Drive:
+				LeftMotors.spin(fwd, voltage_volt, volt);
+				RightMotors.spin(fwd, voltage_volt, volt);
+				break;
+			case Arm:
+				ArmMotor.spin(fwd, voltage_volt, volt);
+				break;
+			case Intake:
+				IntakeMotors.spin(fwd, voltage_volt, volt);
+				break;
+		}
+	}
+
+	void stopTarget(TestTarget target) {
+		switch (target) {
+			case Drive:
+				LeftMotors.stop(brake);
+				RightMotors.stop(brake);
+				break;
+			case Arm:
+				ArmMotor.stop(hold);
+				break;
+			case Intake:
+				IntakeMotors.stop(coast);
+				break;
+		}
+	}
+
+	void recordTarget(TestTarget target, Test test, double voltage_volt) {
+		switch (target) {
+			case Drive:
+				sysid::record(sysid::DriveLeft, test, voltage_volt, LeftMotors.velocity(pct) / autonvals::tilesPerSecond_to_pct, motorDegreesToTiles(LeftMotors.position(deg)));
+				sysid::record(sysid::DriveRight, test, voltage_volt, RightMotors.velocity(pct) / autonvals::tilesPerSecond_to_pct, motorDegreesToTiles(RightMotors.position(deg)));
+				break;
+			case Arm:
+				sysid::record(sysid::Arm, test, voltage_volt, ArmMotor.velocity(dps), ArmMotor.position(deg));
+				break;
+			case Intake:
+				sysid::record(sysid::Intake, test, voltage_volt, IntakeMotors.velocity(dps), IntakeMotors.position(deg));
+				break;
+		}
+	}
+
+	/// @brief Returns the distance moved, in tiles for the drivetrain and degrees otherwise.
+	double getTravel(TestTarget target) {
+		switch (target) {
+			case Drive:
+				return motorDegreesToTiles((LeftMotors.position(deg) + RightMotors.position(deg)) / 2.0);
+			case Arm:
+				return ArmMotor.position(deg);
+			case Intake:
+				return IntakeMotors.position(deg);
+		}
+		return 0;
+	}
+
+	double motorDegreesToTiles(double degrees) {
+		return degrees * (1.0 / 360.0) * (1.0 / botinfo::driveWheelMotorGearRatio) * botinfo::driveWheelCircumIn * (1.0 / field::tileLengthIn);
+	}
+}
@@ -14,21 +14,21 @@ void autonpaths::autonTest() {
 
 	if (false) {
 		turnToAngle(45);
-		task::sleep(200);
+		vclock::sleep(200);
 		turnToAngleVelocity(-45, 15);
-		task::sleep(200);
+		vclock::sleep(200);
 		turnToAngleVelocity(90, 30);
-		task::sleep(200);
+		vclock::sleep(200);
 		turnToAngleVelocity(-90, 60);
-		task::sleep(200);
+		vclock::sleep(200);
 		turnToAngle(180);
-		task::sleep(200);
+		vclock::sleep(200);
 		turnToAngle(-180);
-		task::sleep(200);
+		vclock::sleep(200);
 		turnToAngle(450);
-		task::sleep(200);
+		vclock::sleep(200);
 		turnToAngle(-450, 0.0, 3.5);
-		task::sleep(200);
+		vclock::sleep(200);
 		turnToAngle(0);
 	}
 
@@ -61,7 +61,7 @@ void autonpaths::autonTest() {
 void autonpaths::odometryRadiusTest() {
 	setRobotRotation(0.0);
 
-	wait(100, msec);
+	vclock::sleep(100);
 
 	printf("Clockwise\n");
 
@@ -69,11 +69,11 @@ void autonpaths::odometryRadiusTest() {
 	turnToAngleVelocity(360.0 * 10.0, 30.0, 0.0, 40.0);
 	mainOdometry.printDebug();
 
-	wait(1, sec);
+	vclock::sleep(1000);
 
 	setRobotRotation(0.0);
 
-	wait(100, msec);
+	vclock::sleep(100);
 
 	printf("Counter clockwise\n");
 
@@ -81,3 +81,44 @@ void autonpaths::odometryRadiusTest() {
 	turnToAngleVelocity(-360.0 * 10.0, 30.0, 0.0, 40.0);
 	mainOdometry.printDebug();
 }
+
+void autonpaths::turnProfileTest() {
+	setDifferentialUseRelativeRotation(true);
+
+	// Turn angles to compare
+	const int turnCount = 3;
+	const double turnAngles_degrees[turnCount] = {45, 90, 180};
+	double pidTimes_seconds[turnCount], profiledTimes_seconds[turnCount];
+	double pidErrors_degrees[turnCount], profiledErrors_degrees[turnCount];
+
+	for (int mode = 0; mode < 2; mode++) {
+		for (int i = 0; i < turnCount; i++) {
+			// Start from rest
+			setRobotRotation(0.0);
+			vclock::sleep(500);
+
+			// Turn
+			vclock::Timer turnTimer;
+			if (mode == 0) turnToAngle(turnAngles_degrees[i]);
+			else turnToAngleProfiled(turnAngles_degrees[i]);
+			double turnTime_seconds = turnTimer.value();
+
+			// Measure after the robot stops
+			vclock::sleep(500);
+			double error_degrees = turnAngles_degrees[i] - mainOdometry.getLookFieldAngle_degrees();
+			if (mode == 0) {
+				pidTimes_seconds[i] = turnTime_seconds;
+				pidErrors_degrees[i] = error_degrees;
+			} else {
+				profiledTimes_seconds[i] = turnTime_seconds;
+				profiledErrors_degrees[i] = error_degrees;
+			}
+		}
+	}
+
+	// Print comparison
+	printf("Turn | PID time, err | Profiled time, err\n");
+	for (int i = 0; i < turnCount; i++) {
+		printf("%4.0f | %5.2f s, %5.2f | %5.2f s, %5.2f\n", turnAngles_degrees[i], pidTimes_seconds[i], pidErrors_degrees[i], profiledTimes_seconds[i], profiledErrors_degrees[i]);
+	}
+}
@@ -1,11 +1,26 @@
 #include "Autonomous/autonPaths.h"
 
+#include "AutonUtilities/linegular.h"
+
+#include "Utilities/generalUtility.h"
+#include "Utilities/sysidConstants.h"
+
 namespace autonpaths { namespace pathbuild {
 	// Build paths
 
-	const double maxVel = 3.7 * 0.6;
-	const double maxAccel = 2;
-	const double maxDecel = 2;
+	// Fractions of the characterized limits of the slower side
+	// Raise the acceleration fraction only once the drive constants are fitted
+	const double maxVel = std::min(sysidconstants::driveLeftMaxVelocity_tilesPerSecond, sysidconstants::driveRightMaxVelocity_tilesPerSecond) * 0.6;
+	const double maxAccel = std::min(sysidconstants::driveLeftMaxAcceleration_tilesPerSecondSquared, sysidconstants::driveRightMaxAcceleration_tilesPerSecondSquared) * 0.5;
+	const double maxDecel = maxAccel;
+
+	// Not applied yet, jerk-limited plans are slower at this acceleration
+	// Apply once the fitted acceleration allows a higher maxAccel
+	const double maxJerk = 30;
+
+	// Sequence joints passed without stopping
+	const double maxJointGap_tiles = 0.02;
+	const double maxJointTurn_degrees = 5;
 
 	std::vector<UniformCubicSpline> splines;
 	std::vector<CurveSampler> splineSamplers;
@@ -34,6 +49,65 @@ namespace autonpaths { namespace pathbuild {
 		willReverse.push_back(reverse);
 	}
 
+	void pushNewSplineSequence(std::vector<UniformCubicSpline> sequence, bool reverse, double maxVel) {
+		// Build samplers and constraints
+		const int pathCount = (int) sequence.size();
+		std::vector<CurveSampler> sequenceSamplers;
+		std::vector<TrajectoryPlanner> sequencePlans;
+		for (UniformCubicSpline &spline : sequence) {
+			CurveSampler splineSampler = CurveSampler(spline)
+				.calculateByResolution(spline.getTRange().second * 10);
+			sequenceSamplers.push_back(splineSampler);
+			sequencePlans.push_back(
+				TrajectoryPlanner(splineSampler.getDistanceRange().second)
+					.autoSetMotionConstraints(splineSampler, 0.3, maxVel, maxAccel, maxDecel)
+			);
+		}
+
+		// Junction speeds, starting and ending at rest
+		// handoff[i] is the speed from path i - 1 into path i
+		std::vector<double> handoffVelocity(pathCount + 1, 0);
+		for (int i = 1; i < pathCount; i++) {
+			// Only pass through joints that keep position and heading
+			Linegular endLg = sequence[i - 1].getLinegularAt(sequence[i - 1].getTRange().second, reverse);
+			Linegular startLg = sequence[i].getLinegularAt(0, reverse);
+			double jointGap_tiles = std::hypot(startLg.getX() - endLg.getX(), startLg.getY() - endLg.getY());
+			double jointTurn_degrees = genutil::modRange(startLg.getThetaPolarAngle_degrees() - endLg.getThetaPolarAngle_degrees(), 360, -180);
+			if (jointGap_tiles > maxJointGap_tiles || std::fabs(jointTurn_degrees) > maxJointTurn_degrees) {
+				continue;
+			}
+
+			// Curvature limits on both sides
+			double previousLength = sequenceSamplers[i - 1].getDistanceRange().second;
+			handoffVelocity[i] = std::min(
+				sequencePlans[i - 1].getMaxVelocityAtDistance(previousLength),
+				sequencePlans[i].getMaxVelocityAtDistance(0)
+			);
+		}
+
+		// Keep each junction reachable from its neighbours
+		// v^2 <= u^2 + 2aL
+		for (int i = 1; i < pathCount; i++) {
+			double length = sequenceSamplers[i - 1].getDistanceRange().second;
+			handoffVelocity[i] = std::min(handoffVelocity[i], std::sqrt(std::pow(handoffVelocity[i - 1], 2) + 2 * maxAccel * length));
+		}
+		for (int i = pathCount - 1; i >= 1; i--) {
+			double length = sequenceSamplers[i].getDistanceRange().second;
+			handoffVelocity[i] = std::min(handoffVelocity[i], std::sqrt(std::pow(handoffVelocity[i + 1], 2) + 2 * maxDecel * length));
+		}
+
+		// Plan and push
+		for (int i = 0; i < pathCount; i++) {
+			sequencePlans[i]
+				.setBoundaryVelocities(handoffVelocity[i], handoffVelocity[i + 1])
+				.calculateMotion();
+			splines.push_back(sequence[i]);
+			splineSamplers.push_back(sequenceSamplers[i]);
+			splineTrajectoryPlans.push_back(sequencePlans[i]);
+			willReverse.push_back(reverse);
+		}
+	}
+
 	void runFollowSpline() {
 		autonfunctions::setSplinePath(splines[pathIndex], splineTrajectoryPlans[pathIndex], splineSamplers[pathIndex]);
 		autonfunctions::followSplinePath(willReverse[pathIndex]);
@@ -1,4 +1,5 @@
 #include "Autonomous/autonPaths.h"
+#include "Autonomous/autonCommands.h"
 
 namespace {
 	const double grabGoalVelocity_pct = 70;
@@ -7,9 +8,12 @@ namespace {
 namespace autonpaths { namespace combination {
 	void grabGoalAt(double x_tiles, double y_tiles, double grabAtDistanceError) {
 		turnToFace_tiles(x_tiles, y_tiles, true);
-		async_driveTurnToFace_tiles(x_tiles, y_tiles, true, grabGoalVelocity_pct);
-		waitUntil(_linearPathDistanceError < grabAtDistanceError);
-		setGoalClampState(1);
-		waitUntil(_isDriveTurnSettled);
+		commands::runAndWait(autoncommands::deadline({
+			autoncommands::driveTurnToFace(x_tiles, y_tiles, true, grabGoalVelocity_pct),
+			autoncommands::sequence({
+				autoncommands::waitForDriveTurnDistance(grabAtDistanceError),
+				autoncommands::setGoalClampState(true),
+			}),
+		}));
 	}
 }}
\ No newline at end of file
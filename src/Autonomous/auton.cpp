@@ -1,6 +1,7 @@
 #include "Autonomous/auton.h"
 
 #include "Autonomous/autonpaths.h"
+#include "AutonUtilities/settlePredictor.h"
 #include "Mechanics/botIntake.h"
 #include "Mechanics/botIntake2.h"
 #include "Utilities/debugFunctions.h"
@@ -17,6 +18,8 @@ namespace {
 	// autonomousType auton_runType = autonomousType::AutonSkills;
 	// autonomousType auton_runType = autonomousType::BlueSoloAWP;
 	// autonomousType auton_runType = autonomousType::OdometryRadiusTest;
+	// autonomousType auton_runType = autonomousType::TurnProfileTest;
+	// autonomousType auton_runType = autonomousType::SystemIdentification;
 	int auton_allianceId;
 
 	std::string autonFilterOutColor = "";
@@ -135,6 +138,9 @@ namespace auton {
 		botintake::setFilterOutColor(autonFilterOutColor);
 		botintake2::setFilterOutColor(autonFilterOutColor);
 
+		// Reset statistics
+		settlestats::resetStats();
+
 		// Run auton
 		switch (auton_runType) {
 			case autonomousType::RedUp:
@@ -188,8 +194,17 @@ namespace auton {
 			case autonomousType::OdometryRadiusTest:
 				autonpaths::odometryRadiusTest();
 				break;
+			case autonomousType::TurnProfileTest:
+				autonpaths::turnProfileTest();
+				break;
+			case autonomousType::SystemIdentification:
+				autonpaths::systemIdentification();
+				break;
 			default:
 				break;
 		}
+
+		// Report time saved by settle prediction
+		settlestats::printStats();
 	}
 }
@@ -9,32 +9,60 @@
 // #include "Mechanics/botWings.h"
 #include "Controller/controls.h"
 #include "Controller/rumble.h"
+#include "AutonUtilities/command.h"
+#include "AutonUtilities/ltvUnicycleTable.h"
+#include "Autonomous/autonFunctions.h"
 #include "Mechanics/goalClamp.h"
+#include "Simulation/robotSimulator.h"
 #include "Utilities/debugFunctions.h"
+#include "Utilities/dispatcher.h"
+#include "Utilities/scheduler.h"
+#include "Utilities/timingProbe.h"
 #include "main.h"
 
+namespace {
+	// Print the timing probes and scheduler stats to the terminal every 5 seconds
+	const bool dumpTimingStats = false;
+}
+
 namespace controls {
 	void startThreads() {
+		// Periodic jobs
 		if (intakePart == 1) {
-			task intakeTask([]() -> int {
-				botintake::runThread();
-				return 1;
-			});
+			scheduler::addJob("intake", botintake::runFrame, 5, scheduler::order::Mechanism);
 		} else {
-			task intakeTask([]() -> int {
-				botintake2::runThread();
+			scheduler::addJob("intake", botintake2::runFrame, 5, scheduler::order::Mechanism);
+		}
+		scheduler::addJob("commands", commands::runFrame, 20, scheduler::order::Commands);
+		scheduler::addJob("arm", botarm::runFrame, 20, scheduler::order::Mechanism);
+		scheduler::addJob("drive", botdrive::runFrame, 20, scheduler::order::Drive);
+		scheduler::addJob("dispatcher", dispatcher::runFrame, dispatcher::tickPeriod_msec, scheduler::order::Dispatch);
+		scheduler::addJob("rumble", rumble::runFrame, 200, scheduler::order::Feedback);
+
+		// Path follower, at the period the LTV gains are computed for
+		// Enabled by the first path follow, as jobs can't be added from inside a job
+		int pathFollowJobId = scheduler::addJob("path follow", autonfunctions::runPathFollowFrame, ltvtable::period_msec, scheduler::order::PathFollow);
+		scheduler::setJobEnabled(pathFollowJobId, false);
+
+		if (mainUseSimulator) {
+			scheduler::addJob("simulator", []() {
+				robotSimulator.updatePhysics();
+			}, 5, scheduler::order::Simulation);
+		}
+		scheduler::start();
+
+		// Timing dump, off the scheduler so printing doesn't delay the control jobs
+		if (dumpTimingStats) {
+			task timingDump([]() -> int {
+				while (true) {
+					task::sleep(5000);
+					timing::printStats();
+					scheduler::printStats();
+				}
 				return 1;
-			});
+			}, task::taskPriorityLow);
 		}
-		task armTask([]() -> int {
-			botarm::runThread();
-			return 1;
-		});
 
-		task rumbleTask([]() -> int {
-			rumble::runThread();
-			return 1;
-		});
 		rumble::setString(".");
 	}
 
@@ -9,19 +9,13 @@ namespace {
 }
 
 namespace rumble {
-	void runThread() {
-		while (true) {
-			// Thread code here
-			if (keepRumble) {
-				Controller1.rumble(".");
-			} else if (nextRumbleString != "") {
-				Controller1.rumble(nextRumbleString.c_str());
-				nextRumbleString = "";
-			} else {
-				;
-			}
-
-			wait(200, msec);
+	/// @brief Sends the pending rumble. Called every 200 ms by the scheduler.
+	void runFrame() {
+		if (keepRumble) {
+			Controller1.rumble(".");
+		} else if (nextRumbleString != "") {
+			Controller1.rumble(nextRumbleString.c_str());
+			nextRumbleString = "";
 		}
 	}
 
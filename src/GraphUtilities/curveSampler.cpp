@@ -3,6 +3,8 @@
 #include "Utilities/generalUtility.h"
 
 #include <stdio.h>
+#include <cmath>
+#include <algorithm>
 
 CurveSampler::CurveSampler() {
 	_onInit();
@@ -159,3 +161,33 @@ double CurveSampler::distanceToParam(double distance) {
 	// Return 0 if fails
 	return 0;
 }
+
+std::vector<CurvePoint> CurveSampler::getUniformPoints(double spacing) {
+	std::vector<CurvePoint> points;
+
+	// Validate
+	if (t_cumulativeDistances.empty() || spacing <= 0) {
+		return points;
+	}
+
+	// Get point count
+	double pathStart = getDistanceRange().first;
+	double pathEnd = getDistanceRange().second;
+	int segmentCount = std::max(1, (int) ceil((pathEnd - pathStart) / spacing));
+
+	// Sample each point
+	for (int i = 0; i <= segmentCount; i++) {
+		double distance = std::min(pathStart + i * spacing, pathEnd);
+		double t = distanceToParam(distance);
+		std::vector<double> position = spline.getPositionAtT(t);
+
+		CurvePoint point;
+		point.x = position[0];
+		point.y = position[1];
+		point.distance = distance;
+		point.curvature = spline.getCurvatureAt(t);
+		points.push_back(point);
+	}
+
+	return points;
+}
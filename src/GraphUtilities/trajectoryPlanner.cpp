@@ -10,6 +10,12 @@
 
 namespace {
 	bool debugPrint = false;
+
+	// Capping of the boundary velocities under a jerk limit
+	const int maxBoundaryIterationCount = 5;
+
+	// Sampling of the jerk-limited motion when clamping it to the constraints
+	const double clampSamplePeriod_seconds = 0.005;
 }
 
 TrajectoryPlanner::TrajectoryPlanner(double totalDistance) {
@@ -19,6 +25,24 @@ TrajectoryPlanner::TrajectoryPlanner(double totalDistance) {
 void TrajectoryPlanner::_onInit(double totalDistance) {
 	distance_motionConstraints.clear();
 	this->totalDistance = totalDistance;
+	this->maxJerk = -1;
+	this->startVelocity = 0;
+	this->endVelocity = 0;
+}
+
+TrajectoryPlanner &TrajectoryPlanner::setMaxJerk(double maxJerk) {
+	this->maxJerk = maxJerk;
+
+	// Method chaining
+	return *this;
+}
+
+TrajectoryPlanner &TrajectoryPlanner::setBoundaryVelocities(double startVelocity, double endVelocity) {
+	this->startVelocity = std::max(0.0, startVelocity);
+	this->endVelocity = std::max(0.0, endVelocity);
+
+	// Method chaining
+	return *this;
 }
 
 TrajectoryPlanner &TrajectoryPlanner::autoSetMotionConstraints(
@@ -92,7 +116,7 @@ std::vector<std::pair<double, std::vector<double>>> TrajectoryPlanner::_getForwa
 
 	// Look through each constraint segment
 	const int segmentCount = distance_motionConstraints.size();
-	double travellingVelocity = 0;
+	double travellingVelocity = startVelocity;
 	for (int segment = 0; segment < (int) segmentCount; segment++) {
 		// Get segment info for [segment, segment + 1]
 		const double distanceStart = distance_motionConstraints[segment].first;
@@ -141,7 +165,7 @@ std::vector<std::pair<double, std::vector<double>>> TrajectoryPlanner::_getBackw
 
 	// Look through each constraint segment
 	const int segmentCount = distance_motionConstraints.size();
-	double travellingVelocity = 0;
+	double travellingVelocity = endVelocity;
 	for (int segment = segmentCount - 1; segment >= 0; segment--) {
 		// Get segment info for [segment, segment + 1]
 		const double distanceStart = (segment == segmentCount - 1) ? 0 : totalDistance - distance_motionConstraints[segment + 1].first;
@@ -386,6 +410,99 @@ std::vector<std::pair<double, std::vector<double>>> TrajectoryPlanner::_getCombi
 }
 
 TrajectoryPlanner &TrajectoryPlanner::calculateMotion() {
+	// Cap boundary velocities by the constraints at the ends
+	if (!distance_motionConstraints.empty()) {
+		startVelocity = std::min(startVelocity, distance_motionConstraints.front().second[0]);
+		endVelocity = std::min(endVelocity, distance_motionConstraints.back().second[0]);
+
+		// Cap them by what the acceleration passes can reach from the other end
+		startVelocity = std::min(startVelocity, _getReachableVelocity(endVelocity, true));
+		endVelocity = std::min(endVelocity, _getReachableVelocity(startVelocity, false));
+		startVelocity = std::min(startVelocity, _getReachableVelocity(endVelocity, true));
+	}
+
+	// Constant-acceleration motion
+	if (maxJerk <= 0 || distance_motionConstraints.empty()) {
+		_calculateSteppedMotion();
+		return *this;
+	}
+
+	// Window the acceleration steps are averaged over
+	// The largest step, from full acceleration to full deceleration, then ramps over the whole window at the jerk limit
+	double maxAccel = 0, maxDecel = 0;
+	for (auto &constraint : distance_motionConstraints) {
+		maxAccel = std::max(maxAccel, constraint.second[1]);
+		maxDecel = std::max(maxDecel, constraint.second[2]);
+	}
+	const double window = (maxAccel + maxDecel) / maxJerk;
+
+	// A moving boundary blends over half a window of distance, cap its velocity by the constraints there
+	startVelocity = std::min(startVelocity, _getMinVelocityConstraint(0, startVelocity * window / 2));
+	endVelocity = std::min(endVelocity, _getMinVelocityConstraint(totalDistance - endVelocity * window / 2, totalDistance));
+
+	// The averaged motion travels half a window further at each moving boundary
+	// Plan the steps over the shorter distance, with the constraints shifted to match
+	// Lowering a boundary velocity shortens its shift, so cap them until they settle
+	std::vector<std::pair<double, std::vector<double>>> originalConstraints = distance_motionConstraints;
+	const double originalDistance = totalDistance;
+	for (int iteration = 0; iteration < maxBoundaryIterationCount; iteration++) {
+		const double steppedDistance = originalDistance - (startVelocity + endVelocity) * window / 2;
+		if (window < 1e-6 || steppedDistance < 1e-3) {
+			distance_motionConstraints = originalConstraints;
+			totalDistance = originalDistance;
+			_calculateSteppedMotion();
+			return *this;
+		}
+		_setShiftedConstraints(originalConstraints, startVelocity * window / 2, steppedDistance);
+
+		const double previousStartVelocity = startVelocity;
+		const double previousEndVelocity = endVelocity;
+		startVelocity = std::min(startVelocity, _getReachableVelocity(endVelocity, true));
+		endVelocity = std::min(endVelocity, _getReachableVelocity(startVelocity, false));
+		if (genutil::isWithin(startVelocity, previousStartVelocity, 1e-9) && genutil::isWithin(endVelocity, previousEndVelocity, 1e-9)) {
+			break;
+		}
+	}
+	bool isPlanned = _calculateSteppedMotion();
+	distance_motionConstraints = originalConstraints;
+	totalDistance = originalDistance;
+	if (!isPlanned) {
+		return *this;
+	}
+
+	// Smooth acceleration steps
+	_applyJerkLimit(window);
+
+	// Averaging rounds the corners of the velocity profile, which can pass a constraint
+	_clampToConstraints();
+
+	// Method chaining
+	return *this;
+}
+
+void TrajectoryPlanner::_setShiftedConstraints(
+	std::vector<std::pair<double, std::vector<double>>> &originalConstraints,
+	double startShift, double shiftedDistance
+) {
+	// Constraints that fall before the start or past the end merge into the first or last one
+	distance_motionConstraints = {};
+	for (auto &originalConstraint : originalConstraints) {
+		double shiftedStart = std::max(0.0, originalConstraint.first - startShift);
+		std::vector<double> constraint = originalConstraint.second;
+		if (!distance_motionConstraints.empty() && shiftedStart >= shiftedDistance) {
+			std::vector<double> &lastConstraint = distance_motionConstraints.back().second;
+			lastConstraint[0] = std::max(endVelocity, std::min(lastConstraint[0], constraint[0]));
+		} else if (!distance_motionConstraints.empty() && shiftedStart <= distance_motionConstraints.back().first) {
+			constraint[0] = std::max(startVelocity, std::min(distance_motionConstraints.back().second[0], constraint[0]));
+			distance_motionConstraints.back().second = constraint;
+		} else {
+			distance_motionConstraints.push_back({shiftedStart, constraint});
+		}
+	}
+	totalDistance = shiftedDistance;
+}
+
+bool TrajectoryPlanner::_calculateSteppedMotion() {
 	// Get combined kinematics
 	std::vector<std::pair<double, std::vector<double>>> combined_distance_kinematics = _getCombinedKinematics();
 
@@ -402,27 +519,222 @@ TrajectoryPlanner &TrajectoryPlanner::calculateMotion() {
 		const double d1 = distance_kinematics.first;
 		const double d2 = (segmentIndex == segmentCount - 1) ? totalDistance : combined_distance_kinematics[segmentIndex + 1].first; 
 		const double v = distance_kinematics.second[0];
-		const double u = (segmentIndex == segmentCount - 1) ? 0 : combined_distance_kinematics[segmentIndex + 1].second[0];
+		const double u = (segmentIndex == segmentCount - 1) ? endVelocity : combined_distance_kinematics[segmentIndex + 1].second[0];
 		const double a = distance_kinematics.second[1];
 
 		// Push time kinematics
-		time_kinematics.push_back({cumulativeTime, {d1, v, a}});
+		time_kinematics.push_back({cumulativeTime, {d1, v, a, 0}});
 		if (debugPrint) printf("%.3f, %.3f, %.3f, %.3f\n", cumulativeTime, d1, v, a);
 
 		// Get and update time
 		if (v + u == 0 && a == 0) {
 			printf("Error in trajectory!\n");
-			return *this;
+			return false;
 		}
 		const double time = (a != 0) ? (u - v) / a : 2 * (d2 - d1) / (v + u);
 		cumulativeTime += time;
 	}
 
-	// Final zero time
-	time_kinematics.push_back({cumulativeTime, {totalDistance, 0, 0}});
+	// Final time
+	time_kinematics.push_back({cumulativeTime, {totalDistance, endVelocity, 0, 0}});
+	return true;
+}
 
-	// Method chaining
-	return *this;
+void TrajectoryPlanner::_applyJerkLimit(double window) {
+	// Keep the constant-acceleration profile
+	// The boundaries continue at their velocity past the ends, so the averaged motion meets them without acceleration
+	std::vector<std::pair<double, std::vector<double>>> steppedKinematics = time_kinematics;
+	const double steppedTotalTime = steppedKinematics.back().first;
+	const double steppedDistance = steppedKinematics.back().second[0];
+	auto getSteppedMotion = [&](double time) -> std::vector<double> {
+		if (time <= 0) {
+			return {startVelocity * time, startVelocity};
+		}
+		if (time >= steppedTotalTime) {
+			return {steppedDistance + endVelocity * (time - steppedTotalTime), endVelocity};
+		}
+		return _getSteppedMotionAtTime(steppedKinematics, time);
+	};
+	auto getSteppedVelocity = [&](double time) -> double {
+		return getSteppedMotion(time)[1];
+	};
+
+	// The averaged motion starts as the window starts entering the steps, and ends once it has fully left them
+	// It travels v_start * window / 2 and v_end * window / 2 further than the steps
+	const double endTime = steppedTotalTime + window;
+
+	// Acceleration is linear between the window's edges crossing a step
+	std::vector<double> breakTimes = {0, endTime};
+	for (auto &node : steppedKinematics) {
+		breakTimes.push_back(node.first);
+		breakTimes.push_back(node.first + window);
+	}
+	std::sort(breakTimes.begin(), breakTimes.end());
+
+	// Integrate the constant-jerk segments
+	// v(t) = (d(t) - d(t - window)) / window
+	// a(t) = (v(t) - v(t - window)) / window
+	time_kinematics = {};
+	double d = 0;
+	double v = startVelocity;
+	for (int i = 0; i < (int) breakTimes.size() - 1; i++) {
+		const double t1 = breakTimes[i];
+		const double t2 = breakTimes[i + 1];
+		if (t2 - t1 < 1e-9) {
+			continue;
+		}
+
+		const double a1 = (getSteppedVelocity(t1) - getSteppedVelocity(t1 - window)) / window;
+		const double a2 = (getSteppedVelocity(t2) - getSteppedVelocity(t2 - window)) / window;
+		const double dt = t2 - t1;
+		const double j = (a2 - a1) / dt;
+		time_kinematics.push_back({t1, {d, v, a1, j}});
+		if (debugPrint) printf("%.3f, %.3f, %.3f, %.3f, %.3f\n", t1, d, v, a1, j);
+
+		d += v * dt + 0.5 * a1 * dt * dt + j * dt * dt * dt / 6.0;
+		v += a1 * dt + 0.5 * j * dt * dt;
+	}
+
+	// Final time, at the integrated state
+	time_kinematics.push_back({endTime, {d, v, 0, 0}});
+}
+
+void TrajectoryPlanner::_clampToConstraints() {
+	// Sample the motion, with a sample at each constraint's start
+	// Velocity is monotonic between samples, so a segment stays within the constraint if both its samples do
+	std::vector<std::pair<double, double>> samples = {};
+	const double totalTime = getTotalTime();
+	for (double time = 0; time < totalTime; time += clampSamplePeriod_seconds) {
+		std::vector<double> motion = getMotionAtTime(time);
+		samples.push_back({motion[0], motion[1]});
+	}
+	const std::vector<double> &endKinematics = time_kinematics.back().second;
+	samples.push_back({endKinematics[0], endKinematics[1]});
+	for (auto &constraint : distance_motionConstraints) {
+		if (0 < constraint.first && constraint.first < endKinematics[0]) {
+			samples.push_back({constraint.first, getMotionAtDistance(constraint.first)[1]});
+		}
+	}
+	std::sort(samples.begin(), samples.end());
+
+	// Drop repeated distances
+	std::vector<std::pair<double, double>> uniqueSamples = {samples[0]};
+	for (int i = 1; i < (int) samples.size(); i++) {
+		if (samples[i].first - uniqueSamples.back().first > 1e-9) {
+			uniqueSamples.push_back(samples[i]);
+		}
+	}
+	samples = uniqueSamples;
+	const int sampleCount = (int) samples.size();
+
+	// Clamp to the constraints, using the lower one at a constraint's start
+	for (int i = 0; i < sampleCount; i++) {
+		const int constraintIndex = _getConstraintIndex(samples[i].first);
+		double maxVelocity = distance_motionConstraints[constraintIndex].second[0];
+		if (constraintIndex > 0 && genutil::isWithin(samples[i].first, distance_motionConstraints[constraintIndex].first, 1e-9)) {
+			maxVelocity = std::min(maxVelocity, distance_motionConstraints[constraintIndex - 1].second[0]);
+		}
+		samples[i].second = std::min(samples[i].second, maxVelocity);
+	}
+
+	// Forward and backward passes, so the clamped samples keep to the acceleration constraints
+	// vf^2 = vi^2 + 2aΔs
+	for (int i = 0; i < sampleCount - 1; i++) {
+		const double segmentDistance = samples[i + 1].first - samples[i].first;
+		const double maxAccel = distance_motionConstraints[_getConstraintIndex(samples[i].first + segmentDistance / 2)].second[1];
+		samples[i + 1].second = std::min(samples[i + 1].second, std::sqrt(std::pow(samples[i].second, 2) + 2 * maxAccel * segmentDistance));
+	}
+	for (int i = sampleCount - 1; i > 0; i--) {
+		const double segmentDistance = samples[i].first - samples[i - 1].first;
+		const double maxDecel = distance_motionConstraints[_getConstraintIndex(samples[i - 1].first + segmentDistance / 2)].second[2];
+		samples[i - 1].second = std::min(samples[i - 1].second, std::sqrt(std::pow(samples[i].second, 2) + 2 * maxDecel * segmentDistance));
+	}
+
+	// Convert to constant-acceleration segments
+	// t = 2Δd / (vi + vf)
+	time_kinematics = {};
+	double cumulativeTime = 0;
+	for (int i = 0; i < sampleCount - 1; i++) {
+		const double d1 = samples[i].first;
+		const double d2 = samples[i + 1].first;
+		const double v = samples[i].second;
+		const double u = samples[i + 1].second;
+		if (v + u == 0) {
+			printf("Error in trajectory!\n");
+			return;
+		}
+		const double time = 2 * (d2 - d1) / (v + u);
+		time_kinematics.push_back({cumulativeTime, {d1, v, (u - v) / time, 0}});
+		cumulativeTime += time;
+	}
+	time_kinematics.push_back({cumulativeTime, {samples.back().first, samples.back().second, 0, 0}});
+}
+
+std::vector<double> TrajectoryPlanner::_getSteppedMotionAtTime(std::vector<std::pair<double, std::vector<double>>> &steppedKinematics, double time) {
+	// Binary search for the segment that contains the time
+	int bL = 0, bR = (int) steppedKinematics.size() - 1;
+	int foundL = 0;
+	while (bL <= bR) {
+		int bM = bL + (bR - bL) / 2;
+		if (steppedKinematics[bM].first <= time) {
+			foundL = bM;
+			bL = bM + 1;
+		} else {
+			bR = bM - 1;
+		}
+	}
+
+	// {distance, velocity} at constant acceleration
+	std::vector<double> &nodeKinematics = steppedKinematics[foundL].second;
+	const double dt = time - steppedKinematics[foundL].first;
+	return {
+		nodeKinematics[0] + nodeKinematics[1] * dt + 0.5 * nodeKinematics[2] * dt * dt,
+		nodeKinematics[1] + nodeKinematics[2] * dt
+	};
+}
+
+double TrajectoryPlanner::_getReachableVelocity(double fromVelocity, bool isBackward) {
+	// Same passes as the forward and backward kinematics, keeping only the velocity
+	// vf = √(vi^2 + 2aΔs)
+	const int segmentCount = distance_motionConstraints.size();
+	double travellingVelocity = fromVelocity;
+	for (int i = 0; i < segmentCount; i++) {
+		const int segment = isBackward ? segmentCount - 1 - i : i;
+		const double distanceStart = distance_motionConstraints[segment].first;
+		const double distanceEnd = (segment == segmentCount - 1) ? totalDistance : distance_motionConstraints[segment + 1].first;
+		std::vector<double> &motionConstraints = distance_motionConstraints[segment].second;
+		const double maxAccel = isBackward ? motionConstraints[2] : motionConstraints[1];
+		travellingVelocity = std::min(travellingVelocity, motionConstraints[0]);
+		travellingVelocity = std::min(motionConstraints[0], std::sqrt(std::pow(travellingVelocity, 2) + 2 * maxAccel * (distanceEnd - distanceStart)));
+	}
+	return travellingVelocity;
+}
+
+int TrajectoryPlanner::_getConstraintIndex(double distance) {
+	// Binary search for the last constraint starting at or before the distance
+	int bL = 0, bR = (int) distance_motionConstraints.size() - 1;
+	int foundL = 0;
+	while (bL <= bR) {
+		int bM = bL + (bR - bL) / 2;
+		if (distance_motionConstraints[bM].first <= distance) {
+			foundL = bM;
+			bL = bM + 1;
+		} else {
+			bR = bM - 1;
+		}
+	}
+	return foundL;
+}
+
+double TrajectoryPlanner::_getMinVelocityConstraint(double startDistance, double endDistance) {
+	double minVelocity = 1e9;
+	for (int i = _getConstraintIndex(startDistance); i < (int) distance_motionConstraints.size(); i++) {
+		if (i > 0 && distance_motionConstraints[i].first > endDistance) {
+			break;
+		}
+		minVelocity = std::min(minVelocity, distance_motionConstraints[i].second[0]);
+	}
+	return minVelocity;
 }
 
 std::vector<double> TrajectoryPlanner::getMotionAtTime(double time) {
@@ -433,7 +745,8 @@ std::vector<double> TrajectoryPlanner::getMotionAtTime(double time) {
 
 	// Validate completion
 	if (time > time_kinematics.back().first) {
-		return time_kinematics.back().second;
+		std::vector<double> &endKinematics = time_kinematics.back().second;
+		return {endKinematics[0], endKinematics[1], endKinematics[2]};
 	}
 
 	// Binary search for the segment that contains the time
@@ -453,17 +766,93 @@ std::vector<double> TrajectoryPlanner::getMotionAtTime(double time) {
 	}
 
 	// Calculate the motion at that time
-	double segmentDeltaTime = time - time_kinematics[foundL].first;
-	std::vector<double> nodeKinematics = time_kinematics[foundL].second;
-	std::vector<double> motion(3);
-	motion[2] = nodeKinematics[2];
-	motion[1] = nodeKinematics[1] + nodeKinematics[2] * segmentDeltaTime;
-	motion[0] = nodeKinematics[0] + nodeKinematics[1] * segmentDeltaTime + 0.5 * nodeKinematics[2] * pow(segmentDeltaTime, 2);
+	double segmentDeltaTime = std::max(0.0, time - time_kinematics[foundL].first);
+	return _getSegmentMotion(time_kinematics[foundL].second, segmentDeltaTime);
+}
 
-	// Return result
+std::vector<double> TrajectoryPlanner::getMotionAtDistance(double distance) {
+	// Validate stored motion
+	if (time_kinematics.empty()) {
+		return {0, 0, 0};
+	}
+
+	// Validate completion
+	if (distance >= time_kinematics.back().second[0]) {
+		std::vector<double> &endKinematics = time_kinematics.back().second;
+		return {endKinematics[0], endKinematics[1], endKinematics[2]};
+	}
+
+	// Binary search for the segment that contains the distance
+	int bL, bR;
+	bL = 0;
+	bR = (int) time_kinematics.size() - 1;
+	int foundL = 0;
+	while (bL <= bR) {
+		int bM = bL + (bR - bL) / 2;
+		double nodeDistance = time_kinematics[bM].second[0];
+		if (nodeDistance <= distance) {
+			foundL = bM;
+			bL = bM + 1;
+		} else {
+			bR = bM - 1;
+		}
+	}
+
+	// Calculate the motion at that distance
+	double segmentDeltaDistance = std::max(0.0, distance - time_kinematics[foundL].second[0]);
+	std::vector<double> &nodeKinematics = time_kinematics[foundL].second;
+	if (nodeKinematics[3] == 0) {
+		// v^2 = v0^2 + 2 * a * d
+		std::vector<double> motion(3);
+		motion[2] = nodeKinematics[2];
+		motion[1] = sqrt(std::max(0.0, pow(nodeKinematics[1], 2) + 2 * nodeKinematics[2] * segmentDeltaDistance));
+		motion[0] = nodeKinematics[0] + segmentDeltaDistance;
+		return motion;
+	}
+
+	// Bisect for the time of a constant-jerk segment, distance increases with time
+	double segmentDuration = time_kinematics[foundL + 1].first - time_kinematics[foundL].first;
+	double timeL = 0, timeR = segmentDuration;
+	for (int i = 0; i < 30; i++) {
+		double timeM = 0.5 * (timeL + timeR);
+		if (_getSegmentMotion(nodeKinematics, timeM)[0] < distance) {
+			timeL = timeM;
+		} else {
+			timeR = timeM;
+		}
+	}
+	return _getSegmentMotion(nodeKinematics, 0.5 * (timeL + timeR));
+}
+
+std::vector<double> TrajectoryPlanner::_getSegmentMotion(std::vector<double> &nodeKinematics, double segmentDeltaTime) {
+	const double dt = segmentDeltaTime;
+	const double j = nodeKinematics[3];
+	std::vector<double> motion(3);
+	motion[2] = nodeKinematics[2] + j * dt;
+	motion[1] = nodeKinematics[1] + nodeKinematics[2] * dt + 0.5 * j * dt * dt;
+	motion[0] = nodeKinematics[0] + nodeKinematics[1] * dt + 0.5 * nodeKinematics[2] * dt * dt + j * dt * dt * dt / 6.0;
 	return motion;
 }
 
 double TrajectoryPlanner::getTotalTime() {
 	return time_kinematics.back().first;
 }
+
+double TrajectoryPlanner::getStartVelocity() {
+	return startVelocity;
+}
+
+double TrajectoryPlanner::getEndVelocity() {
+	return endVelocity;
+}
+
+double TrajectoryPlanner::getMaxVelocityAtDistance(double distance) {
+	double maxVelocity = 0;
+	for (auto &constraint : distance_motionConstraints) {
+		if (constraint.first > distance && maxVelocity > 0) {
+			break;
+		}
+		maxVelocity = constraint.second[0];
+	}
+	return maxVelocity;
+}
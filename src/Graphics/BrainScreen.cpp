@@ -20,6 +20,7 @@
 
 #include "Utilities/angleUtility.h"
 #include "Utilities/generalUtility.h"
+#include "Utilities/timingProbe.h"
 
 #include "Videos/video-main.h"
 #include "main.h"
@@ -61,6 +62,7 @@ namespace {
 	void drawTemperature();
 	void drawMotorPower();
 	void drawInertial();
+	void drawTiming();
 
 	// Variables
 	// Flywheel
@@ -77,7 +79,7 @@ namespace {
 	DockGui *simulationDock;
 	DockGui *autonDock, *autonDock_dockDock;
 	DockGui *autonSubdock1, *autonSubdock2, *autonSubdock3, *autonSubdock4;
-	DockGui *qrCodeDock, *motTempDock;
+	DockGui *qrCodeDock, *motTempDock, *timingDock;
 
 	// Others
 	vector<pair<int, int>> vexTeamQRCord, secondQRCord;
@@ -267,8 +269,9 @@ namespace {
 		if (mainUseSimulator && !autonfunctions::_pathFollowStarted) {
 			trajectoryValue = testTrajectoryPlan.getMotionAtTime(trajectoryTestTimer.value())[1];
 		} else {
-			double traj_distance = autonfunctions::_trajectoryPlan.getMotionAtTime(autonfunctions::_splinePathTimer.value())[0];
-			double traj_velocity = autonfunctions::_trajectoryPlan.getMotionAtTime(autonfunctions::_splinePathTimer.value())[1];
+			double traj_time = autonfunctions::_splinePathTimer.value() - autonfunctions::_splinePathStartTime_seconds;
+			double traj_distance = autonfunctions::_trajectoryPlan.getMotionAtTime(traj_time)[0];
+			double traj_velocity = autonfunctions::_trajectoryPlan.getMotionAtTime(traj_time)[1];
 			// double traj_tvalue = autonfunctions::_curveSampler.distanceToParam(traj_distance);
 			// double traj_angularVelocity = traj_velocity * autonfunctions::_splinePath.getCurvatureAt(traj_tvalue);
 			trajectoryValue = traj_velocity;
@@ -334,6 +337,12 @@ namespace {
 			mainDock_dockDock->setEnabled(false);
 			motTempDock->setEnabled(true);
 		}));
+		mainDockButtons.push_back(new ButtonGui(new Rectangle(360, 10, 80, 20, color(0, 100, 100), color(50, 50, 50), 2), "Timing", white, [] {
+			mainDockDisable(4);
+			mainDockButtons[4]->enable();
+			mainDock_dockDock->setEnabled(false);
+			timingDock->setEnabled(true);
+		}));
 
 		// Auton Dock buttons
 		autonDockButtons = {};
@@ -556,6 +565,12 @@ namespace {
 			drawTemperature();
 			drawMotorPower();
 		});
+
+		// Timing Dock
+		timingDock = new DockGui(0, 20, 480, 220, {}, {});
+		timingDock->addFunction([] {
+			drawTiming();
+		});
 	}
 
 	/// @brief Set the GUI variables corresponding to each dock.
@@ -564,8 +579,8 @@ namespace {
 		for (GuiClass *gui : mainDockButtons) {
 			mainDock->addGui(gui);
 		}
-		mainDock->addGuis({autonDock, simulationDock, qrCodeDock, motTempDock});
-		mainDock_dockDock->addGuis({autonDock, simulationDock, qrCodeDock, motTempDock});
+		mainDock->addGuis({autonDock, simulationDock, qrCodeDock, motTempDock, timingDock});
+		mainDock_dockDock->addGuis({autonDock, simulationDock, qrCodeDock, motTempDock, timingDock});
 
 		// Auton Dock
 		for (GuiClass *gui : autonDockButtons) {
@@ -590,6 +605,7 @@ namespace {
 		autonSubdock3->setEnabled(false);
 		qrCodeDock->setEnabled(false);
 		motTempDock->setEnabled(false);
+		timingDock->setEnabled(false);
 	}
 
 	/// @brief Set the value of the qr codes
@@ -764,4 +780,37 @@ namespace {
 		Brain.Screen.setFillColor(color::transparent);
 		Brain.Screen.printAt(10, 35, 1, "%07.3f", getRobotPolarAngle_degrees());
 	}
+	void drawTiming() {
+		Brain.Screen.setPenColor(color::white);
+		Brain.Screen.setFillColor(color::transparent);
+		Brain.Screen.setFont(fontType::mono15);
+		Brain.Screen.printAt(10, 40, 1, "Probe (us)    min    mean     max   histogram");
+
+		for (int i = 0; i < timing::probeCount; i++) {
+			const timing::ProbeStats &stats = timing::getProbeStats(i);
+			int rowY = 65 + i * 30;
+
+			// Summary
+			Brain.Screen.setPenColor(color::white);
+			Brain.Screen.setFillColor(color::transparent);
+			Brain.Screen.printAt(10, rowY, 1, "%-11s %5lu %7.1f %7lu",
+				timing::getProbeName(i), (unsigned long) stats.min_microseconds, timing::getMean_microseconds(i), (unsigned long) stats.max_microseconds
+			);
+
+			// Histogram, bar heights relative to the largest bucket
+			uint32_t maxBucketCount = 1;
+			for (int j = 0; j < timing::bucketCount; j++) {
+				maxBucketCount = (stats.bucketCounts[j] > maxBucketCount) ? stats.bucketCounts[j] : maxBucketCount;
+			}
+			Brain.Screen.setPenWidth(0);
+			for (int j = 0; j < timing::bucketCount; j++) {
+				int barHeight = (int) (20.0 * stats.bucketCounts[j] / maxBucketCount);
+				Brain.Screen.setFillColor(color(50, 50, 50));
+				Brain.Screen.drawRectangle(340 + j * 16, rowY - 20, 14, 20 - barHeight);
+				Brain.Screen.setFillColor(color(0, 200, 200));
+				Brain.Screen.drawRectangle(340 + j * 16, rowY - barHeight, 14, barHeight);
+			}
+		}
+		Brain.Screen.setFont(fontType::mono20);
+	}
 }
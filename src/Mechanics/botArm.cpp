@@ -2,6 +2,9 @@
 #include "AutonUtilities/patienceController.h"
 #include "Mechanics/botArm.h"
 #include "Utilities/generalUtility.h"
+#include "Utilities/timingProbe.h"
+#include "Utilities/virtualClock.h"
+#include "Utilities/dispatcher.h"
 #include "main.h"
 
 namespace {
@@ -15,7 +18,8 @@ namespace {
 	void spinArmMotor(double velocityPct);
 
 	// Stage controllers
-	PIDController armPositionPid(1.3, 0, 0.15);
+	PIDControllerCore<pidfeature::DerivativeFilter> armPositionPid(1.3, 0, 0.15);
+	const double armDerivativeFilter_seconds = 0.04;
 	PatienceController armUpPatience(6, 1.0, true, 5);
 	PatienceController armDownPatience(6, 1.0, false, 5);
 
@@ -40,29 +44,32 @@ namespace {
 	bool useDirection = false;
 
 	bool controlState = true;
+
+	// Pending delayed sets
+	int targetAngleHandle = -1;
 }
 
 namespace botarm {
-	void runThread() {
-		while (true) {
-			// Thread code here
-			if (useDirection) {
-				resolveArmDirection();
-			} else {
-				// printf("st: %d, armvolt: %.3f\n", currentArmStage, ArmMotor.voltage(volt));
-				// printf("arm torque: %.3f Nm\n", ArmMotor.torque());
-				resolveArmDegrees();
-			}
-
-			wait(20, msec);
+	/// @brief Updates the arm once. Called every 20 ms by the scheduler.
+	void runFrame() {
+		if (useDirection) {
+			resolveArmDirection();
+		} else {
+			// printf("st: %d, armvolt: %.3f\n", currentArmStage, ArmMotor.voltage(volt));
+			// printf("arm torque: %.3f Nm\n", ArmMotor.torque());
+			resolveArmDegrees();
 		}
 	}
 
 	void preauton() {
 		ArmMotor.setPosition(0, degrees);
+		armPositionPid.setDerivativeFilter(armDerivativeFilter_seconds);
 	}
 
 	void setTargetAngle(double state, double delaySec) {
+		// Replace an earlier delayed set
+		dispatcher::cancel(targetAngleHandle);
+
 		// Check for instant set
 		if (delaySec <= 1e-9) {
 			// Set state here
@@ -72,24 +79,12 @@ namespace botarm {
 			return;
 		}
 
-		// Set global variables
-		_taskState = state;
-		_taskDelay = delaySec;
-
-		task setTargetAngle([]() -> int {
-			// Get global variables
-			int taskState = _taskState;
-			double taskDelay = _taskDelay;
-
-			// Delay setting state
-			task::sleep(taskDelay * 1000);
-
+		// Set state after the delay
+		targetAngleHandle = dispatcher::schedule(delaySec, [](double taskState) {
 			// Set state here
 			armPositionPid.setErrorI(0);
 			armStateTargetAngle_degrees = taskState;
-
-			return 1;
-		});
+		}, state);
 	}
 
 	void setArmStage(int stageId, double delaySec) {
@@ -137,7 +132,7 @@ namespace botarm {
 
 		// Spin downward until exhausted
 		setArmStage(1);
-		waitUntil(armDownPatience.isExhausted());
+		clockWaitUntil(armDownPatience.isExhausted());
 
 		// Set the position as 0 degrees
 		setArmPosition(0);
@@ -169,9 +164,6 @@ namespace botarm {
 	bool canControl() {
 		return controlState;
 	}
-
-	double _taskState;
-	double _taskDelay;
 }
 
 namespace {
@@ -218,6 +210,8 @@ namespace {
 	}
 
 	void resolveArmDegrees() {
+		timing::ScopedProbe probe(timing::ArmResolve);
+
 		// Extreme case
 		if (isExtreme()) {
 			resolveArmExtreme();
@@ -1,8 +1,11 @@
 #include "Mechanics/botDrive.h"
+#include "Mechanics/drivePipeline.h"
 
 #include "Autonomous/autonValues.h"
 #include "AutonUtilities/pidController.h"
 
+#include "Simulation/robotSimulator.h"
+
 #include "Utilities/robotInfo.h"
 #include "Utilities/debugFunctions.h"
 #include "Utilities/generalUtility.h"
@@ -21,7 +24,7 @@ namespace {
 
 	// Resolve
 	void resolveDriveVelocity();
-	void _differentialDriveAtVelocity(double leftVelocity_pct, double rightVelocity_pct);
+	void _differentialDriveAtVelocity(double leftVelocity_pct, double rightVelocity_pct, double leftAcceleration_tilesPerSecondSquared = 0, double rightAcceleration_tilesPerSecondSquared = 0);
 	void _differentialDriveAtVolt(double leftVelocity_volt, double rightVelocity_volt);
 
 	// Drive mode
@@ -34,24 +37,25 @@ namespace {
 
 	// Driving velocity
 	double _linearVelocity_pct, _angularVelocity_radPerSecond;
+	double _linearAcceleration_tilesPerSecondSquared = 0, _angularAcceleration_radPerSecondSquared = 0;
 
-	// Velocity controller
-	const double kP = 0.10;
-	PIDController driveVelocityLeftMotorPID(kP), driveVelocityRightMotorPID(kP);
+	// Velocity controller, feedforward with light feedback (volts per tiles per second)
+	const double kP = 1.0;
+	PIDControllerCore<pidfeature::Feedforward> driveVelocityLeftMotorPID(kP), driveVelocityRightMotorPID(kP);
 }
 
 namespace botdrive {
-	void runThread() {
-		while (true) {
-			if (driveUseThread) {
-				resolveDriveVelocity();
-			}
-
-			wait(20, msec);
+	/// @brief Updates the drive velocity controller once. Called every 20 ms by the scheduler.
+	void runFrame() {
+		if (driveUseThread) {
+			resolveDriveVelocity();
 		}
 	}
 
 	void preauton() {
+		driveVelocityLeftMotorPID.setFeedforward(driveLeftKs_volt, driveLeftKv_voltPerTilesPerSecond, driveLeftKa_voltPerTilesPerSecondSquared);
+		driveVelocityRightMotorPID.setFeedforward(driveRightKs_volt, driveRightKv_voltPerTilesPerSecond, driveRightKa_voltPerTilesPerSecondSquared);
+
 		// LeftMotors.setStopping(coast);
 		// RightMotors.setStopping(coast);
 		LeftMotors.setStopping(brake);
@@ -105,6 +109,18 @@ namespace botdrive {
 	void driveLinegularVelocity(double linearVelocity_pct, double angularVelocity_radPerSecond) {
 		_linearVelocity_pct = linearVelocity_pct;
 		_angularVelocity_radPerSecond = angularVelocity_radPerSecond;
+		_linearAcceleration_tilesPerSecondSquared = _angularAcceleration_radPerSecondSquared = 0;
+		resolveDriveVelocity();
+	}
+
+	void driveLinegularMotion(
+		double linearVelocity_tilesPerSecond, double angularVelocity_radPerSecond,
+		double linearAcceleration_tilesPerSecondSquared, double angularAcceleration_radPerSecondSquared
+	) {
+		_linearVelocity_pct = linearVelocity_tilesPerSecond * autonvals::tilesPerSecond_to_pct;
+		_angularVelocity_radPerSecond = angularVelocity_radPerSecond;
+		_linearAcceleration_tilesPerSecondSquared = linearAcceleration_tilesPerSecondSquared;
+		_angularAcceleration_radPerSecondSquared = angularAcceleration_radPerSecondSquared;
 		resolveDriveVelocity();
 	}
 
@@ -112,25 +128,17 @@ namespace botdrive {
 		_linearVelocity_pct = (leftVelocityPct + rightVelocityPct) / 2.0;
 		double angularVelocity_tilesPerSecond = (rightVelocityPct - leftVelocityPct) / 2.0 / autonvals::tilesPerSecond_to_pct;
 		_angularVelocity_radPerSecond = angularVelocity_tilesPerSecond / (botinfo::halfRobotLengthIn * (1.0 / field::tileLengthIn));
+		_linearAcceleration_tilesPerSecondSquared = _angularAcceleration_radPerSecondSquared = 0;
 		resolveDriveVelocity();
 	}
 
 	void driveVoltage(double leftVoltageVolt, double rightVoltageVolt, double clampMaxVoltage) {
-		// Preprocess config
-		double maxVoltage = 12.0;
-		clampMaxVoltage = fabs(clampMaxVoltage);
-
-		// Scale voltages if overshoot
-		double scaleFactor = genutil::getScaleFactor(maxVoltage, {leftVoltageVolt, rightVoltageVolt});
-		leftVoltageVolt *= scaleFactor;
-		rightVoltageVolt *= scaleFactor;
-
-		// Clamp
-		leftVoltageVolt = genutil::clamp(leftVoltageVolt, -clampMaxVoltage, clampMaxVoltage);
-		rightVoltageVolt = genutil::clamp(rightVoltageVolt, -clampMaxVoltage, clampMaxVoltage);
+		// Desaturated by the pipeline
+		drivepipeline::submitVoltage(leftVoltageVolt, rightVoltageVolt, clampMaxVoltage);
+	}
 
-		// Drive
-		_differentialDriveAtVolt(leftVoltageVolt, rightVoltageVolt);
+	void stopDrive(brakeType mode) {
+		drivepipeline::submitStop(mode);
 	}
 }
 
@@ -169,9 +177,9 @@ namespace {
 		double rightPct = initRightPct + rightPolarRotatePct;
 
 		if (true) {
-			// Drive
+			// Drive, slew limited for the driver
 			// botdrive::driveVelocity(leftPct, rightPct);
-			botdrive::driveVoltage(genutil::pctToVolt(leftPct), genutil::pctToVolt(rightPct), 12);
+			drivepipeline::submitVoltage(genutil::pctToVolt(leftPct), genutil::pctToVolt(rightPct), 12, true);
 		} else {
 			// Scale percentages if overshoot
 			double scaleFactor = genutil::getScaleFactor(maxDriveVelocityPct, {leftPct, rightPct});
@@ -197,57 +205,58 @@ namespace {
 	void resolveDriveVelocity() {
 		// Differential drive
 
-		// Convert angular velocity to wheel's linear velocity
-		double rotationLinearVelocity_tilesPerSecond = _angularVelocity_radPerSecond * botinfo::halfRobotLengthIn * (1.0 / field::tileLengthIn);
+		// Convert angular motion to wheel's linear motion
+		double halfRobotLength_tiles = botinfo::halfRobotLengthIn * (1.0 / field::tileLengthIn);
+		double rotationLinearVelocity_tilesPerSecond = _angularVelocity_radPerSecond * halfRobotLength_tiles;
 		double rotationLinearVelocity_pct = rotationLinearVelocity_tilesPerSecond * autonvals::tilesPerSecond_to_pct;
+		double rotationLinearAcceleration_tilesPerSecondSquared = _angularAcceleration_radPerSecondSquared * halfRobotLength_tiles;
 
-		// Compute differential velocity
+		// Compute differential motion
 		double leftVelocity_pct = _linearVelocity_pct - rotationLinearVelocity_pct;
 		double rightVelocity_pct = _linearVelocity_pct + rotationLinearVelocity_pct;
+		double leftAcceleration_tilesPerSecondSquared = _linearAcceleration_tilesPerSecondSquared - rotationLinearAcceleration_tilesPerSecondSquared;
+		double rightAcceleration_tilesPerSecondSquared = _linearAcceleration_tilesPerSecondSquared + rotationLinearAcceleration_tilesPerSecondSquared;
 
 		// Drive at velocity
-		_differentialDriveAtVelocity(leftVelocity_pct, rightVelocity_pct);
+		_differentialDriveAtVelocity(leftVelocity_pct, rightVelocity_pct, leftAcceleration_tilesPerSecondSquared, rightAcceleration_tilesPerSecondSquared);
 	}
 
-	void _differentialDriveAtVelocity(double leftVelocity_pct, double rightVelocity_pct) {
-		// Scale percentages if overshoot
-		double scaleFactor = genutil::getScaleFactor(100.0, {leftVelocity_pct, rightVelocity_pct});
-		leftVelocity_pct *= scaleFactor;
-		rightVelocity_pct *= scaleFactor;
-
-		if (false) {
-			// Calculate velocity errors
-			double leftVelocity_error = leftVelocity_pct - LeftMotors.velocity(pct);
-			double rightVelocity_error = rightVelocity_pct - RightMotors.velocity(pct);
-
-			// Compute needed voltage to maintain velocity
-			driveVelocityLeftMotorPID.computeFromError(leftVelocity_error);
-			driveVelocityRightMotorPID.computeFromError(rightVelocity_error);
-			double leftDeltaVolt = driveVelocityLeftMotorPID.getValue();
-			double rightDeltaVolt = driveVelocityRightMotorPID.getValue();
-
-			// Compute final voltage
-			double leftVelocity_volt = LeftMotors.voltage(volt) + leftDeltaVolt;
-			double rightVelocity_volt = RightMotors.voltage(volt) + rightDeltaVolt;
-
-			// Drive at volt
-			botdrive::driveVoltage(leftVelocity_volt, rightVelocity_volt, 11);
-			printf("Err: %.3f, %.3f, Lvolt: %.3f, Rvolt: %.3f\n", leftVelocity_error, rightVelocity_error, leftVelocity_volt, rightVelocity_volt);
-		} else {
-			// Spin motors
-			LeftMotors.spin(fwd, leftVelocity_pct, pct);
-			RightMotors.spin(fwd, rightVelocity_pct, pct);
+	void _differentialDriveAtVelocity(double leftVelocity_pct, double rightVelocity_pct, double leftAcceleration_tilesPerSecondSquared, double rightAcceleration_tilesPerSecondSquared) {
+		// Hold still when stopped
+		bool isStopped = (
+			leftVelocity_pct == 0 && rightVelocity_pct == 0
+			&& leftAcceleration_tilesPerSecondSquared == 0 && rightAcceleration_tilesPerSecondSquared == 0
+		);
+		if (isStopped) {
+			driveVelocityLeftMotorPID.resetErrorToZero();
+			driveVelocityRightMotorPID.resetErrorToZero();
+			drivepipeline::submitStop(brake);
+			return;
 		}
+
+		// Convert to physical units
+		double leftVelocity_tilesPerSecond = leftVelocity_pct / autonvals::tilesPerSecond_to_pct;
+		double rightVelocity_tilesPerSecond = rightVelocity_pct / autonvals::tilesPerSecond_to_pct;
+
+		// Calculate velocity errors
+		double leftMeasured_pct = mainUseSimulator ? robotSimulator.driveModel.getLeftMotorVelocity_pct() : LeftMotors.velocity(pct);
+		double rightMeasured_pct = mainUseSimulator ? robotSimulator.driveModel.getRightMotorVelocity_pct() : RightMotors.velocity(pct);
+		double leftVelocity_error = leftVelocity_tilesPerSecond - leftMeasured_pct / autonvals::tilesPerSecond_to_pct;
+		double rightVelocity_error = rightVelocity_tilesPerSecond - rightMeasured_pct / autonvals::tilesPerSecond_to_pct;
+
+		// Compute needed voltage from feedforward and feedback
+		driveVelocityLeftMotorPID.setFeedforwardReference(leftVelocity_tilesPerSecond, leftAcceleration_tilesPerSecondSquared);
+		driveVelocityRightMotorPID.setFeedforwardReference(rightVelocity_tilesPerSecond, rightAcceleration_tilesPerSecondSquared);
+		driveVelocityLeftMotorPID.computeFromError(leftVelocity_error);
+		driveVelocityRightMotorPID.computeFromError(rightVelocity_error);
+		double leftVelocity_volt = driveVelocityLeftMotorPID.getValue();
+		double rightVelocity_volt = driveVelocityRightMotorPID.getValue();
+
+		// Drive at volt, desaturated by the pipeline
+		_differentialDriveAtVolt(leftVelocity_volt, rightVelocity_volt);
 	}
 
 	void _differentialDriveAtVolt(double leftVelocity_volt, double rightVelocity_volt) {
-		// Scale voltages if overshoot
-		double scaleFactor = genutil::getScaleFactor(12, {leftVelocity_volt, rightVelocity_volt});
-		leftVelocity_volt *= scaleFactor;
-		rightVelocity_volt *= scaleFactor;
-
-		// Spin
-		LeftMotors.spin(fwd, leftVelocity_volt, volt);
-		RightMotors.spin(fwd, rightVelocity_volt, volt);
+		drivepipeline::submitVoltage(leftVelocity_volt, rightVelocity_volt);
 	}
 }
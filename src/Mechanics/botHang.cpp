@@ -1,8 +1,17 @@
 #include "Mechanics/botHang.h"
+#include "Utilities/dispatcher.h"
 #include "main.h"
 
+namespace {
+	// Pending delayed sets
+	int stateHandle = -1;
+}
+
 namespace bothang {
 	void setState(bool state, double delaySec) {
+		// Replace an earlier delayed set
+		dispatcher::cancel(stateHandle);
+
 		// Check for instant set
 		if (delaySec <= 1e-9) {
 			// Set state here
@@ -11,23 +20,11 @@ namespace bothang {
 			return;
 		}
 
-		// Set global variables
-		_taskState = state;
-		_taskDelay = delaySec;
-
-		task setState([]() -> int {
-			// Get global variables
-			int taskState = _taskState;
-			double taskDelay = _taskDelay;
-
-			// Delay setting state
-			task::sleep(taskDelay * 1000);
-
+		// Set state after the delay
+		stateHandle = dispatcher::schedule(delaySec, [](double taskState) {
 			// Set state here
 			HangPneumatic.set(taskState);
-
-			return 1;
-		});
+		}, state);
 	}
 
 	void switchState() {
@@ -3,6 +3,9 @@
 #include "Mechanics/redirect.h"
 #include "Utilities/debugFunctions.h"
 #include "Utilities/generalUtility.h"
+#include "Utilities/timingProbe.h"
+#include "Utilities/virtualClock.h"
+#include "Utilities/dispatcher.h"
 #include "main.h"
 
 // This mechanic is for one-part intake with two motors
@@ -28,101 +31,133 @@ namespace {
 
 	bool isStoringRing = false;
 
+	// Non-blocking delays of the intake loop
+	vclock::Timer stuckTime;
+	bool isStuck = false;
+
+	const double stuckReverseDuration_seconds = 0.3;
+	vclock::Timer stuckReverseTimer;
+	bool isReversingStuck = false;
+
+	const double storeRingStopDelay_seconds = 0.01;
+	vclock::Timer storeRingStopTimer;
+	bool isStoringRingStopping = false;
+
 	// Reverse intake loop
 	const int reverseIntakeThreshold = 100;
 	const int reverseIntakeFor = 10;
 	int reverseIntakeCalls = 0;
 
 	bool controlState = true;
+
+	// Pending delayed sets
+	int stateHandle = -1;
+	int colorFilteringHandle = -1;
+	int intakeStoreRingHandle = -1;
 }
 
 
 namespace botintake {
-	void runThread() {
-		timer stuckTime;
-		bool isStuck = false;
-		while (true) {
-			// Update ring detected
-			previousRingDetected = ringDetected;
-			double detectedDistance = RingDistanceSensor.objectDistance(distanceUnits::mm);
-			if (detectedDistance <= 80.0) {
-				ringDetected = true;
+	/// @brief Updates the intake once. Called every 5 ms by the scheduler.
+	void runFrame() {
+		timing::ScopedProbe probe(timing::IntakeFrame);
+
+		// Update ring detected
+		previousRingDetected = ringDetected;
+		double detectedDistance = RingDistanceSensor.objectDistance(distanceUnits::mm);
+		if (detectedDistance <= 80.0) {
+			ringDetected = true;
+		} else {
+			ringDetected = false;
+		}
+
+		// Update detecting ring
+		isDetectingRing = RingOpticalSensor.isNearObject();
+		if (isDetectingRing) {
+			// Update detected ring color
+			if (RingOpticalSensor.hue() <= 20 || RingOpticalSensor.hue() >= 340) {
+				detectedRingColor = "red";
+				// debug::printOnController("Red ring");
+			} else if (180 <= RingOpticalSensor.hue() && RingOpticalSensor.hue() <= 230) {
+				detectedRingColor = "blue";
+				// debug::printOnController("Blue ring");
 			} else {
-				ringDetected = false;
+				detectedRingColor = "none";
+				// debug::printOnController("No ring");
 			}
+		}
 
-			// Update detecting ring
-			isDetectingRing = RingOpticalSensor.isNearObject();
-			if (isDetectingRing) {
-				// Update detected ring color
-				if (RingOpticalSensor.hue() <= 20 || RingOpticalSensor.hue() >= 340) {
-					detectedRingColor = "red";
-					// debug::printOnController("Red ring");
-				} else if (180 <= RingOpticalSensor.hue() && RingOpticalSensor.hue() <= 230) {
-					detectedRingColor = "blue";
-					// debug::printOnController("Blue ring");
-				} else {
-					detectedRingColor = "none";
-					// debug::printOnController("No ring");
-				}
+		/* Intake loop */
+
+		// Hold the stuck reversal
+		if (isReversingStuck) {
+			if (stuckReverseTimer.value() < stuckReverseDuration_seconds) {
+				return;
 			}
+			isReversingStuck = false;
+		}
 
-			/* Intake loop */
+		// Finish storing ring
+		if (isStoringRingStopping) {
+			if (storeRingStopTimer.value() < storeRingStopDelay_seconds) {
+				return;
+			}
+			isStoringRingStopping = false;
+			resolveState = 0;
+			isStoringRing = false;
+		}
 
-			if (!isStoringRing) {
-				/* Normal intake */
+		if (!isStoringRing) {
+			/* Normal intake */
 
-				// Detect stuck
-				if (IntakeMotor2.torque() > 0.41) {
-					if (!isStuck) {
-						stuckTime.clear();
-						isStuck = true;
-					}
-				} else {
-					isStuck = false;
+			// Detect stuck
+			if (IntakeMotor2.torque() > 0.41) {
+				if (!isStuck) {
+					stuckTime.clear();
+					isStuck = true;
 				}
-				// Override stuck
+			} else {
 				isStuck = false;
-
-				// Check reverse intake
-				bool reverseIntake = false;
-				reverseIntakeCalls++;
-				if (reverseIntakeCalls > reverseIntakeThreshold) {
-					reverseIntake = true;
-					if (reverseIntakeCalls - reverseIntakeThreshold > reverseIntakeFor) {
-						reverseIntakeCalls = 0;
-					}
-				}
-				// Override reverse
-				reverseIntake = false;
-
-				if (isStuck && stuckTime.value() > 0.08) {
-					// Reverse on stuck
-					resolveState = -1;
-					resolveIntake();
-					task::sleep(300);
-				} else if (reverseIntake) {
-					resolveState = -1;
-					resolveIntake();
-				} else {
-					resolveIntake();
+			}
+			// Override stuck
+			isStuck = false;
+
+			// Check reverse intake
+			bool reverseIntake = false;
+			reverseIntakeCalls++;
+			if (reverseIntakeCalls > reverseIntakeThreshold) {
+				reverseIntake = true;
+				if (reverseIntakeCalls - reverseIntakeThreshold > reverseIntakeFor) {
+					reverseIntakeCalls = 0;
 				}
-			} else {
-				/* Store ring */
+			}
+			// Override reverse
+			reverseIntake = false;
 
-				resolveState = 1;
+			if (isStuck && stuckTime.value() > 0.08) {
+				// Reverse on stuck
+				resolveState = -1;
+				resolveIntake();
+				isReversingStuck = true;
+				stuckReverseTimer.clear();
+			} else if (reverseIntake) {
+				resolveState = -1;
 				resolveIntake();
+			} else {
+				resolveIntake();
+			}
+		} else {
+			/* Store ring */
 
-				if (isDetectingRing && detectedRingColor != "none") {
-					if (detectedRingColor != filterOutColor || !colorFilterEnabled) {
-						wait(10, msec);
-						resolveState = 0;
-						isStoringRing = false;
-					}
+			resolveState = 1;
+			resolveIntake();
+
+			if (isDetectingRing && detectedRingColor != "none") {
+				if (detectedRingColor != filterOutColor || !colorFilterEnabled) {
+					isStoringRingStopping = true;
+					storeRingStopTimer.clear();
 				}
 			}
-
-			wait(5, msec);
 		}
 	}
 
@@ -140,6 +175,9 @@ namespace botintake {
 	}
 
 	void setState(int state, double delaySec) {
+		// Replace an earlier delayed set
+		dispatcher::cancel(stateHandle);
+
 		// Check for instant set
 		if (delaySec <= 1e-9) {
 			// Set state here
@@ -148,23 +186,11 @@ namespace botintake {
 			return;
 		}
 
-		// Set global variables
-		_taskState = state;
-		_taskDelay = delaySec;
-
-		task setState([]() -> int {
-			// Get global variables
-			int taskState = _taskState;
-			double taskDelay = _taskDelay;
-
-			// Delay setting state
-			task::sleep(taskDelay * 1000);
-
+		// Set state after the delay
+		stateHandle = dispatcher::schedule(delaySec, [](double taskState) {
 			// Set state here
 			resolveState = taskState;
-
-			return 1;
-		});
+		}, state);
 	}
 
 	bool isColorFiltering() {
@@ -172,6 +198,9 @@ namespace botintake {
 	}
 
 	void setColorFiltering(bool state, double delaySec) {
+		// Replace an earlier delayed set
+		dispatcher::cancel(colorFilteringHandle);
+
 		// Check for instant set
 		if (delaySec <= 1e-9) {
 			// Set state here
@@ -180,23 +209,11 @@ namespace botintake {
 			return;
 		}
 
-		// Set global variables
-		_colorFilterTaskState = state;
-		_colorFilterTaskDelay = delaySec;
-
-		task setState([]() -> int {
-			// Get global variables
-			int taskState = _colorFilterTaskState;
-			double taskDelay = _colorFilterTaskDelay;
-
-			// Delay setting state
-			task::sleep(taskDelay * 1000);
-
+		// Set state after the delay
+		colorFilteringHandle = dispatcher::schedule(delaySec, [](double taskState) {
 			// Set state here
 			colorFilterEnabled = taskState;
-
-			return 1;
-		});
+		}, state);
 	}
 
 	void switchFilterColor() {
@@ -215,6 +232,9 @@ namespace botintake {
 	}
 
 	void setIntakeStoreRing(bool state, double delaySec) {
+		// Replace an earlier delayed set
+		dispatcher::cancel(intakeStoreRingHandle);
+
 		// Check for instant set
 		if (delaySec <= 1e-9) {
 			// Set state here
@@ -223,23 +243,11 @@ namespace botintake {
 			return;
 		}
 
-		// Set global variables
-		_storeRingTaskState = state;
-		_storeRingTaskDelay = delaySec;
-
-		task setState([]() -> int {
-			// Get global variables
-			int taskState = _storeRingTaskState;
-			double taskDelay = _storeRingTaskDelay;
-
-			// Delay setting state
-			task::sleep(taskDelay * 1000);
-
+		// Set state after the delay
+		intakeStoreRingHandle = dispatcher::schedule(delaySec, [](double taskState) {
 			// Set state here
 			isStoringRing = taskState;
-
-			return 1;
-		});
+		}, state);
 	}
 
 	void control(int state, int hookState) {
@@ -253,16 +261,6 @@ namespace botintake {
 	bool canControl() {
 		return controlState;
 	}
-
-
-	int _taskState;
-	double _taskDelay;
-
-	bool _colorFilterTaskState;
-	double _colorFilterTaskDelay;
-
-	bool _storeRingTaskState;
-	double _storeRingTaskDelay;
 }
 
 
@@ -1,6 +1,9 @@
 #include "Mechanics/botIntake2.h"
 #include "Utilities/debugFunctions.h"
 #include "Utilities/generalUtility.h"
+#include "Utilities/timingProbe.h"
+#include "Utilities/virtualClock.h"
+#include "Utilities/dispatcher.h"
 #include "main.h"
 
 // This mechanic is for two-part intakes: roller + hook
@@ -8,6 +11,7 @@
 namespace {
 	void resolveIntake();
 	void resolveIntakeToArm();
+	bool stepHookSequence();
 
 	double intakeVelocityPct = 100;
 
@@ -34,57 +38,95 @@ namespace {
 	std::string filterOutColor = "none";
 	std::string detectedRingColor;
 
+	// Non-blocking delays of the intake loop
+	vclock::Timer stuckTime;
+	bool isStuck = false;
+
+	const double stuckReverseDuration_seconds = 0.3;
+	vclock::Timer stuckReverseTimer;
+	bool isReversingStuck = false;
+
+	// Hook sequences after a ring passes the sensor
+	enum HookSequence {
+		NoSequence,
+		FilterOut,
+		ToArm,
+	};
+	HookSequence hookSequence = NoSequence;
+	vclock::Timer hookSequenceTimer;
+
+	const double filterOutDelay_seconds = 0.04;
+	const double filterOutStopDuration_seconds = 0.3;
+	const double toArmReverseDuration_seconds = 0.3;
+	const double toArmStopDuration_seconds = 0.7;
+
 	bool controlState = true;
+
+	// Pending delayed sets
+	int stateHandle = -1;
+	int state2Handle = -1;
+	int state3Handle = -1;
 }
 
 
 namespace botintake2 {
-	void runThread() {
-		timer stuckTime;
-		bool isStuck = false;
-		while (true) {
-			// Update ring detected
-			previousRingDetected = ringDetected;
-			double detectedDistance = RingDistanceSensor.objectDistance(distanceUnits::mm);
-			if (detectedDistance <= 80.0) {
-				ringDetected = true;
-			} else {
-				ringDetected = false;
-			}
+	/// @brief Updates the intake once. Called every 5 ms by the scheduler.
+	void runFrame() {
+		timing::ScopedProbe probe(timing::IntakeFrame);
+
+		// Update ring detected
+		previousRingDetected = ringDetected;
+		double detectedDistance = RingDistanceSensor.objectDistance(distanceUnits::mm);
+		if (detectedDistance <= 80.0) {
+			ringDetected = true;
+		} else {
+			ringDetected = false;
+		}
+
+		// Update detected ring color
+		if (RingOpticalSensor.hue() <= 20 || RingOpticalSensor.hue() >= 340) {
+			detectedRingColor = "red";
+			// debug::printOnController("Red ring");
+		} else if (160 <= RingOpticalSensor.hue() && RingOpticalSensor.hue() <= 240) {
+			detectedRingColor = "blue";
+			// debug::printOnController("Blue ring");
+		}
 
-			// Update detected ring color
-			if (RingOpticalSensor.hue() <= 20 || RingOpticalSensor.hue() >= 340) {
-				detectedRingColor = "red";
-				// debug::printOnController("Red ring");
-			} else if (160 <= RingOpticalSensor.hue() && RingOpticalSensor.hue() <= 240) {
-				detectedRingColor = "blue";
-				// debug::printOnController("Blue ring");
+		// Hold the stuck reversal
+		if (isReversingStuck) {
+			if (stuckReverseTimer.value() < stuckReverseDuration_seconds) {
+				return;
 			}
+			isReversingStuck = false;
+		}
 
-			// Intake loop
-			if (hookMode == 0) {
-				// Normal intake
-				if (IntakeMotor2.torque() > 0.41) {
-					if (!isStuck) {
-						stuckTime.clear();
-						isStuck = true;
-					}
-				} else {
-					isStuck = false;
-				}
-				if (isStuck && stuckTime.value() > 0.08) {
-					resolveTopState = -1;
-					resolveIntake();
-					task::sleep(300);
-				} else {
-					resolveIntake();
+		// Hold the hook sequence
+		if (hookSequence != NoSequence && !stepHookSequence()) {
+			return;
+		}
+
+		// Intake loop
+		if (hookMode == 0) {
+			// Normal intake
+			if (IntakeMotor2.torque() > 0.41) {
+				if (!isStuck) {
+					stuckTime.clear();
+					isStuck = true;
 				}
-			} else if (hookMode == 1) {
-				// Intake to arm
-				resolveIntakeToArm();
+			} else {
+				isStuck = false;
 			}
-
-			task::sleep(5);
+			if (isStuck && stuckTime.value() > 0.08) {
+				resolveTopState = -1;
+				resolveIntake();
+				isReversingStuck = true;
+				stuckReverseTimer.clear();
+			} else {
+				resolveIntake();
+			}
+		} else if (hookMode == 1) {
+			// Intake to arm
+			resolveIntakeToArm();
 		}
 	}
 
@@ -94,6 +136,9 @@ namespace botintake2 {
 	}
 
 	void setState(int state, double delaySec) {
+		// Replace an earlier delayed set
+		dispatcher::cancel(stateHandle);
+
 		// Check for instant set
 		if (delaySec <= 1e-9) {
 			// Set state here
@@ -103,28 +148,19 @@ namespace botintake2 {
 			return;
 		}
 
-		// Set global variables
-		_taskState = state;
-		_taskDelay = delaySec;
-
-		task setState([]() -> int {
-			// Get global variables
-			int taskState = _taskState;
-			double taskDelay = _taskDelay;
-
-			// Delay setting state
-			task::sleep(taskDelay * 1000);
-
+		// Set state after the delay
+		stateHandle = dispatcher::schedule(delaySec, [](double taskState) {
 			// Set state here
 			resolveTopState = taskState;
 			resolveBottomState = taskState;
-
-			return 1;
-		});
+		}, state);
 	}
 
 
 	void setState2(int state, double delaySec) {
+		// Replace an earlier delayed set
+		dispatcher::cancel(state2Handle);
+
 		// Check for instant set
 		if (delaySec <= 1e-9) {
 			// Set state here
@@ -133,28 +169,19 @@ namespace botintake2 {
 			return;
 		}
 
-		// Set global variables
-		_taskState = state;
-		_taskDelay = delaySec;
-
-		task setState([]() -> int {
-			// Get global variables
-			int taskState = _taskState;
-			double taskDelay = _taskDelay;
-
-			// Delay setting state
-			task::sleep(taskDelay * 1000);
-
+		// Set state after the delay
+		state2Handle = dispatcher::schedule(delaySec, [](double taskState) {
 
 			// Set state here
 			resolveTopState = taskState;
-
-			return 1;
-		});
+		}, state);
 	}
 
 
 	void setState3(int state, double delaySec) {
+		// Replace an earlier delayed set
+		dispatcher::cancel(state3Handle);
+
 		// Check for instant set
 		if (delaySec <= 1e-9) {
 			// Set state here
@@ -163,23 +190,11 @@ namespace botintake2 {
 			return;
 		}
 
-		// Set global variables
-		_taskState = state;
-		_taskDelay = delaySec;
-
-		task setState([]() -> int {
-			// Get global variables
-			int taskState = _taskState;
-			double taskDelay = _taskDelay;
-
-			// Delay setting state
-			task::sleep(taskDelay * 1000);
-
+		// Set state after the delay
+		state3Handle = dispatcher::schedule(delaySec, [](double taskState) {
 			// Set state here
 			resolveBottomState = taskState;
-
-			return 1;
-		});
+		}, state);
 	}
 
 	void switchMode() {
@@ -226,10 +241,6 @@ namespace botintake2 {
 	bool canControl() {
 		return controlState;
 	}
-
-
-	int _taskState;
-	double _taskDelay;
 }
 
 
@@ -243,10 +254,9 @@ namespace {
 		// Filter out on some detection
 		if (previousRingDetected && !ringDetected) {
 			if (detectedRingColor == filterOutColor) {
-				// Filter out
-				wait(40, msec);
-				IntakeMotor2.spin(fwd, 0, volt);
-				wait(300, msec);
+				// Filter out, the hook stops once the ring has cleared
+				hookSequence = FilterOut;
+				hookSequenceTimer.clear();
 				return;
 			}
 		}
@@ -285,16 +295,10 @@ namespace {
 		if (previousRingDetected && !ringDetected) {
 			// IntakeMotor1.spin(fwd, 10, pct);
 
-			// Spin hook sequence
-			// wait(30, msec);
+			// Spin hook sequence, reversing then stopping
 			IntakeMotor2.spin(fwd, genutil::pctToVolt(-toArmHookReverseVelocityPct), volt);
-			wait(300, msec);
-			IntakeMotor2.spin(fwd, 0, volt);
-			wait(700, msec);
-
-			if (autoHookSwitchMode) {
-				hookMode = 0;
-			}
+			hookSequence = ToArm;
+			hookSequenceTimer.clear();
 		}
 		// Otherwise spin hook normally
 		else {
@@ -303,4 +307,38 @@ namespace {
 			IntakeMotor2.spin(fwd, genutil::pctToVolt(toArmHookVelocityPct), volt);
 		}
 	}
+
+	/// @brief Steps the running hook sequence. Returns true once it has finished.
+	bool stepHookSequence() {
+		double elapsed_seconds = hookSequenceTimer.value();
+		switch (hookSequence) {
+			case FilterOut:
+				// Keep spinning until the ring clears, then stop the hook
+				if (elapsed_seconds < filterOutDelay_seconds) {
+					return false;
+				}
+				if (elapsed_seconds < filterOutDelay_seconds + filterOutStopDuration_seconds) {
+					IntakeMotor2.spin(fwd, 0, volt);
+					return false;
+				}
+				break;
+			case ToArm:
+				// Reverse, then stop the hook
+				if (elapsed_seconds < toArmReverseDuration_seconds) {
+					return false;
+				}
+				if (elapsed_seconds < toArmReverseDuration_seconds + toArmStopDuration_seconds) {
+					IntakeMotor2.spin(fwd, 0, volt);
+					return false;
+				}
+				if (autoHookSwitchMode) {
+					hookMode = 0;
+				}
+				break;
+			default:
+				break;
+		}
+		hookSequence = NoSequence;
+		return true;
+	}
 }
@@ -0,0 +1,208 @@
+#include "Mechanics/drivePipeline.h"
+
+#include "Simulation/robotSimulator.h"
+
+#include "Utilities/generalUtility.h"
+#include "Utilities/virtualClock.h"
+
+#include "main.h"
+
+namespace {
+	using drivepipeline::Config;
+
+	// Default config, slew and jerk are loose enough for the driver to not notice
+	// Autonomous controllers shape their own commands, so they skip the limiter
+	Config pipelineConfig = {
+		120.0, // maxSlew_voltPerSecond
+		3000.0, // maxJerk_voltPerSecondSquared
+		drivepipeline::PreserveCurvature,
+		true, // compensateBattery
+		12.0, // nominalBattery_volt
+		0.01, // dedupeTolerance_volt
+	};
+
+	// State of one side's limiter
+	struct SideState {
+		double output_volt;
+		double rate_voltPerSecond;
+	};
+
+	SideState leftState = {0, 0}, rightState = {0, 0};
+	uint64_t lastSubmit_microseconds = 0;
+
+	// Battery, smoothed against current spikes
+	double filteredBattery_volt = -1;
+	const double batteryFilterGain = 0.05;
+
+	// Last command sent to the motors
+	bool hasSentVoltage = false;
+	double sentLeft_volt, sentRight_volt;
+	bool hasSentStop = false;
+	brakeType sentStopMode;
+
+	void desaturate(double &leftVoltage_volt, double &rightVoltage_volt, double maxVoltage_volt);
+	void limitSide(SideState &state, double targetVoltage_volt, double deltaTime_seconds);
+	double getBatteryVoltage();
+}
+
+namespace drivepipeline {
+	void setConfig(Config config) {
+		pipelineConfig = config;
+	}
+
+	Config getConfig() {
+		return pipelineConfig;
+	}
+
+	void submitVoltage(double leftVoltage_volt, double rightVoltage_volt, double clampMaxVoltage_volt, bool isSlewLimited) {
+		// Get elapsed time
+		uint64_t now_microseconds = vclock::getTime_microseconds();
+		double deltaTime_seconds = (lastSubmit_microseconds == 0) ? 0.010 : (now_microseconds - lastSubmit_microseconds) / 1e6;
+		deltaTime_seconds = genutil::clamp(deltaTime_seconds, 0.001, 0.050);
+		lastSubmit_microseconds = now_microseconds;
+
+		// Desaturate to the voltage the battery can supply
+		double batteryVoltage_volt = getBatteryVoltage();
+		double maxVoltage_volt = fmin(fabs(clampMaxVoltage_volt), 12.0);
+		if (pipelineConfig.compensateBattery) {
+			maxVoltage_volt = fmin(maxVoltage_volt, batteryVoltage_volt);
+		}
+		desaturate(leftVoltage_volt, rightVoltage_volt, maxVoltage_volt);
+
+		// Slew and jerk limit each side, or pass through
+		if (isSlewLimited) {
+			limitSide(leftState, leftVoltage_volt, deltaTime_seconds);
+			limitSide(rightState, rightVoltage_volt, deltaTime_seconds);
+		} else {
+			leftState = {leftVoltage_volt, 0};
+			rightState = {rightVoltage_volt, 0};
+		}
+
+		// Convert to motor commands, which are relative to a full battery
+		double leftCommand_volt = leftState.output_volt;
+		double rightCommand_volt = rightState.output_volt;
+		if (pipelineConfig.compensateBattery) {
+			double compensation = pipelineConfig.nominalBattery_volt / batteryVoltage_volt;
+			leftCommand_volt = genutil::clamp(leftCommand_volt * compensation, -12, 12);
+			rightCommand_volt = genutil::clamp(rightCommand_volt * compensation, -12, 12);
+		}
+
+		// Skip unchanged commands
+		bool isUnchanged = (
+			hasSentVoltage
+			&& fabs(leftCommand_volt - sentLeft_volt) < pipelineConfig.dedupeTolerance_volt
+			&& fabs(rightCommand_volt - sentRight_volt) < pipelineConfig.dedupeTolerance_volt
+		);
+		if (isUnchanged) {
+			return;
+		}
+
+		// Spin
+		if (mainUseSimulator) {
+			robotSimulator.driveModel.setVoltage(leftCommand_volt, rightCommand_volt);
+		} else {
+			LeftMotors.spin(fwd, leftCommand_volt, volt);
+			RightMotors.spin(fwd, rightCommand_volt, volt);
+		}
+		hasSentVoltage = true;
+		hasSentStop = false;
+		sentLeft_volt = leftCommand_volt;
+		sentRight_volt = rightCommand_volt;
+	}
+
+	void submitStop(brakeType mode) {
+		// Clear limiter, so the next command starts from rest
+		leftState = rightState = {0, 0};
+		lastSubmit_microseconds = 0;
+
+		// Skip repeated stops
+		if (hasSentStop && sentStopMode == mode) {
+			return;
+		}
+
+		// Stop
+		if (mainUseSimulator) {
+			robotSimulator.driveModel.stop(mode == coast);
+		} else {
+			LeftMotors.stop(mode);
+			RightMotors.stop(mode);
+		}
+		hasSentStop = true;
+		hasSentVoltage = false;
+		sentStopMode = mode;
+	}
+
+	void reset() {
+		leftState = rightState = {0, 0};
+		lastSubmit_microseconds = 0;
+		hasSentVoltage = hasSentStop = false;
+	}
+}
+
+namespace {
+	void desaturate(double &leftVoltage_volt, double &rightVoltage_volt, double maxVoltage_volt) {
+		// Check saturation
+		if (fmax(fabs(leftVoltage_volt), fabs(rightVoltage_volt)) <= maxVoltage_volt) {
+			return;
+		}
+
+		switch (pipelineConfig.priority) {
+			case drivepipeline::PreserveCurvature: {
+				double scaleFactor = genutil::getScaleFactor(maxVoltage_volt, {leftVoltage_volt, rightVoltage_volt});
+				leftVoltage_volt *= scaleFactor;
+				rightVoltage_volt *= scaleFactor;
+				break;
+			}
+			case drivepipeline::PreserveAngular: {
+				// Split into forward and turning parts
+				double linearVoltage_volt = (leftVoltage_volt + rightVoltage_volt) / 2.0;
+				double angularVoltage_volt = (rightVoltage_volt - leftVoltage_volt) / 2.0;
+
+				// Keep turning, give the remaining voltage to forward
+				angularVoltage_volt = genutil::clamp(angularVoltage_volt, -maxVoltage_volt, maxVoltage_volt);
+				double maxLinearVoltage_volt = maxVoltage_volt - fabs(angularVoltage_volt);
+				linearVoltage_volt = genutil::clamp(linearVoltage_volt, -maxLinearVoltage_volt, maxLinearVoltage_volt);
+
+				leftVoltage_volt = linearVoltage_volt - angularVoltage_volt;
+				rightVoltage_volt = linearVoltage_volt + angularVoltage_volt;
+				break;
+			}
+		}
+	}
+
+	/// @brief Moves a side's output toward the target with limited rate and rate change.
+	void limitSide(SideState &state, double targetVoltage_volt, double deltaTime_seconds) {
+		double error_volt = targetVoltage_volt - state.output_volt;
+		double maxJerk = pipelineConfig.maxJerk_voltPerSecondSquared;
+
+		// Fastest rate that can still ease into the target
+		// v = √(2 * j * e)
+		double desiredRate = fmin(pipelineConfig.maxSlew_voltPerSecond, sqrt(2 * maxJerk * fabs(error_volt)));
+		desiredRate = fmin(desiredRate, fabs(error_volt) / deltaTime_seconds);
+		desiredRate = (error_volt >= 0) ? desiredRate : -desiredRate;
+
+		// Limit the change of rate
+		double maxRateChange = maxJerk * deltaTime_seconds;
+		state.rate_voltPerSecond += genutil::clamp(desiredRate - state.rate_voltPerSecond, -maxRateChange, maxRateChange);
+		state.output_volt += state.rate_voltPerSecond * deltaTime_seconds;
+
+		// Don't pass the target
+		bool hasPassed = (error_volt >= 0) ? (state.output_volt > targetVoltage_volt) : (state.output_volt < targetVoltage_volt);
+		if (hasPassed) {
+			state.output_volt = targetVoltage_volt;
+			state.rate_voltPerSecond = 0;
+		}
+	}
+
+	double getBatteryVoltage() {
+		double reading_volt = mainUseSimulator ? robotSimulator.driveModel.getBatteryVoltage_volt() : Brain.Battery.voltage(volt);
+		if (reading_volt < 6) {
+			reading_volt = pipelineConfig.nominalBattery_volt;
+		}
+		if (filteredBattery_volt < 0) {
+			filteredBattery_volt = reading_volt;
+		}
+		filteredBattery_volt += batteryFilterGain * (reading_volt - filteredBattery_volt);
+		return filteredBattery_volt;
+	}
+}
@@ -1,8 +1,12 @@
 #include "Mechanics/goalClamp.h"
+#include "Utilities/dispatcher.h"
 #include "main.h"
 
 namespace {
 	bool controlState = true;
+
+	// Pending delayed sets
+	int stateHandle = -1;
 }
 
 namespace goalclamp {
@@ -19,6 +23,9 @@ namespace goalclamp {
 	}
 
 	void setState(int state, double delaySec) {
+		// Replace an earlier delayed set
+		dispatcher::cancel(stateHandle);
+
 		// Check for instant set
 		if (delaySec <= 1e-9) {
 			// Set state here
@@ -27,23 +34,11 @@ namespace goalclamp {
 			return;
 		}
 
-		// Set global variables
-		_taskState = state;
-		_taskDelay = delaySec;
-
-		task setState([]() -> int {
-			// Get global variables
-			int taskState = _taskState;
-			double taskDelay = _taskDelay;
-
-			// Delay setting state
-			task::sleep(taskDelay * 1000);
-
+		// Set state after the delay
+		stateHandle = dispatcher::schedule(delaySec, [](double taskState) {
 			// Set state here
 			GoalClampPneumatic.set(taskState);
-
-			return 1;
-		});
+		}, state);
 	}
 
 	void switchState() {
@@ -59,9 +54,6 @@ namespace goalclamp {
 	bool canControl() {
 		return controlState;
 	}
-
-	int _taskState;
-	double _taskDelay;
 }
 
 namespace {
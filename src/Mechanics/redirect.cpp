@@ -1,9 +1,13 @@
 #include "Mechanics/redirect.h"
 
+#include "Utilities/dispatcher.h"
 #include "main.h"
 
 namespace {
 bool controlState = true;
+
+	// Pending delayed sets
+	int stateHandle = -1;
 }
 
 namespace redirect {
@@ -22,6 +26,9 @@ namespace redirect {
 	}
 
 	void setState(int state, double delaySec) {
+		// Replace an earlier delayed set
+		dispatcher::cancel(stateHandle);
+
 		// Check for instant set
 		if (delaySec <= 1e-9) {
 			// Set state here
@@ -30,23 +37,11 @@ namespace redirect {
 			return;
 		}
 
-		// Set global variables
-		_taskState = state;
-		_taskDelay = delaySec;
-
-		task setState([]() -> int {
-			// Get global variables
-			int taskState = _taskState;
-			double taskDelay = _taskDelay;
-
-			// Delay setting state
-			task::sleep(taskDelay * 1000);
-
+		// Set state after the delay
+		stateHandle = dispatcher::schedule(delaySec, [](double taskState) {
 			// Set state here
 			RedirectPneumatics.set(taskState);
-
-			return 1;
-		});
+		}, state);
 	}
 
 	void switchState() { setState(!RedirectPneumatics.value()); }
@@ -58,9 +53,6 @@ namespace redirect {
 	}
 
 	bool canControl() { return controlState; }
-
-	int _taskState;
-	double _taskDelay;
 }  // namespace redirect
 
 namespace {}
@@ -1,8 +1,12 @@
 #include "Mechanics/sampleMechanics.h"
+#include "Utilities/dispatcher.h"
 #include "main.h"
 
 namespace {
 	bool controlState = true;
+
+	// Pending delayed sets
+	int stateHandle = -1;
 }
 
 namespace samplemech {
@@ -19,6 +23,9 @@ namespace samplemech {
 	}
 
 	void setState(int state, double delaySec) {
+		// Replace an earlier delayed set
+		dispatcher::cancel(stateHandle);
+
 		// Check for instant set
 		if (delaySec <= 1e-9) {
 			// Set state here
@@ -26,22 +33,10 @@ namespace samplemech {
 			return;
 		}
 
-		// Set global variables
-		_taskState = state;
-		_taskDelay = delaySec;
-
-		task setState([]() -> int {
-			// Get global variables
-			int taskState = _taskState;
-			double taskDelay = _taskDelay;
-
-			// Delay setting state
-			task::sleep(taskDelay * 1000);
-
+		// Set state after the delay
+		stateHandle = dispatcher::schedule(delaySec, [](double taskState) {
 			// Set state here
-
-			return 1;
-		});
+		}, state);
 	}
 
 	void switchState() {
@@ -57,9 +52,6 @@ namespace samplemech {
 	bool canControl() {
 		return controlState;
 	}
-
-	int _taskState;
-	double _taskDelay;
 }
 
 namespace {
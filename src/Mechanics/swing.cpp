@@ -1,8 +1,13 @@
 #include "Mechanics/swing.h"
+#include "Utilities/dispatcher.h"
 #include "main.h"
 
 namespace {
 	bool controlState = true;
+
+	// Pending delayed sets
+	int stateHandle = -1;
+	int secondStateHandle = -1;
 }
 
 namespace swing {
@@ -19,6 +24,9 @@ namespace swing {
 	}
 
 	void setState(int state, double delaySec) {
+		// Replace an earlier delayed set
+		dispatcher::cancel(stateHandle);
+
 		// Check for instant set
 		if (delaySec <= 1e-9) {
 			// Set state here
@@ -28,26 +36,17 @@ namespace swing {
 			return;
 		}
 
-		// Set global variables
-		_taskState = state;
-		_taskDelay = delaySec;
-
-		task setState([]() -> int {
-			// Get global variables
-			int taskState = _taskState;
-			double taskDelay = _taskDelay;
-
-			// Delay setting state
-			task::sleep(taskDelay * 1000);
-
+		// Set state after the delay
+		stateHandle = dispatcher::schedule(delaySec, [](double taskState) {
 			// Set state here
 			SwordPneumatics.set(taskState);
-
-			return 1;
-		});
+		}, state);
 	}
 
 	void set2ndState(int state, double delaySec) {
+		// Replace an earlier delayed set
+		dispatcher::cancel(secondStateHandle);
+
 		// Check for instant set
 		if (delaySec <= 1e-9) {
 			// Set state here
@@ -56,23 +55,11 @@ namespace swing {
 			return;
 		}
 
-		// Set global variables
-		_taskState = state;
-		_taskDelay = delaySec;
-
-		task setState([]() -> int {
-			// Get global variables
-			int taskState = _taskState;
-			double taskDelay = _taskDelay;
-
-			// Delay setting state
-			task::sleep(taskDelay * 1000);
-
+		// Set state after the delay
+		secondStateHandle = dispatcher::schedule(delaySec, [](double taskState) {
 			// Set state here
 			Sword2Pneumatics.set(taskState);
-
-			return 1;
-		});
+		}, state);
 	}
 
 	void switchState() {
@@ -92,9 +79,6 @@ namespace swing {
 	bool canControl() {
 		return controlState;
 	}
-
-	int _taskState;
-	double _taskDelay;
 }
 
 namespace {
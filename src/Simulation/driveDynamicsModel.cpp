@@ -0,0 +1,376 @@
+#include "Simulation/driveDynamicsModel.h"
+
+#include "Utilities/robotInfo.h"
+#include "Utilities/fieldInfo.h"
+
+#include <cmath>
+
+namespace {
+	const double inchesToMeters = 0.0254;
+	const double gravity_metersPerSecondSquared = 9.81;
+
+	// V5 motor, rated at 12 V
+	const double ratedVoltage_volt = 12.0;
+	const double stallTorqueAt100Rpm_newtonMeters = 2.1;
+
+	// Motor speed below which friction eases off instead of flipping sign
+	const double frictionSmoothingSpeed_radiansPerSecond = 0.5;
+
+	double clamp(double value, double minValue, double maxValue) {
+		return std::fmin(maxValue, std::fmax(minValue, value));
+	}
+
+	double sign(double value) {
+		return (value > 0) - (value < 0);
+	}
+}
+
+DriveDynamicsModel::Config DriveDynamicsModel::getDefaultConfig() {
+	Config config;
+
+	// Drivetrain
+	config.motorCountPerSide = 3;
+	config.motorFreeSpeed_rpm = botinfo::chassisMotorRpm;
+	config.motorStallTorque_newtonMeters = stallTorqueAt100Rpm_newtonMeters * (100.0 / botinfo::chassisMotorRpm);
+	config.motorCurrentLimit_amps = 2.5;
+	config.motorFrictionVoltage_volt = (botinfo::driveLeftKs_volt + botinfo::driveRightKs_volt) / 2;
+	config.wheelToMotorGearRatio = botinfo::driveWheelMotorGearRatio;
+	config.gearEfficiency = 0.9;
+	config.wheelDiameter_meters = botinfo::driveWheelDiameterIn * inchesToMeters;
+	config.trackWidth_meters = botinfo::robotLengthIn * inchesToMeters;
+	config.lookWheelDiameter_meters = botinfo::trackingLookWheelDiameterIn * inchesToMeters;
+	config.lateralWheelDiameter_meters = 2.75 * inchesToMeters;
+	config.lateralWheelBackOffset_meters = 3.5 * inchesToMeters;
+
+	// Battery
+	config.batteryOpenVoltage_volt = 12.8;
+	config.batteryResistance_ohms = 0.15;
+
+	// Chassis, sized by the feedforward's kA, the commanded volts per side for an acceleration
+	// At rest on a full battery, a side's force per commanded volt is
+	// n * (stall torque / rated voltage) * (battery / rated voltage) * gear ratio * efficiency / wheel radius
+	// kA = (M + 2m) / (2 * forcePerVolt), with m the rotating mass of each side
+	double tileLength_meters = field::tileLengthIn * inchesToMeters;
+	double ka_voltPerMetersPerSecondSquared = (botinfo::driveLeftKa_voltPerTilesPerSecondSquared + botinfo::driveRightKa_voltPerTilesPerSecondSquared) / 2 / tileLength_meters;
+	double forcePerVolt_newtons = (
+		config.motorCountPerSide * (config.motorStallTorque_newtonMeters / ratedVoltage_volt)
+		* (config.batteryOpenVoltage_volt / ratedVoltage_volt)
+		* config.wheelToMotorGearRatio * config.gearEfficiency / (config.wheelDiameter_meters / 2)
+	);
+	config.sideRotatingMass_kilograms = 0.3;
+	config.mass_kilograms = 2 * forcePerVolt_newtons * ka_voltPerMetersPerSecondSquared - 2 * config.sideRotatingMass_kilograms;
+
+	// Turning uses the same kA per side, which holds when I = M * (track / 2)²
+	config.momentOfInertia_kilogramMetersSquared = config.mass_kilograms * std::pow(config.trackWidth_meters / 2, 2);
+	config.tractionCoefficient = 1.0;
+
+	config.timeStep_seconds = 0.001;
+	return config;
+}
+
+DriveDynamicsModel::DriveDynamicsModel() {
+	// Config is read on the first use, as botinfo may not be initialized yet
+	isConfigured = false;
+	reset(0, 0, 0);
+}
+
+DriveDynamicsModel::DriveDynamicsModel(Config config) {
+	setConfig(config);
+	reset(0, 0, 0);
+}
+
+void DriveDynamicsModel::setConfig(Config config) {
+	this->config = config;
+	isConfigured = true;
+
+	// Motor line through the free speed and the current-limited stall
+	double freeSpeed_radiansPerSecond = config.motorFreeSpeed_rpm * (2 * M_PI / 60.0);
+	backEmf_voltSecondsPerRadian = ratedVoltage_volt / freeSpeed_radiansPerSecond;
+	torque_newtonMetersPerAmp = config.motorStallTorque_newtonMeters / config.motorCurrentLimit_amps;
+	resistance_ohms = ratedVoltage_volt / config.motorCurrentLimit_amps;
+}
+
+DriveDynamicsModel::Config DriveDynamicsModel::getConfig() {
+	_ensureConfig();
+	return config;
+}
+
+void DriveDynamicsModel::reset(double x_tiles, double y_tiles, double polarAngle_radians) {
+	setPose(x_tiles, y_tiles, polarAngle_radians);
+	linearVelocity_metersPerSecond = angularVelocity_radiansPerSecond = 0;
+	lookDistance_meters = 0;
+	lateralDistance_meters = 0;
+	turnedAngle_radians = 0;
+
+	leftSide = rightSide = {0, true, false, 0, 0, 0, 0, false};
+	batteryVoltage_volt = isConfigured ? config.batteryOpenVoltage_volt : 12.8;
+
+	elapsed_seconds = 0;
+	remainder_seconds = 0;
+}
+
+void DriveDynamicsModel::setPose(double x_tiles, double y_tiles, double polarAngle_radians) {
+	double tileLength_meters = field::tileLengthIn * inchesToMeters;
+	x_meters = x_tiles * tileLength_meters;
+	y_meters = y_tiles * tileLength_meters;
+	this->polarAngle_radians = polarAngle_radians;
+}
+
+void DriveDynamicsModel::setVoltage(double leftVoltage_volt, double rightVoltage_volt) {
+	leftSide.command_volt = leftVoltage_volt;
+	rightSide.command_volt = rightVoltage_volt;
+	leftSide.isStopped = rightSide.isStopped = false;
+}
+
+void DriveDynamicsModel::stop(bool isCoast) {
+	leftSide.command_volt = rightSide.command_volt = 0;
+	leftSide.isStopped = rightSide.isStopped = true;
+	leftSide.isCoast = rightSide.isCoast = isCoast;
+}
+
+void DriveDynamicsModel::advance(double deltaTime_seconds) {
+	_ensureConfig();
+	// Tolerate rounding, so a frame of whole steps doesn't lose one
+	remainder_seconds += deltaTime_seconds;
+	while (remainder_seconds >= config.timeStep_seconds * (1 - 1e-6)) {
+		step();
+		remainder_seconds -= config.timeStep_seconds;
+	}
+}
+
+void DriveDynamicsModel::step() {
+	_ensureConfig();
+	const double dt = config.timeStep_seconds;
+	const double halfTrack = config.trackWidth_meters / 2;
+
+	// Wheel forces from the motors
+	double leftForce = _getMotorForce(leftSide);
+	double rightForce = _getMotorForce(rightSide);
+
+	// Battery sags with the current drawn, seen by the motors from the next step
+	batteryVoltage_volt = config.batteryOpenVoltage_volt - config.batteryResistance_ohms * (leftSide.batteryCurrent_amps + rightSide.batteryCurrent_amps);
+
+	// Ground forces, limited by traction
+	double leftTraction, rightTraction;
+	_solveTraction(leftForce, rightForce, leftTraction, rightTraction);
+
+	// Chassis accelerations
+	double linearAcceleration = (leftTraction + rightTraction) / config.mass_kilograms;
+	double angularAcceleration = halfTrack * (rightTraction - leftTraction) / config.momentOfInertia_kilogramMetersSquared;
+
+	// Integrate chassis, semi-implicit
+	linearVelocity_metersPerSecond += linearAcceleration * dt;
+	angularVelocity_radiansPerSecond += angularAcceleration * dt;
+	double midAngle_radians = polarAngle_radians + angularVelocity_radiansPerSecond * dt / 2;
+	x_meters += linearVelocity_metersPerSecond * std::cos(midAngle_radians) * dt;
+	y_meters += linearVelocity_metersPerSecond * std::sin(midAngle_radians) * dt;
+	polarAngle_radians += angularVelocity_radiansPerSecond * dt;
+	turnedAngle_radians += angularVelocity_radiansPerSecond * dt;
+	lookDistance_meters += linearVelocity_metersPerSecond * dt;
+	lateralDistance_meters += config.lateralWheelBackOffset_meters * angularVelocity_radiansPerSecond * dt;
+
+	// Integrate wheels, which roll with the ground unless slipping
+	SideState *sides[2] = {&leftSide, &rightSide};
+	double forces[2] = {leftForce, rightForce};
+	double tractions[2] = {leftTraction, rightTraction};
+	for (int i = 0; i < 2; i++) {
+		SideState &side = *sides[i];
+		double sideSign = (i == 0) ? -1 : 1;
+		double groundVelocity = linearVelocity_metersPerSecond + sideSign * halfTrack * angularVelocity_radiansPerSecond;
+		if (side.isSlipping) {
+			side.wheelVelocity_metersPerSecond += (forces[i] - tractions[i]) / config.sideRotatingMass_kilograms * dt;
+
+			// Grip again once the slip reverses
+			if ((side.wheelVelocity_metersPerSecond - groundVelocity) * tractions[i] <= 0) {
+				side.isSlipping = false;
+				side.wheelVelocity_metersPerSecond = groundVelocity;
+			}
+		} else {
+			side.wheelVelocity_metersPerSecond = groundVelocity;
+		}
+		side.wheelDistance_meters += side.wheelVelocity_metersPerSecond * dt;
+	}
+
+	elapsed_seconds += dt;
+}
+
+double DriveDynamicsModel::getX_tiles() {
+	return x_meters / (field::tileLengthIn * inchesToMeters);
+}
+
+double DriveDynamicsModel::getY_tiles() {
+	return y_meters / (field::tileLengthIn * inchesToMeters);
+}
+
+double DriveDynamicsModel::getPolarAngle_radians() {
+	return polarAngle_radians;
+}
+
+double DriveDynamicsModel::getLinearVelocity_tilesPerSecond() {
+	return linearVelocity_metersPerSecond / (field::tileLengthIn * inchesToMeters);
+}
+
+double DriveDynamicsModel::getAngularVelocity_radiansPerSecond() {
+	return angularVelocity_radiansPerSecond;
+}
+
+double DriveDynamicsModel::getElapsedTime_seconds() {
+	return elapsed_seconds;
+}
+
+double DriveDynamicsModel::getLeftMotorPosition_revolutions() {
+	_ensureConfig();
+	return leftSide.wheelDistance_meters / (M_PI * config.wheelDiameter_meters) * config.wheelToMotorGearRatio;
+}
+
+double DriveDynamicsModel::getRightMotorPosition_revolutions() {
+	_ensureConfig();
+	return rightSide.wheelDistance_meters / (M_PI * config.wheelDiameter_meters) * config.wheelToMotorGearRatio;
+}
+
+double DriveDynamicsModel::getLeftMotorVelocity_pct() {
+	_ensureConfig();
+	double motor_rpm = leftSide.wheelVelocity_metersPerSecond / (M_PI * config.wheelDiameter_meters) * config.wheelToMotorGearRatio * 60;
+	return motor_rpm / config.motorFreeSpeed_rpm * 100;
+}
+
+double DriveDynamicsModel::getRightMotorVelocity_pct() {
+	_ensureConfig();
+	double motor_rpm = rightSide.wheelVelocity_metersPerSecond / (M_PI * config.wheelDiameter_meters) * config.wheelToMotorGearRatio * 60;
+	return motor_rpm / config.motorFreeSpeed_rpm * 100;
+}
+
+double DriveDynamicsModel::getLeftCurrent_amps() {
+	return leftSide.current_amps;
+}
+
+double DriveDynamicsModel::getRightCurrent_amps() {
+	return rightSide.current_amps;
+}
+
+double DriveDynamicsModel::getLookWheelPosition_revolutions() {
+	_ensureConfig();
+	return lookDistance_meters / (M_PI * config.lookWheelDiameter_meters);
+}
+
+double DriveDynamicsModel::getLateralWheelPosition_revolutions() {
+	_ensureConfig();
+	return lateralDistance_meters / (M_PI * config.lateralWheelDiameter_meters);
+}
+
+double DriveDynamicsModel::getInertialRotation_degrees() {
+	return -turnedAngle_radians * (180.0 / M_PI);
+}
+
+double DriveDynamicsModel::getBatteryVoltage_volt() {
+	return batteryVoltage_volt;
+}
+
+bool DriveDynamicsModel::isLeftSlipping() {
+	return leftSide.isSlipping;
+}
+
+bool DriveDynamicsModel::isRightSlipping() {
+	return rightSide.isSlipping;
+}
+
+void DriveDynamicsModel::_ensureConfig() {
+	if (!isConfigured) {
+		setConfig(getDefaultConfig());
+		batteryVoltage_volt = config.batteryOpenVoltage_volt;
+	}
+}
+
+/// @brief Returns a side's force at the wheels' rim, and updates its currents.
+double DriveDynamicsModel::_getMotorForce(SideState &side) {
+	double wheelRadius_meters = config.wheelDiameter_meters / 2;
+	double motorSpeed_radiansPerSecond = side.wheelVelocity_metersPerSecond / wheelRadius_meters * config.wheelToMotorGearRatio;
+	double backEmf_volt = backEmf_voltSecondsPerRadian * motorSpeed_radiansPerSecond;
+
+	// Applied voltage, scaled by the battery like the motor's voltage command
+	double applied_volt = 0;
+	double current_amps = 0;
+	if (side.isStopped && side.isCoast) {
+		current_amps = 0;
+	} else {
+		if (!side.isStopped) {
+			applied_volt = side.command_volt * (batteryVoltage_volt / ratedVoltage_volt);
+			applied_volt = clamp(applied_volt, -batteryVoltage_volt, batteryVoltage_volt);
+		}
+		current_amps = (applied_volt - backEmf_volt) / resistance_ohms;
+		current_amps = clamp(current_amps, -config.motorCurrentLimit_amps, config.motorCurrentLimit_amps);
+	}
+	side.current_amps = current_amps * config.motorCountPerSide;
+
+	// Current drawn from the battery, by the power delivered
+	side.batteryCurrent_amps = std::fmax(0, side.current_amps * applied_volt / batteryVoltage_volt);
+
+	// Friction eases in around zero speed
+	double frictionTorque_newtonMeters = torque_newtonMetersPerAmp * (config.motorFrictionVoltage_volt / resistance_ohms);
+	frictionTorque_newtonMeters *= clamp(motorSpeed_radiansPerSecond / frictionSmoothingSpeed_radiansPerSecond, -1, 1);
+
+	// Through the gears to the rim
+	double motorTorque_newtonMeters = torque_newtonMetersPerAmp * current_amps * config.gearEfficiency - frictionTorque_newtonMeters;
+	return config.motorCountPerSide * motorTorque_newtonMeters * config.wheelToMotorGearRatio / wheelRadius_meters;
+}
+
+/// @brief Solves the ground force on each side.
+/// A gripping side rolls with the chassis, a slipping side pushes with kinetic friction.
+void DriveDynamicsModel::_solveTraction(double leftForce, double rightForce, double &leftTraction, double &rightTraction) {
+	const double mass = config.mass_kilograms;
+	const double inertia = config.momentOfInertia_kilogramMetersSquared;
+	const double wheelMass = config.sideRotatingMass_kilograms;
+	const double halfTrack = config.trackWidth_meters / 2;
+	const double maxTraction = config.tractionCoefficient * mass * gravity_metersPerSecondSquared / 2;
+
+	// Kinetic friction on slipping sides, pushing the way the wheel slides
+	double groundVelocity[2] = {
+		linearVelocity_metersPerSecond - halfTrack * angularVelocity_radiansPerSecond,
+		linearVelocity_metersPerSecond + halfTrack * angularVelocity_radiansPerSecond
+	};
+	SideState *sides[2] = {&leftSide, &rightSide};
+	double forces[2] = {leftForce, rightForce};
+	double tractions[2];
+	for (int i = 0; i < 2; i++) {
+		double slip = sides[i]->wheelVelocity_metersPerSecond - groundVelocity[i];
+		double slipSign = (slip != 0) ? sign(slip) : sign(forces[i]);
+		tractions[i] = maxTraction * slipSign;
+	}
+
+	// Gripping sides, a side that needs more than traction starts slipping
+	for (int iteration = 0; iteration < 3; iteration++) {
+		bool isLeftRolling = !leftSide.isSlipping;
+		bool isRightRolling = !rightSide.isSlipping;
+		if (isLeftRolling && isRightRolling) {
+			// a = (F_L + F_R) / (M + 2m), α = b(F_R - F_L) / (I + 2mb²)
+			double linearAcceleration = (leftForce + rightForce) / (mass + 2 * wheelMass);
+			double angularAcceleration = halfTrack * (rightForce - leftForce) / (inertia + 2 * wheelMass * halfTrack * halfTrack);
+			tractions[0] = leftForce - wheelMass * (linearAcceleration - halfTrack * angularAcceleration);
+			tractions[1] = rightForce - wheelMass * (linearAcceleration + halfTrack * angularAcceleration);
+		} else if (isLeftRolling || isRightRolling) {
+			// m * a_wheel = F - T, with the other side's T fixed
+			int rolling = isLeftRolling ? 0 : 1;
+			int other = 1 - rolling;
+			tractions[rolling] = (
+				(forces[rolling] - wheelMass * tractions[other] * (1 / mass - halfTrack * halfTrack / inertia))
+				/ (1 + wheelMass / mass + wheelMass * halfTrack * halfTrack / inertia)
+			);
+		}
+
+		// Check traction
+		bool isChanged = false;
+		for (int i = 0; i < 2; i++) {
+			if (!sides[i]->isSlipping && std::fabs(tractions[i]) > maxTraction) {
+				sides[i]->isSlipping = true;
+				tractions[i] = maxTraction * sign(tractions[i]);
+				isChanged = true;
+			}
+		}
+		if (!isChanged) {
+			break;
+		}
+	}
+
+	leftTraction = tractions[0];
+	rightTraction = tractions[1];
+}
@@ -5,6 +5,7 @@
 RobotSimulator::RobotSimulator() {
 	resetTimer();
 	travelledDistance = 0;
+	angularPosition = angularVelocity = angularAcceleration = angularJerk = 0;
 }
 
 void RobotSimulator::resetTimer() {
@@ -18,15 +19,34 @@ void RobotSimulator::updatePhysics() {
 	double deltaTime = currentTime - lastUpdateTime;
 	lastUpdateTime = currentTime;
 
+	// Don't catch up on long pauses
+	updatePhysics(std::fmin(deltaTime, 0.050));
+}
+
+void RobotSimulator::updatePhysics(double deltaTime_seconds) {
+	// Continue from the current pose
+	driveModel.setPose(position.x, position.y, angularPosition);
+
+	// Step dynamics
+	Vector3 previousVelocity = velocity;
+	double previousAngularVelocity = angularVelocity;
+	driveModel.advance(deltaTime_seconds);
+
 	// Update linear motions
-	position += velocity * deltaTime;
-	velocity += acceleration * deltaTime;
-	acceleration += jerk * deltaTime;
+	double heading_radians = driveModel.getPolarAngle_radians();
+	double linearVelocity = driveModel.getLinearVelocity_tilesPerSecond();
+	position = Vector3(driveModel.getX_tiles(), driveModel.getY_tiles());
+	velocity = Vector3(linearVelocity * cos(heading_radians), linearVelocity * sin(heading_radians));
+	if (deltaTime_seconds > 0) {
+		acceleration = (velocity - previousVelocity) * (1 / deltaTime_seconds);
+	}
 
 	// Update angular motions
-	angularPosition += angularVelocity * deltaTime;
-	angularVelocity += angularAcceleration * deltaTime;
-	angularAcceleration += angularJerk * deltaTime;
+	angularPosition = heading_radians;
+	angularVelocity = driveModel.getAngularVelocity_radiansPerSecond();
+	if (deltaTime_seconds > 0) {
+		angularAcceleration = (angularVelocity - previousAngularVelocity) / deltaTime_seconds;
+	}
 }
 
 void RobotSimulator::setDistance(double distance) {
@@ -0,0 +1,233 @@
+#include "Utilities/dispatcher.h"
+#include "Utilities/virtualClock.h"
+
+#include "main.h"
+
+namespace {
+	// Wheel and entry pool sizes
+	const int wheelSlotCount = 256;
+	const int maxEntryCount = 64;
+
+	// A pending action, linked into its wheel slot
+	struct Entry {
+		dispatcher::Action action;
+		double value;
+		uint32_t expireTick;
+		int generation;
+		int slotId;
+		int previousId, nextId;
+		bool isPending;
+	};
+
+	Entry entries[maxEntryCount];
+	int slotHeads[wheelSlotCount];
+	int freeHeadId = -1;
+
+	bool isInitialized = false;
+	uint32_t processedTick = 0;
+	int pendingCount = 0;
+
+	mutex wheelMutex;
+
+	void initialize();
+	uint32_t getCurrentTick();
+	uint32_t getExpireTick(double delay_seconds);
+	int getHandle(int entryId);
+	int getEntryId(int handle);
+	void linkEntry(int entryId);
+	void unlinkEntry(int entryId);
+}
+
+namespace dispatcher {
+	int schedule(double delay_seconds, Action action, double value) {
+		wheelMutex.lock();
+		initialize();
+
+		// Take a free entry
+		if (freeHeadId < 0) {
+			wheelMutex.unlock();
+			printf("Dispatcher: too many pending actions\n");
+			return -1;
+		}
+		int entryId = freeHeadId;
+		freeHeadId = entries[entryId].nextId;
+
+		// Store and link
+		Entry &entry = entries[entryId];
+		entry.action = action;
+		entry.value = value;
+		entry.expireTick = getExpireTick(delay_seconds);
+		entry.isPending = true;
+		linkEntry(entryId);
+		pendingCount++;
+
+		int handle = getHandle(entryId);
+		wheelMutex.unlock();
+		return handle;
+	}
+
+	bool cancel(int handle) {
+		wheelMutex.lock();
+		int entryId = getEntryId(handle);
+		if (entryId < 0) {
+			wheelMutex.unlock();
+			return false;
+		}
+
+		// Unlink and free
+		unlinkEntry(entryId);
+		Entry &entry = entries[entryId];
+		entry.isPending = false;
+		entry.generation++;
+		entry.nextId = freeHeadId;
+		freeHeadId = entryId;
+		pendingCount--;
+
+		wheelMutex.unlock();
+		return true;
+	}
+
+	bool reschedule(int handle, double delay_seconds) {
+		wheelMutex.lock();
+		int entryId = getEntryId(handle);
+		if (entryId < 0) {
+			wheelMutex.unlock();
+			return false;
+		}
+
+		// Move to the new slot
+		unlinkEntry(entryId);
+		entries[entryId].expireTick = getExpireTick(delay_seconds);
+		linkEntry(entryId);
+
+		wheelMutex.unlock();
+		return true;
+	}
+
+	bool isPending(int handle) {
+		return getEntryId(handle) >= 0;
+	}
+
+	int getPendingCount() {
+		return pendingCount;
+	}
+
+	void runFrame() {
+		Action firedActions[maxEntryCount];
+		double firedValues[maxEntryCount];
+		int firedCount = 0;
+
+		// Collect due entries of every slot passed since the last frame
+		wheelMutex.lock();
+		initialize();
+		uint32_t currentTick = getCurrentTick();
+		while ((int32_t) (currentTick - processedTick) > 0) {
+			processedTick++;
+			int entryId = slotHeads[processedTick % wheelSlotCount];
+			while (entryId >= 0) {
+				Entry &entry = entries[entryId];
+				int nextId = entry.nextId;
+
+				// Entries a full turn or more ahead stay in the slot
+				if ((int32_t) (entry.expireTick - processedTick) <= 0) {
+					firedActions[firedCount] = entry.action;
+					firedValues[firedCount] = entry.value;
+					firedCount++;
+
+					unlinkEntry(entryId);
+					entry.isPending = false;
+					entry.generation++;
+					entry.nextId = freeHeadId;
+					freeHeadId = entryId;
+					pendingCount--;
+				}
+				entryId = nextId;
+			}
+		}
+		wheelMutex.unlock();
+
+		// Fire outside the lock, so actions may schedule again
+		for (int i = 0; i < firedCount; i++) {
+			firedActions[i](firedValues[i]);
+		}
+	}
+}
+
+namespace {
+	/// @brief Builds the free list and empty wheel on first use.
+	void initialize() {
+		if (isInitialized) {
+			return;
+		}
+		for (int i = 0; i < wheelSlotCount; i++) {
+			slotHeads[i] = -1;
+		}
+		for (int i = 0; i < maxEntryCount; i++) {
+			entries[i].isPending = false;
+			entries[i].generation = 0;
+			entries[i].nextId = (i + 1 < maxEntryCount) ? (i + 1) : -1;
+		}
+		freeHeadId = 0;
+		processedTick = getCurrentTick();
+		isInitialized = true;
+	}
+
+	uint32_t getCurrentTick() {
+		return (uint32_t) (vclock::getTime_microseconds() / (dispatcher::tickPeriod_msec * 1000));
+	}
+
+	/// @brief Returns the first tick at or after the delay from now.
+	uint32_t getExpireTick(double delay_seconds) {
+		double delay_ticks = fmax(0, delay_seconds) * 1000.0 / dispatcher::tickPeriod_msec;
+		uint32_t expireTick = getCurrentTick() + (uint32_t) ceil(delay_ticks);
+
+		// Never expire in a slot that was already processed
+		if ((int32_t) (expireTick - processedTick) <= 0) {
+			expireTick = processedTick + 1;
+		}
+		return expireTick;
+	}
+
+	// Handles pack the entry's generation, so stale handles are rejected
+
+	int getHandle(int entryId) {
+		return (entries[entryId].generation & 0xFFFFF) * maxEntryCount + entryId;
+	}
+
+	int getEntryId(int handle) {
+		if (handle < 0) {
+			return -1;
+		}
+		int entryId = handle % maxEntryCount;
+		Entry &entry = entries[entryId];
+		if (!entry.isPending || (entry.generation & 0xFFFFF) != handle / maxEntryCount) {
+			return -1;
+		}
+		return entryId;
+	}
+
+	/// @brief Adds an entry to the front of its slot's list.
+	void linkEntry(int entryId) {
+		Entry &entry = entries[entryId];
+		entry.slotId = entry.expireTick % wheelSlotCount;
+		entry.previousId = -1;
+		entry.nextId = slotHeads[entry.slotId];
+		if (entry.nextId >= 0) {
+			entries[entry.nextId].previousId = entryId;
+		}
+		slotHeads[entry.slotId] = entryId;
+	}
+
+	/// @brief Removes an entry from its slot's list.
+	void unlinkEntry(int entryId) {
+		Entry &entry = entries[entryId];
+		if (entry.previousId >= 0) {
+			entries[entry.previousId].nextId = entry.nextId;
+		} else {
+			slotHeads[entry.slotId] = entry.nextId;
+		}
+		if (entry.nextId >= 0) {
+			entries[entry.nextId].previousId = entry.previousId;
+		}
+	}
+}
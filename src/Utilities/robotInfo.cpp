@@ -1,4 +1,5 @@
 #include "Utilities/robotInfo.h"
+#include "Utilities/sysidConstants.h"
 #include "main.h"
 
 namespace botinfo {
@@ -16,4 +17,12 @@ namespace botinfo {
 	const double trackingLookWheelSensorGearRatio = 1.0; // Wheel to Encoder / Rotation
 
 	const double chassisMotorRpm = 600.0;
+
+	// Characterized by the SystemIdentification auton and tools/sysidFit.py
+	const double driveLeftKs_volt = sysidconstants::driveLeftKs_volt;
+	const double driveLeftKv_voltPerTilesPerSecond = sysidconstants::driveLeftKv_voltPerTilesPerSecond;
+	const double driveLeftKa_voltPerTilesPerSecondSquared = sysidconstants::driveLeftKa_voltPerTilesPerSecondSquared;
+	const double driveRightKs_volt = sysidconstants::driveRightKs_volt;
+	const double driveRightKv_voltPerTilesPerSecond = sysidconstants::driveRightKv_voltPerTilesPerSecond;
+	const double driveRightKa_voltPerTilesPerSecondSquared = sysidconstants::driveRightKa_voltPerTilesPerSecondSquared;
 }
@@ -0,0 +1,256 @@
+#include "Utilities/scheduler.h"
+
+#include "Utilities/timingProbe.h"
+#include "Utilities/virtualClock.h"
+
+#include "main.h"
+
+namespace {
+	const int maxJobCount = 16;
+
+	// Smoothing of the mean timings
+	const double meanFilterGain = 0.02;
+
+	struct Job {
+		const char *name;
+		scheduler::JobCallback callback;
+		int period_msec;
+		int order;
+		bool isEnabled;
+		bool hasWarnedOverrun;
+
+		uint64_t nextRelease_microseconds;
+		scheduler::JobStats stats;
+	};
+
+	Job jobs[maxJobCount];
+	int jobCount = 0;
+
+	// Run order, sorted by declared order then registration
+	int runOrder[maxJobCount];
+
+	mutex jobsMutex;
+	bool isStarted = false;
+	uint32_t tickOverrunCount = 0;
+
+	void runTick(uint64_t tickStart_microseconds);
+	void runJob(Job &job);
+	void resetJobStats(Job &job);
+}
+
+namespace scheduler {
+	int addJob(const char *name, JobCallback callback, int period_msec, int order) {
+		jobsMutex.lock();
+		if (jobCount >= maxJobCount) {
+			jobsMutex.unlock();
+			printf("Scheduler: job table full, %s not added\n", name);
+			return -1;
+		}
+
+		// Store job
+		int jobId = jobCount;
+		Job &job = jobs[jobId];
+		job.name = name;
+		job.callback = callback;
+		job.period_msec = ((period_msec + tickPeriod_msec - 1) / tickPeriod_msec) * tickPeriod_msec;
+		job.period_msec = (job.period_msec < tickPeriod_msec) ? tickPeriod_msec : job.period_msec;
+		job.order = order;
+		job.isEnabled = true;
+		job.nextRelease_microseconds = 0;
+		resetJobStats(job);
+
+		// Insert into run order
+		int insertIndex = jobCount;
+		while (insertIndex > 0 && jobs[runOrder[insertIndex - 1]].order > order) {
+			runOrder[insertIndex] = runOrder[insertIndex - 1];
+			insertIndex--;
+		}
+		runOrder[insertIndex] = jobId;
+		jobCount++;
+
+		jobsMutex.unlock();
+		return jobId;
+	}
+
+	void setJobEnabled(int jobId, bool isEnabled) {
+		if (jobId < 0 || jobId >= jobCount) {
+			return;
+		}
+		jobs[jobId].isEnabled = isEnabled;
+	}
+
+	int findJob(const char *name) {
+		for (int jobId = 0; jobId < jobCount; jobId++) {
+			if (strcmp(jobs[jobId].name, name) == 0) {
+				return jobId;
+			}
+		}
+		return -1;
+	}
+
+	void start() {
+		if (isStarted) {
+			return;
+		}
+		isStarted = true;
+
+		task schedulerTask([]() -> int {
+			uint64_t nextTick_microseconds = vclock::getTime_microseconds();
+			while (true) {
+				// Stepped clock runs the ticks itself
+				if (vclock::isStepping()) {
+					vclock::platform::sleep(tickPeriod_msec);
+					nextTick_microseconds = vclock::getTime_microseconds();
+					continue;
+				}
+
+				runTick(nextTick_microseconds);
+
+				// Sleep until the next tick, skipping ticks that were missed
+				nextTick_microseconds += tickPeriod_msec * 1000;
+				uint64_t now_microseconds = vclock::getTime_microseconds();
+				if (now_microseconds >= nextTick_microseconds) {
+					tickOverrunCount++;
+					nextTick_microseconds = now_microseconds + tickPeriod_msec * 1000;
+				}
+				uint32_t sleep_msec = (uint32_t) ((nextTick_microseconds - now_microseconds) / 1000);
+				task::sleep(sleep_msec > 0 ? sleep_msec : 1);
+
+				// Wake-up lateness
+				now_microseconds = vclock::getTime_microseconds();
+				if (now_microseconds > nextTick_microseconds) {
+					timing::recordSample(timing::SchedulerWake, (uint32_t) (now_microseconds - nextTick_microseconds));
+				} else {
+					timing::recordSample(timing::SchedulerWake, 0);
+				}
+			}
+			return 1;
+		});
+	}
+
+	void tick(uint64_t tickStart_microseconds) {
+		runTick(tickStart_microseconds);
+	}
+
+	int getJobCount() {
+		return jobCount;
+	}
+
+	bool getJobStats(int jobId, JobStats &stats) {
+		if (jobId < 0 || jobId >= jobCount) {
+			return false;
+		}
+		stats = jobs[jobId].stats;
+		return true;
+	}
+
+	uint32_t getTickOverrunCount() {
+		return tickOverrunCount;
+	}
+
+	void resetStats() {
+		jobsMutex.lock();
+		for (int i = 0; i < jobCount; i++) {
+			resetJobStats(jobs[i]);
+		}
+		tickOverrunCount = 0;
+		jobsMutex.unlock();
+	}
+
+	void printStats() {
+		// Copy, so the jobs aren't held up while printing
+		JobStats statsCopy[maxJobCount];
+		jobsMutex.lock();
+		int count = jobCount;
+		uint32_t overrunCount = tickOverrunCount;
+		for (int i = 0; i < count; i++) {
+			statsCopy[i] = jobs[runOrder[i]].stats;
+		}
+		jobsMutex.unlock();
+
+		printf("Scheduler: %d jobs, %lu tick overruns\n", count, (unsigned long) overrunCount);
+		for (int i = 0; i < count; i++) {
+			JobStats &stats = statsCopy[i];
+			printf("  %-12s %3d ms  exec %6.0f / %6.0f us  jitter %6.0f / %6.0f us  runs %lu  overruns %lu\n",
+				stats.name, stats.period_msec,
+				stats.meanExecution_microseconds, stats.maxExecution_microseconds,
+				stats.meanJitter_microseconds, stats.maxJitter_microseconds,
+				(unsigned long) stats.runCount, (unsigned long) stats.overrunCount
+			);
+		}
+	}
+}
+
+namespace {
+	/// @brief Runs every job released by this tick, in declared order.
+	void runTick(uint64_t tickStart_microseconds) {
+		jobsMutex.lock();
+		for (int i = 0; i < jobCount; i++) {
+			Job &job = jobs[runOrder[i]];
+			if (!job.isEnabled) {
+				continue;
+			}
+
+			// First release on the first tick after registration
+			if (job.nextRelease_microseconds == 0) {
+				job.nextRelease_microseconds = tickStart_microseconds;
+			}
+			if (tickStart_microseconds < job.nextRelease_microseconds) {
+				continue;
+			}
+
+			runJob(job);
+		}
+		jobsMutex.unlock();
+	}
+
+	/// @brief Runs a job and updates its timings.
+	void runJob(Job &job) {
+		uint64_t period_microseconds = (uint64_t) job.period_msec * 1000;
+
+		// Run, releases follow the clock and execution is measured on the system clock
+		uint64_t start_microseconds = vclock::getTime_microseconds();
+		uint64_t systemStart_microseconds = vclock::platform::getTime_microseconds();
+		job.callback();
+		uint64_t end_microseconds = vclock::getTime_microseconds();
+		uint64_t systemEnd_microseconds = vclock::platform::getTime_microseconds();
+
+		// Timings
+		scheduler::JobStats &stats = job.stats;
+		double execution_microseconds = (double) (systemEnd_microseconds - systemStart_microseconds);
+		double jitter_microseconds = (double) (start_microseconds - job.nextRelease_microseconds);
+		if (stats.runCount == 0) {
+			stats.meanExecution_microseconds = execution_microseconds;
+			stats.meanJitter_microseconds = jitter_microseconds;
+		} else {
+			stats.meanExecution_microseconds += meanFilterGain * (execution_microseconds - stats.meanExecution_microseconds);
+			stats.meanJitter_microseconds += meanFilterGain * (jitter_microseconds - stats.meanJitter_microseconds);
+		}
+		stats.maxExecution_microseconds = fmax(stats.maxExecution_microseconds, execution_microseconds);
+		stats.maxJitter_microseconds = fmax(stats.maxJitter_microseconds, jitter_microseconds);
+		stats.runCount++;
+
+		// Next release, skipping missed releases
+		job.nextRelease_microseconds += period_microseconds;
+		if (end_microseconds > job.nextRelease_microseconds) {
+			stats.overrunCount++;
+			if (!job.hasWarnedOverrun) {
+				job.hasWarnedOverrun = true;
+				printf("Scheduler: %s overran its %d ms deadline (%.0f us)\n", job.name, job.period_msec, execution_microseconds + jitter_microseconds);
+			}
+			uint64_t missedPeriods = (end_microseconds - job.nextRelease_microseconds) / period_microseconds + 1;
+			job.nextRelease_microseconds += missedPeriods * period_microseconds;
+		}
+	}
+
+	void resetJobStats(Job &job) {
+		scheduler::JobStats &stats = job.stats;
+		stats.name = job.name;
+		stats.period_msec = job.period_msec;
+		stats.order = job.order;
+		stats.runCount = stats.overrunCount = 0;
+		stats.meanExecution_microseconds = stats.maxExecution_microseconds = 0;
+		stats.meanJitter_microseconds = stats.maxJitter_microseconds = 0;
+		job.hasWarnedOverrun = false;
+	}
+}
@@ -0,0 +1,85 @@
+#include "Utilities/sysidLog.h"
+#include "Utilities/virtualClock.h"
+
+#include "main.h"
+
+namespace {
+	const int headerSize = 8;
+
+	uint8_t fileBuffer[headerSize + sysid::maxRecordCount * sysid::recordSize];
+	int recordCount = 0;
+	uint64_t startTime_microseconds = 0;
+
+	void writeUint16(uint8_t *destination, uint16_t value);
+	void writeUint32(uint8_t *destination, uint32_t value);
+	void writeFloat(uint8_t *destination, float value);
+}
+
+namespace sysid {
+	void begin() {
+		recordCount = 0;
+		startTime_microseconds = vclock::getTime_microseconds();
+	}
+
+	bool record(Mechanism mechanism, Test test, double voltage_volt, double velocity, double position) {
+		if (recordCount >= maxRecordCount) {
+			return false;
+		}
+
+		// Pack record
+		uint8_t *destination = fileBuffer + headerSize + recordCount * recordSize;
+		writeUint32(destination, (uint32_t) (vclock::getTime_microseconds() - startTime_microseconds));
+		destination[4] = (uint8_t) mechanism;
+		destination[5] = (uint8_t) test;
+		writeUint16(destination + 6, 0);
+		writeFloat(destination + 8, (float) voltage_volt);
+		writeFloat(destination + 12, (float) velocity);
+		writeFloat(destination + 16, (float) position);
+		recordCount++;
+
+		return true;
+	}
+
+	int getRecordCount() {
+		return recordCount;
+	}
+
+	bool save(const char *fileName) {
+		if (!Brain.SDcard.isInserted()) {
+			printf("Sysid: no SD card\n");
+			return false;
+		}
+
+		// Header
+		memcpy(fileBuffer, "SYID", 4);
+		writeUint16(fileBuffer + 4, fileVersion);
+		writeUint16(fileBuffer + 6, recordSize);
+
+		// Write
+		int32_t byteCount = headerSize + recordCount * recordSize;
+		int32_t writtenCount = Brain.SDcard.savefile(fileName, fileBuffer, byteCount);
+		printf("Sysid: saved %d records to %s\n", recordCount, fileName);
+		return writtenCount == byteCount;
+	}
+}
+
+namespace {
+	// Little-endian writers, independent of struct padding
+
+	void writeUint16(uint8_t *destination, uint16_t value) {
+		destination[0] = value & 0xFF;
+		destination[1] = (value >> 8) & 0xFF;
+	}
+
+	void writeUint32(uint8_t *destination, uint32_t value) {
+		for (int i = 0; i < 4; i++) {
+			destination[i] = (value >> (8 * i)) & 0xFF;
+		}
+	}
+
+	void writeFloat(uint8_t *destination, float value) {
+		uint32_t bits;
+		memcpy(&bits, &value, sizeof(bits));
+		writeUint32(destination, bits);
+	}
+}
@@ -0,0 +1,95 @@
+#include "Utilities/timingProbe.h"
+
+#include "main.h"
+
+namespace {
+	const char *probeNames[timing::probeCount] = {
+		"odometry",
+		"intake",
+		"arm",
+		"path follow",
+		"sched wake",
+	};
+
+	timing::ProbeStats probeStats[timing::probeCount];
+
+	void resetProbe(timing::ProbeStats &stats);
+}
+
+namespace timing {
+	void recordSample(int probeId, uint32_t duration_microseconds) {
+		if (probeId < 0 || probeId >= probeCount) {
+			return;
+		}
+		ProbeStats &stats = probeStats[probeId];
+
+		// Find bucket
+		int bucketId = 0;
+		while (bucketId < bucketCount - 1 && duration_microseconds > bucketUpperBounds_microseconds[bucketId]) {
+			bucketId++;
+		}
+
+		// Aggregate
+		if (stats.sampleCount == 0 || duration_microseconds < stats.min_microseconds) {
+			stats.min_microseconds = duration_microseconds;
+		}
+		if (duration_microseconds > stats.max_microseconds) {
+			stats.max_microseconds = duration_microseconds;
+		}
+		stats.total_microseconds += duration_microseconds;
+		stats.bucketCounts[bucketId]++;
+		stats.sampleCount++;
+	}
+
+	const char *getProbeName(int probeId) {
+		if (probeId < 0 || probeId >= probeCount) {
+			return "";
+		}
+		return probeNames[probeId];
+	}
+
+	const ProbeStats &getProbeStats(int probeId) {
+		return probeStats[probeId];
+	}
+
+	double getMean_microseconds(int probeId) {
+		const ProbeStats &stats = probeStats[probeId];
+		if (stats.sampleCount == 0) {
+			return 0;
+		}
+		return (double) stats.total_microseconds / stats.sampleCount;
+	}
+
+	void resetStats() {
+		for (int i = 0; i < probeCount; i++) {
+			resetProbe(probeStats[i]);
+		}
+	}
+
+	void printStats() {
+		printf("Timing (us): min / mean / max, histogram <=50 <=100 <=250 <=500 <=1k <=2.5k <=5k >5k\n");
+		for (int i = 0; i < probeCount; i++) {
+			// Copy, the probe keeps recording while printing
+			ProbeStats stats = probeStats[i];
+			double mean_microseconds = (stats.sampleCount == 0) ? 0 : (double) stats.total_microseconds / stats.sampleCount;
+			printf("  %-12s %5lu / %7.1f / %5lu  [",
+				probeNames[i], (unsigned long) stats.min_microseconds, mean_microseconds, (unsigned long) stats.max_microseconds
+			);
+			for (int j = 0; j < bucketCount; j++) {
+				printf(j == 0 ? "%lu" : " %lu", (unsigned long) stats.bucketCounts[j]);
+			}
+			printf("]\n");
+		}
+	}
+}
+
+namespace {
+	void resetProbe(timing::ProbeStats &stats) {
+		stats.sampleCount = 0;
+		stats.min_microseconds = stats.max_microseconds = 0;
+		stats.total_microseconds = 0;
+		for (int j = 0; j < timing::bucketCount; j++) {
+			stats.bucketCounts[j] = 0;
+		}
+	}
+}
@@ -0,0 +1,117 @@
+#include "Utilities/virtualClock.h"
+
+namespace {
+	// Stepping
+	bool isStepped = false;
+	int32_t steppingTaskId = -1;
+	vclock::TickCallback tickCallback = nullptr;
+	uint64_t tickPeriod_microseconds = 5000;
+	bool isInTick = false;
+
+	uint64_t steppedTime_microseconds = 0;
+	uint64_t nextTick_microseconds = 0;
+
+	// Added to the system clock, so time continues from where stepping stopped
+	int64_t systemOffset_microseconds = 0;
+}
+
+namespace vclock {
+	uint64_t getTime_microseconds() {
+		if (isStepped) {
+			return steppedTime_microseconds;
+		}
+		return (uint64_t) ((int64_t) platform::getTime_microseconds() + systemOffset_microseconds);
+	}
+
+	double getTime_seconds() {
+		return getTime_microseconds() * 1e-6;
+	}
+
+	void sleep(uint32_t msec) {
+		if (isStepped && platform::getTaskId() == steppingTaskId) {
+			advance((uint64_t) msec * 1000);
+
+			// Let the other tasks run
+			platform::yield();
+			return;
+		}
+		platform::sleep(msec);
+	}
+
+	void startStepping(TickCallback callback, int tickPeriod_msec) {
+		uint64_t now_microseconds = getTime_microseconds();
+		tickCallback = callback;
+		tickPeriod_microseconds = (uint64_t) (tickPeriod_msec > 0 ? tickPeriod_msec : 1) * 1000;
+		steppingTaskId = platform::getTaskId();
+
+		// First tick runs on the first sleep
+		steppedTime_microseconds = now_microseconds;
+		nextTick_microseconds = now_microseconds;
+		isInTick = false;
+		isStepped = true;
+	}
+
+	void stopStepping() {
+		if (!isStepped) {
+			return;
+		}
+		systemOffset_microseconds = (int64_t) steppedTime_microseconds - (int64_t) platform::getTime_microseconds();
+		isStepped = false;
+	}
+
+	bool isStepping() {
+		return isStepped;
+	}
+
+	void advance(uint64_t deltaTime_microseconds) {
+		if (!isStepped) {
+			return;
+		}
+		uint64_t target_microseconds = steppedTime_microseconds + deltaTime_microseconds;
+
+		// Blocking inside a tick, later ticks wait for it
+		if (isInTick) {
+			steppedTime_microseconds = target_microseconds;
+			return;
+		}
+
+		// Run the ticks due by the target, as the scheduler task would
+		while (nextTick_microseconds <= target_microseconds) {
+			steppedTime_microseconds = nextTick_microseconds;
+			if (tickCallback) {
+				isInTick = true;
+				tickCallback(nextTick_microseconds);
+				isInTick = false;
+			}
+
+			// Skip the ticks a blocking job missed
+			nextTick_microseconds += tickPeriod_microseconds;
+			if (steppedTime_microseconds >= nextTick_microseconds) {
+				nextTick_microseconds = steppedTime_microseconds + tickPeriod_microseconds;
+			}
+		}
+		if (target_microseconds > steppedTime_microseconds) {
+			steppedTime_microseconds = target_microseconds;
+		}
+	}
+
+	Timer::Timer() {
+		reset();
+	}
+
+	void Timer::reset() {
+		start_microseconds = getTime_microseconds();
+	}
+
+	void Timer::clear() {
+		reset();
+	}
+
+	double Timer::value() {
+		return (getTime_microseconds() - start_microseconds) * 1e-6;
+	}
+
+	uint32_t Timer::time() {
+		return (uint32_t) ((getTime_microseconds() - start_microseconds) / 1000);
+	}
+}
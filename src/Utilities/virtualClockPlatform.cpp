@@ -0,0 +1,24 @@
+#include "Utilities/virtualClock.h"
+
+#include "main.h"
+
+// System clock of the brain
+namespace vclock {
+	namespace platform {
+		uint64_t getTime_microseconds() {
+			return timer::systemHighResolution();
+		}
+
+		void sleep(uint32_t msec) {
+			task::sleep(msec);
+		}
+
+		void yield() {
+			this_thread::yield();
+		}
+
+		int32_t getTaskId() {
+			return this_thread::get_id();
+		}
+	}
+}
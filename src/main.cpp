@@ -18,7 +18,10 @@
 #include "Mechanics/botIntake.h"
 
 #include "Utilities/fieldInfo.h"
+#include "Utilities/robotInfo.h"
 #include "Utilities/debugFunctions.h"
+#include "Utilities/scheduler.h"
+#include "Utilities/virtualClock.h"
 
 #include "Videos/video-main.h"
 
@@ -46,6 +49,7 @@ Odometry mainOdometry;
 
 RobotSimulator robotSimulator;
 bool mainUseSimulator = false;
+bool mainUseSteppedClock = false;
 
 TrajectoryPlanner testTrajectoryPlan;
 timer trajectoryTestTimer;
@@ -68,25 +72,37 @@ void pre_auton(void) {
 	// Example: clearing encoders, setting servo positions, ...
 
 	// Odometry
-	mainOdometry.addPositionSensor2D(-90, []() {return LookRotation.position(rev);}, 1, 2.005, 0);
-	mainOdometry.addPositionSensor2D(180, []() {return RightEncoder.position(rev);}, 1, 2.75, -3.5);
-	// mainOdometry.addInertialSensor(InertialSensor, -3.2, 2.1);
-	// mainOdometry.addInertialSensor(InertialSensor, -2.8, 2.8);
-	mainOdometry.addInertialSensor(InertialSensor, -4, 4);
-	// mainOdometry.addInertialSensor(InertialSensor, 0, 0);
+	if (mainUseSimulator) {
+		// Simulated sensors, so the followers see odometry error as on the robot
+		DriveDynamicsModel::Config simConfig = robotSimulator.driveModel.getConfig();
+		double metersToInches = 1 / 0.0254;
+		mainOdometry.addPositionSensor2D(90, []() {return robotSimulator.driveModel.getLookWheelPosition_revolutions();}, 1, simConfig.lookWheelDiameter_meters * metersToInches, 0);
+		mainOdometry.addPositionSensor2D(0, []() {return robotSimulator.driveModel.getLateralWheelPosition_revolutions();}, 1, simConfig.lateralWheelDiameter_meters * metersToInches, simConfig.lateralWheelBackOffset_meters * metersToInches);
+		mainOdometry.addInertialSensor([]() {return robotSimulator.driveModel.getInertialRotation_degrees();});
+		mainOdometry.setDriveReference([]() {return robotSimulator.driveModel.getLeftMotorPosition_revolutions();}, []() {return robotSimulator.driveModel.getRightMotorPosition_revolutions();}, 1.0 / botinfo::driveWheelMotorGearRatio, botinfo::driveWheelDiameterIn, botinfo::robotLengthIn);
+		mainOdometry.setStationarySpeedCallback([]() {return fabs(robotSimulator.driveModel.getLeftMotorVelocity_pct()) + fabs(robotSimulator.driveModel.getRightMotorVelocity_pct());}, 2);
+	} else {
+		mainOdometry.addPositionSensor2D(-90, []() {return LookRotation.position(rev);}, 1, 2.005, 0, []() {return LookRotation.timestamp();});
+		mainOdometry.addPositionSensor2D(180, []() {return RightEncoder.position(rev);}, 1, 2.75, -3.5);
+		// mainOdometry.addInertialSensor(InertialSensor, -3.2, 2.1);
+		// mainOdometry.addInertialSensor(InertialSensor, -2.8, 2.8);
+		mainOdometry.addInertialSensor(InertialSensor, -4, 4);
+		// mainOdometry.addInertialSensor(InertialSensor, 0, 0);
+		mainOdometry.setDriveReference([]() {return LeftMotors.position(rev);}, []() {return RightMotors.position(rev);}, 1.0 / botinfo::driveWheelMotorGearRatio, botinfo::driveWheelDiameterIn, botinfo::robotLengthIn);
+		mainOdometry.setStationarySpeedCallback([]() {return fabs(LeftMotors.velocity(pct)) + fabs(RightMotors.velocity(pct));}, 2);
+	}
 	mainOdometry.setPositionFactor(1.0 / field::tileLengthIn);
 	task odometryTask([]() -> int {
 		wait(500, msec);
 		mainOdometry.setPosition(1, 1);
 		mainOdometry.setLookAngle(0);
 		mainOdometry.start();
-		while (true) {
+		// Runs first in every tick
+		scheduler::addJob("odometry", []() {
 			mainOdometry.odometryFrame();
-			Controller1.Screen.setCursor(3, 0);
-			// Controller1.Screen.print("Enc val: %.3f\n", RightEncoder.position(rev));
 			// printf("test: %.3f %.3f\n", mainOdometry.getX(), mainOdometry.getY());
-			wait(5, msec);
-		}
+		}, 5, scheduler::order::Odometry);
+		return 1;
 	});
 
 	// Tasks
@@ -116,8 +132,14 @@ void pre_auton(void) {
 /*---------------------------------------------------------------------------*/
 
 void autonomous(void) {
+	// Simulated autonomous runs on the stepped clock, as fast as it computes
+	bool isStepped = mainUseSimulator && mainUseSteppedClock;
+	if (isStepped) {
+		vclock::startStepping(scheduler::tick, scheduler::tickPeriod_msec);
+	}
+
 	// Start autonomous
-	timer benchmark;
+	vclock::Timer benchmark;
 
 	// Switch to a random video
 	task switchVideo([]() -> int {
@@ -133,6 +155,9 @@ void autonomous(void) {
 	// ..........................................................................
 
 	printf("Time spent: %.3f s\n", benchmark.value());
+	if (isStepped) {
+		vclock::stopStepping();
+	}
 }
 
 /// @brief A function for testing autonomous directly in usercontrol.
@@ -0,0 +1,193 @@
+/**
+ * Host run of the drivetrain dynamics model.
+ *
+ * Drives the model at full voltage to check its top speed and acceleration against
+ * the characterized limits, then follows the skills splines with Ramsete and the
+ * drive's feedforward velocity controller, sending voltages to the model the way
+ * the drive pipeline does. Each follow runs twice to check the result is repeatable.
+ * Prints the tracking error, slip, current and battery sag, and the speed of the
+ * simulation against real time.
+ *
+ * Build and run from the repository root:
+ *     g++ -std=gnu++11 -O2 -include cmath -Iinclude tools/driveSimulation.cpp \
+ *         src/Simulation/driveDynamicsModel.cpp src/AutonUtilities/ramseteController.cpp \
+ *         src/AutonUtilities/linegular.cpp src/GraphUtilities/?*.cpp \
+ *         src/Utilities/angleUtility.cpp src/Utilities/generalUtility.cpp src/Utilities/fieldInfo.cpp \
+ *         -o /tmp/driveSimulation && /tmp/driveSimulation
+ */
+
+#include "Simulation/driveDynamicsModel.h"
+#include "AutonUtilities/ramseteController.h"
+#include "AutonUtilities/linegular.h"
+
+#include "GraphUtilities/uniformCubicSpline.h"
+#include "GraphUtilities/curveSampler.h"
+#include "GraphUtilities/trajectoryPlanner.h"
+
+#include "Utilities/fieldInfo.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "hostRobotInfo.h"
+
+namespace {
+	const double controlPeriod_seconds = 0.010;
+
+	// Drive velocity controller, as in botDrive.cpp
+	const double kP = 1.0;
+
+	struct Result {
+		double rmsError_tiles, maxError_tiles, finalError_tiles;
+		double slipFraction;
+		double maxCurrent_amps, minBattery_volt;
+		double finalX_tiles, finalY_tiles, finalAngle_radians;
+		double simulated_seconds, wall_seconds;
+	};
+
+	double getMotorPctToTilesPerSecond() {
+		// Motor pct -> motor rpm -> wheel rev/s -> inches/s -> tiles/s
+		return botinfo::chassisMotorRpm / 100.0 / 60.0 / botinfo::driveWheelMotorGearRatio * botinfo::driveWheelCircumIn / field::tileLengthIn;
+	}
+
+	void runFullVoltage() {
+		DriveDynamicsModel model(DriveDynamicsModel::getDefaultConfig());
+		model.reset(0, 0, 0);
+		model.setVoltage(12, 12);
+
+		double timeTo90_seconds = -1;
+		double peakAcceleration = 0, previousVelocity = 0;
+		double topVelocity = hostpaths::driveMaxVel;
+		for (int step = 0; step < 2000; step++) {
+			model.step();
+			double velocity = model.getLinearVelocity_tilesPerSecond();
+			peakAcceleration = std::max(peakAcceleration, (velocity - previousVelocity) / model.getConfig().timeStep_seconds);
+			previousVelocity = velocity;
+			if (timeTo90_seconds < 0 && velocity > 0.9 * topVelocity) {
+				timeTo90_seconds = model.getElapsedTime_seconds();
+			}
+		}
+		printf("full voltage: top %.2f tiles/s (characterized %.2f), peak accel %.1f tiles/s^2, 90%% in %.2f s, battery %.2f V\n",
+			model.getLinearVelocity_tilesPerSecond(), topVelocity, peakAcceleration, timeTo90_seconds, model.getBatteryVoltage_volt());
+
+		// Acceleration from rest is almost all kA, a mismatch shows as lag in the follows below
+		// Full voltage asks for more than traction holds, so kA is measured at a voltage within it
+		const double kaTestVoltage_volt = 4;
+		model.reset(0, 0, 0);
+		model.setVoltage(kaTestVoltage_volt, kaTestVoltage_volt);
+		model.step();
+		double startAcceleration = model.getLinearVelocity_tilesPerSecond() / model.getConfig().timeStep_seconds;
+		printf("  model kA ~ %.2f V per tiles/s^2 at %.0f V (characterized %.2f)\n",
+			kaTestVoltage_volt / startAcceleration, kaTestVoltage_volt, sysidconstants::driveLeftKa_voltPerTilesPerSecondSquared);
+	}
+
+	Result follow(UniformCubicSpline &spline, CurveSampler &sampler, TrajectoryPlanner &plan, bool reverse) {
+		std::chrono::steady_clock::time_point wallStart = std::chrono::steady_clock::now();
+
+		RamseteController ramsete;
+		ramsete.setDirection(reverse);
+		DriveDynamicsModel model(DriveDynamicsModel::getDefaultConfig());
+		Linegular startLg = spline.getLinegularAt(0, reverse);
+		model.reset(startLg.getX(), startLg.getY(), startLg.getThetaPolarAngle_radians());
+
+		double halfTrackWidth = botinfo::halfRobotLengthIn / field::tileLengthIn;
+		double pctToTilesPerSecond = getMotorPctToTilesPerSecond();
+
+		Result result = {};
+		result.minBattery_volt = 1e9;
+		double errorSquaredSum = 0;
+		int frameCount = 0, slipFrameCount = 0;
+
+		double totalTime = plan.getTotalTime();
+		for (double time = 0; time <= totalTime + 0.5; time += controlPeriod_seconds) {
+			// Reference
+			std::vector<double> motion = plan.getMotionAtTime(std::min(time, totalTime));
+			double tvalue = sampler.distanceToParam(motion[0]);
+			Linegular targetLg = spline.getLinegularAt(tvalue, reverse);
+			double curvature = spline.getCurvatureAt(tvalue);
+
+			// Tracking error
+			Linegular robotLg(model.getX_tiles(), model.getY_tiles(), model.getPolarAngle_radians() * 180 / M_PI);
+			double error = hypot(targetLg.getX() - robotLg.getX(), targetLg.getY() - robotLg.getY());
+			errorSquaredSum += error * error;
+			result.maxError_tiles = std::max(result.maxError_tiles, error);
+			result.finalError_tiles = error;
+			frameCount++;
+
+			// Ramsete to wheel velocities and accelerations
+			std::pair<double, double> command = ramsete.getLinegularVelocity(robotLg, targetLg, motion[1], motion[1] * curvature);
+			double linearAcceleration = reverse ? -motion[2] : motion[2];
+			double angularAcceleration = motion[2] * curvature;
+			double leftVelocity = command.first - command.second * halfTrackWidth;
+			double rightVelocity = command.first + command.second * halfTrackWidth;
+			double leftAcceleration = linearAcceleration - angularAcceleration * halfTrackWidth;
+			double rightAcceleration = linearAcceleration + angularAcceleration * halfTrackWidth;
+
+			// Feedforward with light feedback on the measured wheel velocity
+			auto getVoltage = [&](double velocity, double acceleration, double measured_pct) {
+				double kS = sysidconstants::driveLeftKs_volt;
+				double kV = sysidconstants::driveLeftKv_voltPerTilesPerSecond;
+				double kA = sysidconstants::driveLeftKa_voltPerTilesPerSecondSquared;
+				double sign = (velocity > 0) - (velocity < 0);
+				double voltage = kS * sign + kV * velocity + kA * acceleration + kP * (velocity - measured_pct * pctToTilesPerSecond);
+				return std::max(-12.0, std::min(12.0, voltage));
+			};
+			model.setVoltage(
+				getVoltage(leftVelocity, leftAcceleration, model.getLeftMotorVelocity_pct()),
+				getVoltage(rightVelocity, rightAcceleration, model.getRightMotorVelocity_pct())
+			);
+
+			// Step physics
+			model.advance(controlPeriod_seconds);
+			if (model.isLeftSlipping() || model.isRightSlipping()) {
+				slipFrameCount++;
+			}
+			result.maxCurrent_amps = std::max(result.maxCurrent_amps, std::max(fabs(model.getLeftCurrent_amps()), fabs(model.getRightCurrent_amps())));
+			result.minBattery_volt = std::min(result.minBattery_volt, model.getBatteryVoltage_volt());
+		}
+
+		result.rmsError_tiles = sqrt(errorSquaredSum / std::max(1, frameCount));
+		result.slipFraction = (double) slipFrameCount / std::max(1, frameCount);
+		result.finalX_tiles = model.getX_tiles();
+		result.finalY_tiles = model.getY_tiles();
+		result.finalAngle_radians = model.getPolarAngle_radians();
+		result.simulated_seconds = model.getElapsedTime_seconds();
+		result.wall_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+		return result;
+	}
+
+	void simulate(const char *name, std::vector<std::vector<double>> points, bool reverse) {
+		UniformCubicSpline spline = UniformCubicSpline::fromAutoTangent(cspline::CatmullRom, points);
+		CurveSampler sampler = CurveSampler(spline).calculateByResolution(spline.getTRange().second * 10);
+		TrajectoryPlanner plan = TrajectoryPlanner(sampler.getDistanceRange().second)
+			.autoSetMotionConstraints(sampler, 0.3, hostpaths::maxVel, hostpaths::maxAccel, hostpaths::maxDecel)
+			.setMaxJerk(hostpaths::maxJerk)
+			.calculateMotion();
+
+		Result first = follow(spline, sampler, plan, reverse);
+		Result second = follow(spline, sampler, plan, reverse);
+		bool isRepeatable = (
+			first.finalX_tiles == second.finalX_tiles
+			&& first.finalY_tiles == second.finalY_tiles
+			&& first.finalAngle_radians == second.finalAngle_radians
+		);
+
+		printf("%s (%.2f tiles, %.2f s%s)\n", name, sampler.getDistanceRange().second, plan.getTotalTime(), reverse ? ", reversed" : "");
+		printf("  tracking error (tiles)  rms %.4f  max %.4f  final %.4f\n", first.rmsError_tiles, first.maxError_tiles, first.finalError_tiles);
+		printf("  slipping %.1f%% of frames, peak side current %.1f A, battery down to %.2f V\n",
+			first.slipFraction * 100, first.maxCurrent_amps, first.minBattery_volt);
+		printf("  %.2f s simulated in %.2f ms (%.0fx real time), repeatable: %s\n",
+			first.simulated_seconds, first.wall_seconds * 1000, first.simulated_seconds / first.wall_seconds, isRepeatable ? "yes" : "no");
+	}
+}
+
+int main() {
+	runFullVoltage();
+	simulate("skills path 1", {{0.9, 2.33}, {2.01, 1.02}, {2.98, 0.53}, {4.07, 1.08}, {5.06, 2.31}}, false);
+	simulate("skills path 2", {{0.13, 3.81}, {0.51, 2.99}, {1.38, 1.87}, {2.24, 2.35}, {3.23, 3.42}}, false);
+	simulate("skills path 1", {{0.9, 2.33}, {2.01, 1.02}, {2.98, 0.53}, {4.07, 1.08}, {5.06, 2.31}}, true);
+	return 0;
+}
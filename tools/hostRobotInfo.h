@@ -0,0 +1,51 @@
+#pragma once
+
+/**
+ * Host stand-ins shared by the tools.
+ *
+ * Defines the `botinfo` constants in place of robotInfo.cpp, which needs the V5 headers,
+ * and the path limits computed the same way as in build.cpp. Include it from one file
+ * of each tool only.
+ */
+
+#include "Utilities/robotInfo.h"
+#include "Utilities/sysidConstants.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Host stand-in for robotInfo.cpp
+namespace botinfo {
+	const double robotLengthHoles = 27.0;
+	const double robotLengthIn = robotLengthHoles * (1.0 / 2.0);
+	const double halfRobotLengthIn = robotLengthIn / 2;
+
+	const double driveWheelDiameterIn = 4;
+	const double driveWheelCircumIn = M_PI * driveWheelDiameterIn;
+	const double driveWheelMotorGearRatio = (84.0 / 60.0);
+
+	const double trackingLookWheelDiameterIn = 2.00;
+	const double trackingLookWheelCircumIn = M_PI * trackingLookWheelDiameterIn;
+	const double trackingLookWheelSensorGearRatio = 1.0;
+
+	const double chassisMotorRpm = 600.0;
+
+	const double driveLeftKs_volt = sysidconstants::driveLeftKs_volt;
+	const double driveLeftKv_voltPerTilesPerSecond = sysidconstants::driveLeftKv_voltPerTilesPerSecond;
+	const double driveLeftKa_voltPerTilesPerSecondSquared = sysidconstants::driveLeftKa_voltPerTilesPerSecondSquared;
+	const double driveRightKs_volt = sysidconstants::driveRightKs_volt;
+	const double driveRightKv_voltPerTilesPerSecond = sysidconstants::driveRightKv_voltPerTilesPerSecond;
+	const double driveRightKa_voltPerTilesPerSecondSquared = sysidconstants::driveRightKa_voltPerTilesPerSecondSquared;
+}
+
+// Path limits, as in build.cpp
+namespace hostpaths {
+	// Characterized limits of the slower side
+	const double driveMaxVel = std::min(sysidconstants::driveLeftMaxVelocity_tilesPerSecond, sysidconstants::driveRightMaxVelocity_tilesPerSecond);
+	const double driveMaxAccel = std::min(sysidconstants::driveLeftMaxAcceleration_tilesPerSecondSquared, sysidconstants::driveRightMaxAcceleration_tilesPerSecondSquared);
+
+	const double maxVel = driveMaxVel * 0.6;
+	const double maxAccel = driveMaxAccel * 0.5;
+	const double maxDecel = maxAccel;
+	const double maxJerk = 30;
+}
@@ -0,0 +1,111 @@
+"""
+Generates the gain table of the LTV unicycle controller.
+
+The unicycle error dynamics, linearized around a reference velocity v, are
+    d/dt [e_forward, e_left, e_theta] = A(v) e + B u,  u = [v_correction, w_correction]
+with A(v) = [[0, 0, 0], [0, 0, v], [0, 0, 0]] and B = [[1, 0], [0, 0], [0, 1]].
+For each tabulated v, the discrete LQR gain K = [[kForward, 0, 0], [0, kLeft, kTheta]] is
+found from the discrete algebraic Riccati equation.
+
+Units are tiles, seconds and radians, matching the path follower.
+The gains depend on DT, so the path follower job runs at the table's period.
+
+Usage:
+    python3 tools/ltvUnicycleTable.py > include/AutonUtilities/ltvUnicycleTable.h
+"""
+
+import math
+import sys
+
+# Tolerances: largest acceptable error / effort for each state / input
+TILES_PER_METER = 1.64041995
+Q_TOLERANCES = [0.0625 * TILES_PER_METER, 0.125 * TILES_PER_METER, 2.0]  # tiles, tiles, rad
+R_TOLERANCES = [1.0 * TILES_PER_METER, 2.0]  # tiles/s, rad/s
+
+# Table range
+MAX_VELOCITY = 4.0  # tiles/s
+VELOCITY_STEP = 0.1  # tiles/s
+
+# Controller period, emitted as ltvtable::period_msec for the path follower job to run at
+DT = 0.010  # s
+
+
+def matmul(a, b):
+	return [[sum(a[i][k] * b[k][j] for k in range(len(b))) for j in range(len(b[0]))] for i in range(len(a))]
+
+
+def transpose(a):
+	return [list(row) for row in zip(*a)]
+
+
+def add(a, b):
+	return [[a[i][j] + b[i][j] for j in range(len(a[0]))] for i in range(len(a))]
+
+
+def sub(a, b):
+	return [[a[i][j] - b[i][j] for j in range(len(a[0]))] for i in range(len(a))]
+
+
+def inverse2(a):
+	det = a[0][0] * a[1][1] - a[0][1] * a[1][0]
+	return [[a[1][1] / det, -a[0][1] / det], [-a[1][0] / det, a[0][0] / det]]
+
+
+def diagonal(values):
+	return [[values[i] if i == j else 0.0 for j in range(len(values))] for i in range(len(values))]
+
+
+def discretize(v):
+	# A is nilpotent, so the matrix exponential series ends after the linear term
+	a = [[1.0, 0.0, 0.0], [0.0, 1.0, v * DT], [0.0, 0.0, 1.0]]
+	b = [[DT, 0.0], [0.0, 0.5 * v * DT * DT], [0.0, DT]]
+	return a, b
+
+
+def solve_dare(a, b, q, r, iterations=20000, tolerance=1e-12):
+	p = q
+	at, bt = transpose(a), transpose(b)
+	for _ in range(iterations):
+		btpb = add(r, matmul(matmul(bt, p), b))
+		btpa = matmul(matmul(bt, p), a)
+		nextP = add(sub(matmul(matmul(at, p), a), matmul(transpose(btpa), matmul(inverse2(btpb), btpa))), q)
+		change = max(abs(nextP[i][j] - p[i][j]) / max(1.0, abs(p[i][j])) for i in range(3) for j in range(3))
+		p = nextP
+		if change < tolerance:
+			break
+	return p
+
+
+def lqr_gain(v):
+	# At zero velocity the lateral error is uncontrollable, and its gain comes out as zero
+	a, b = discretize(v)
+	q = diagonal([1.0 / (t * t) for t in Q_TOLERANCES])
+	r = diagonal([1.0 / (t * t) for t in R_TOLERANCES])
+	p = solve_dare(a, b, q, r)
+	bt = transpose(b)
+	return matmul(inverse2(add(r, matmul(matmul(bt, p), b))), matmul(matmul(bt, p), a))
+
+
+def main():
+	count = int(round(MAX_VELOCITY / VELOCITY_STEP)) + 1
+	out = sys.stdout
+	out.write("#pragma once\n\n")
+	out.write("// Generated by tools/ltvUnicycleTable.py, don't edit by hand\n")
+	out.write("// Q tolerances: %.4f tiles, %.4f tiles, %.4f rad\n" % tuple(Q_TOLERANCES))
+	out.write("// R tolerances: %.4f tiles/s, %.4f rad/s, dt: %.3f s\n\n" % (R_TOLERANCES[0], R_TOLERANCES[1], DT))
+	out.write("namespace ltvtable {\n")
+	out.write("\tconst int period_msec = %d;\n" % int(round(DT * 1000)))
+	out.write("\tconst double velocityStep_tilesPerSecond = %.4f;\n" % VELOCITY_STEP)
+	out.write("\tconst int entryCount = %d;\n\n" % count)
+	out.write("\t// kForward, kLeft, kTheta for each reference velocity\n")
+	out.write("\tconst double gains[entryCount][3] = {\n")
+	for i in range(count):
+		v = i * VELOCITY_STEP
+		k = lqr_gain(v)
+		out.write("\t\t{%.6f, %.6f, %.6f}, // %.2f tiles/s\n" % (k[0][0], k[1][1], k[1][2], v))
+	out.write("\t};\n")
+	out.write("}\n")
+
+
+if __name__ == "__main__":
+	main()
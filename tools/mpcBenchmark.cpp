@@ -0,0 +1,168 @@
+/**
+ * Host benchmark of the path tracking controllers.
+ *
+ * Follows the skills splines on a simulated drivetrain, once with Ramsete and
+ * once with the MPC, both fed the timed trajectory the way followSplinePath
+ * feeds them. The simulated wheels lag their commands and start off the path.
+ * Prints the MPC solve time distribution and the tracking error of each.
+ *
+ * Build and run from the repository root:
+ *     g++ -std=gnu++11 -O2 -include cmath -Iinclude tools/mpcBenchmark.cpp \
+ *         src/AutonUtilities/mpcController.cpp src/AutonUtilities/ramseteController.cpp \
+ *         src/AutonUtilities/linegular.cpp src/GraphUtilities/?*.cpp \
+ *         src/Utilities/angleUtility.cpp src/Utilities/generalUtility.cpp src/Utilities/fieldInfo.cpp \
+ *         -o /tmp/mpcBenchmark && /tmp/mpcBenchmark
+ */
+
+#include "AutonUtilities/mpcController.h"
+#include "AutonUtilities/ramseteController.h"
+#include "AutonUtilities/linegular.h"
+
+#include "GraphUtilities/uniformCubicSpline.h"
+#include "GraphUtilities/curveSampler.h"
+#include "GraphUtilities/trajectoryPlanner.h"
+
+#include "Utilities/fieldInfo.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "hostRobotInfo.h"
+
+namespace {
+	// Simulation
+	const double simulationStep_seconds = 0.001;
+	const double controlPeriod_seconds = 0.010;
+	const double wheelLag_seconds = 0.06;
+
+	// Initial offset from the path start
+	const double startLeftOffset_tiles = 0.08;
+	const double startHeadingOffset_degrees = 6;
+
+	enum class ControllerType { Ramsete, Mpc };
+
+	struct Result {
+		double rmsError_tiles, maxError_tiles, finalError_tiles;
+		std::vector<double> solveTimes_microseconds;
+		std::vector<int> iterationCounts;
+	};
+
+	double percentile(std::vector<double> values, double fraction) {
+		std::sort(values.begin(), values.end());
+		int index = std::min((int) values.size() - 1, (int) (fraction * values.size()));
+		return values[index];
+	}
+
+	Result follow(UniformCubicSpline &spline, CurveSampler &sampler, TrajectoryPlanner &plan, bool reverse, ControllerType type) {
+		RamseteController ramsete;
+		MpcController mpc;
+		ramsete.setDirection(reverse);
+		mpc.setDirection(reverse);
+		mpc.reset();
+
+		double halfTrackWidth = botinfo::halfRobotLengthIn / field::tileLengthIn;
+
+		// Start off the path
+		Linegular startLg = spline.getLinegularAt(0, reverse);
+		double startHeading_radians = startLg.getThetaPolarAngle_radians();
+		double x = startLg.getX() - startLeftOffset_tiles * sin(startHeading_radians);
+		double y = startLg.getY() + startLeftOffset_tiles * cos(startHeading_radians);
+		double heading = startHeading_radians + startHeadingOffset_degrees * M_PI / 180;
+		double leftVelocity = 0, rightVelocity = 0;
+		double leftCommand = 0, rightCommand = 0;
+
+		Result result;
+		double errorSquaredSum = 0;
+		int errorCount = 0;
+		result.maxError_tiles = 0;
+
+		double totalTime = plan.getTotalTime();
+		int stepsPerControl = (int) round(controlPeriod_seconds / simulationStep_seconds);
+		for (int step = 0; step * simulationStep_seconds <= totalTime + 0.5; step++) {
+			double time = step * simulationStep_seconds;
+
+			// Controller frame
+			if (step % stepsPerControl == 0) {
+				Linegular robotLg(x, y, heading * 180 / M_PI);
+				std::vector<double> motion = plan.getMotionAtTime(std::min(time, totalTime));
+				double tvalue = sampler.distanceToParam(motion[0]);
+				Linegular targetLg = spline.getLinegularAt(tvalue, reverse);
+				double angularVelocity = motion[1] * spline.getCurvatureAt(tvalue);
+
+				// Tracking error
+				double error = hypot(targetLg.getX() - x, targetLg.getY() - y);
+				errorSquaredSum += error * error;
+				errorCount++;
+				result.maxError_tiles = std::max(result.maxError_tiles, error);
+				result.finalError_tiles = error;
+
+				std::pair<double, double> command;
+				if (type == ControllerType::Ramsete) {
+					command = ramsete.getLinegularVelocity(robotLg, targetLg, motion[1], angularVelocity);
+				} else {
+					for (int k = 0; k < mpc.getHorizonSteps(); k++) {
+						std::vector<double> stepMotion = plan.getMotionAtTime(std::min(time + k * mpc.getStepTime_seconds(), totalTime));
+						double stepTvalue = sampler.distanceToParam(stepMotion[0]);
+						mpc.setReference(k, spline.getLinegularAt(stepTvalue, reverse), stepMotion[1], stepMotion[1] * spline.getCurvatureAt(stepTvalue));
+					}
+					std::chrono::steady_clock::time_point solveStart = std::chrono::steady_clock::now();
+					command = mpc.getLinegularVelocity(robotLg);
+					std::chrono::steady_clock::time_point solveEnd = std::chrono::steady_clock::now();
+					result.solveTimes_microseconds.push_back(std::chrono::duration<double, std::micro>(solveEnd - solveStart).count());
+					result.iterationCounts.push_back(mpc.getLastIterationCount());
+				}
+				leftCommand = command.first - command.second * halfTrackWidth;
+				rightCommand = command.first + command.second * halfTrackWidth;
+			}
+
+			// Wheels lag their commands
+			double lagFactor = simulationStep_seconds / wheelLag_seconds;
+			leftVelocity += (leftCommand - leftVelocity) * lagFactor;
+			rightVelocity += (rightCommand - rightVelocity) * lagFactor;
+
+			// Integrate unicycle
+			double linear = (leftVelocity + rightVelocity) / 2;
+			double angular = (rightVelocity - leftVelocity) / (2 * halfTrackWidth);
+			x += linear * cos(heading) * simulationStep_seconds;
+			y += linear * sin(heading) * simulationStep_seconds;
+			heading += angular * simulationStep_seconds;
+		}
+
+		result.rmsError_tiles = sqrt(errorSquaredSum / std::max(1, errorCount));
+		return result;
+	}
+
+	void benchmark(const char *name, std::vector<std::vector<double>> points, bool reverse) {
+		UniformCubicSpline spline = UniformCubicSpline::fromAutoTangent(cspline::CatmullRom, points);
+		CurveSampler sampler = CurveSampler(spline).calculateByResolution(spline.getTRange().second * 10);
+		TrajectoryPlanner plan = TrajectoryPlanner(sampler.getDistanceRange().second)
+			.autoSetMotionConstraints(sampler, 0.3, hostpaths::maxVel, hostpaths::maxAccel, hostpaths::maxDecel)
+			.setMaxJerk(hostpaths::maxJerk)
+			.calculateMotion();
+
+		Result ramseteResult = follow(spline, sampler, plan, reverse, ControllerType::Ramsete);
+		Result mpcResult = follow(spline, sampler, plan, reverse, ControllerType::Mpc);
+
+		printf("%s (%.2f tiles, %.2f s%s)\n", name, sampler.getDistanceRange().second, plan.getTotalTime(), reverse ? ", reversed" : "");
+		printf("  tracking error (tiles)  rms     max     final\n");
+		printf("    ramsete               %.4f  %.4f  %.4f\n", ramseteResult.rmsError_tiles, ramseteResult.maxError_tiles, ramseteResult.finalError_tiles);
+		printf("    mpc                   %.4f  %.4f  %.4f\n", mpcResult.rmsError_tiles, mpcResult.maxError_tiles, mpcResult.finalError_tiles);
+
+		std::vector<double> iterations(mpcResult.iterationCounts.begin(), mpcResult.iterationCounts.end());
+		printf("  mpc solve (us)  p50 %.1f  p90 %.1f  p99 %.1f  max %.1f\n",
+			percentile(mpcResult.solveTimes_microseconds, 0.5), percentile(mpcResult.solveTimes_microseconds, 0.9),
+			percentile(mpcResult.solveTimes_microseconds, 0.99), percentile(mpcResult.solveTimes_microseconds, 1.0));
+		printf("  mpc iterations  p50 %.0f  p90 %.0f  max %.0f\n",
+			percentile(iterations, 0.5), percentile(iterations, 0.9), percentile(iterations, 1.0));
+	}
+}
+
+int main() {
+	benchmark("skills path 1", {{0.9, 2.33}, {2.01, 1.02}, {2.98, 0.53}, {4.07, 1.08}, {5.06, 2.31}}, false);
+	benchmark("skills path 2", {{0.13, 3.81}, {0.51, 2.99}, {1.38, 1.87}, {2.24, 2.35}, {3.23, 3.42}}, false);
+	benchmark("skills path 1", {{0.9, 2.33}, {2.01, 1.02}, {2.98, 0.53}, {4.07, 1.08}, {5.06, 2.31}}, true);
+	return 0;
+}
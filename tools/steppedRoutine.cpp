@@ -0,0 +1,265 @@
+/**
+ * Host run of a two-minute routine on the stepped clock.
+ *
+ * The routine is written like the autonomous routines: it waits on the path follower
+ * with `clockWaitUntil`, pauses with `vclock::sleep`, and turns with a `PIDController`
+ * that times itself. Its sleeps step the clock, and every tick runs the simulator and
+ * path follow jobs in the scheduler's order. The routine runs twice to check the result
+ * is repeatable, and prints the simulated time against the wall time.
+ *
+ * Build and run from the repository root:
+ *     g++ -std=gnu++11 -O2 -include cmath -Iinclude tools/steppedRoutine.cpp \
+ *         src/Utilities/virtualClock.cpp src/Simulation/robotSimulator.cpp src/Simulation/vector3.cpp \
+ *         src/Simulation/driveDynamicsModel.cpp src/AutonUtilities/ramseteController.cpp \
+ *         src/AutonUtilities/linegular.cpp src/GraphUtilities/?*.cpp \
+ *         src/Utilities/angleUtility.cpp src/Utilities/generalUtility.cpp src/Utilities/fieldInfo.cpp \
+ *         -o /tmp/steppedRoutine && /tmp/steppedRoutine
+ */
+
+#include "Utilities/virtualClock.h"
+
+#include "Simulation/robotSimulator.h"
+#include "AutonUtilities/pidController.h"
+#include "AutonUtilities/ramseteController.h"
+#include "AutonUtilities/linegular.h"
+
+#include "GraphUtilities/uniformCubicSpline.h"
+#include "GraphUtilities/curveSampler.h"
+#include "GraphUtilities/trajectoryPlanner.h"
+
+#include "Utilities/fieldInfo.h"
+#include "Utilities/generalUtility.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "hostRobotInfo.h"
+
+// Host system clock, in place of virtualClockPlatform.cpp
+namespace vclock {
+	namespace platform {
+		uint64_t getTime_microseconds() {
+			return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+		}
+
+		void sleep(uint32_t msec) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(msec));
+		}
+
+		void yield() {}
+
+		int32_t getTaskId() {
+			return 0;
+		}
+	}
+}
+
+namespace {
+	const int tickPeriod_msec = 5;
+	const double routineDuration_seconds = 120;
+
+	// Drive velocity controller, as in botDrive.cpp
+	const double kP = 1.0;
+
+	RobotSimulator robotSimulator;
+
+	// Jobs, with periods and first releases like the scheduler's
+	struct Job {
+		void (*callback)();
+		int period_msec;
+		uint64_t nextRelease_microseconds;
+	};
+
+	struct Path {
+		UniformCubicSpline spline;
+		CurveSampler sampler;
+		TrajectoryPlanner plan;
+		bool reverse;
+	};
+
+	// Path follower state
+	Path *followedPath = nullptr;
+	bool pathFollowCompleted = true;
+	RamseteController ramsete;
+	vclock::Timer pathTimer;
+
+	uint64_t tickCount = 0;
+
+	double getMotorPctToTilesPerSecond() {
+		// Motor pct -> motor rpm -> wheel rev/s -> inches/s -> tiles/s
+		return botinfo::chassisMotorRpm / 100.0 / 60.0 / botinfo::driveWheelMotorGearRatio * botinfo::driveWheelCircumIn / field::tileLengthIn;
+	}
+
+	double getVoltage(double velocity, double acceleration, double measured_pct) {
+		double kS = sysidconstants::driveLeftKs_volt;
+		double kV = sysidconstants::driveLeftKv_voltPerTilesPerSecond;
+		double kA = sysidconstants::driveLeftKa_voltPerTilesPerSecondSquared;
+		double sign = (velocity > 0) - (velocity < 0);
+		double voltage = kS * sign + kV * velocity + kA * acceleration + kP * (velocity - measured_pct * getMotorPctToTilesPerSecond());
+		return genutil::clamp(voltage, -12, 12);
+	}
+
+	void simulatorFrame() {
+		robotSimulator.updatePhysics();
+	}
+
+	/// @brief Tracks the timed trajectory with Ramsete, as the path follow job does.
+	void followPathFrame() {
+		if (pathFollowCompleted) {
+			return;
+		}
+		Path &path = *followedPath;
+
+		// Finish
+		double totalTime = path.plan.getTotalTime();
+		double time = pathTimer.value();
+		if (time > totalTime + 0.3) {
+			robotSimulator.driveModel.stop(false);
+			pathFollowCompleted = true;
+			return;
+		}
+
+		// Reference
+		std::vector<double> motion = path.plan.getMotionAtTime(fmin(time, totalTime));
+		double tvalue = path.sampler.distanceToParam(motion[0]);
+		Linegular targetLg = path.spline.getLinegularAt(tvalue, path.reverse);
+		double curvature = path.spline.getCurvatureAt(tvalue);
+		Linegular robotLg(robotSimulator.position.x, robotSimulator.position.y, genutil::toDegrees(robotSimulator.angularPosition));
+
+		// Ramsete to wheel velocities and accelerations
+		double halfTrackWidth = botinfo::halfRobotLengthIn / field::tileLengthIn;
+		std::pair<double, double> command = ramsete.getLinegularVelocity(robotLg, targetLg, motion[1], motion[1] * curvature);
+		double linearAcceleration = path.reverse ? -motion[2] : motion[2];
+		double angularAcceleration = motion[2] * curvature;
+		DriveDynamicsModel &model = robotSimulator.driveModel;
+		model.setVoltage(
+			getVoltage(command.first - command.second * halfTrackWidth, linearAcceleration - angularAcceleration * halfTrackWidth, model.getLeftMotorVelocity_pct()),
+			getVoltage(command.first + command.second * halfTrackWidth, linearAcceleration + angularAcceleration * halfTrackWidth, model.getRightMotorVelocity_pct())
+		);
+	}
+
+	// In the scheduler's declared order: simulation, then path follow
+	Job jobs[] = {
+		{simulatorFrame, 5, 0},
+		{followPathFrame, 10, 0},
+	};
+
+	void runTick(uint64_t tickStart_microseconds) {
+		for (Job &job : jobs) {
+			if (job.nextRelease_microseconds == 0) {
+				job.nextRelease_microseconds = tickStart_microseconds;
+			}
+			if (tickStart_microseconds < job.nextRelease_microseconds) {
+				continue;
+			}
+			job.callback();
+			job.nextRelease_microseconds += (uint64_t) job.period_msec * 1000;
+		}
+		tickCount++;
+	}
+
+	Path buildPath(std::vector<std::vector<double>> points, bool reverse) {
+		UniformCubicSpline spline = UniformCubicSpline::fromAutoTangent(cspline::CatmullRom, points);
+		CurveSampler sampler = CurveSampler(spline).calculateByResolution(spline.getTRange().second * 10);
+		TrajectoryPlanner plan = TrajectoryPlanner(sampler.getDistanceRange().second)
+			.autoSetMotionConstraints(sampler, 0.3, hostpaths::maxVel, hostpaths::maxAccel, hostpaths::maxDecel)
+			.setMaxJerk(hostpaths::maxJerk)
+			.calculateMotion();
+		return {spline, sampler, plan, reverse};
+	}
+
+	// Routine, written like the autonomous routines
+
+	void followPath(Path &path) {
+		followedPath = &path;
+		ramsete.setDirection(path.reverse);
+		pathTimer.reset();
+		pathFollowCompleted = false;
+		clockWaitUntil(pathFollowCompleted);
+	}
+
+	void turnToAngle(double polarAngle_degrees) {
+		PIDController turnPid(0.25, 0, 0.02, 1.5, 5);
+		vclock::Timer timeout;
+		while (!turnPid.isSettled() && timeout.value() < 2) {
+			double error_degrees = genutil::modRange(polarAngle_degrees - genutil::toDegrees(robotSimulator.angularPosition), 360, -180);
+			turnPid.computeFromError(error_degrees);
+			double voltage = genutil::clamp(turnPid.getValue(), -8, 8);
+			robotSimulator.driveModel.setVoltage(-voltage, voltage);
+			vclock::sleep(10);
+		}
+		robotSimulator.driveModel.stop(false);
+	}
+
+	struct Result {
+		int legCount;
+		double finalX_tiles, finalY_tiles, finalAngle_radians;
+		double simulated_seconds, wall_seconds;
+	};
+
+	Result runRoutine() {
+		std::chrono::steady_clock::time_point wallStart = std::chrono::steady_clock::now();
+
+		std::vector<std::vector<double>> points = {{0.9, 2.33}, {2.01, 1.02}, {2.98, 0.53}, {4.07, 1.08}, {5.06, 2.31}};
+		std::vector<std::vector<double>> reversedPoints(points.rbegin(), points.rend());
+		Path outward = buildPath(points, false);
+		Path back = buildPath(reversedPoints, true);
+
+		// Start of the run
+		Linegular startLg = outward.spline.getLinegularAt(0, false);
+		robotSimulator.driveModel.reset(startLg.getX(), startLg.getY(), startLg.getThetaPolarAngle_radians());
+		robotSimulator.position = Vector3(startLg.getX(), startLg.getY());
+		robotSimulator.angularPosition = startLg.getThetaPolarAngle_radians();
+		robotSimulator.resetTimer();
+		for (Job &job : jobs) {
+			job.nextRelease_microseconds = 0;
+		}
+		pathFollowCompleted = true;
+		tickCount = 0;
+
+		vclock::startStepping(runTick, tickPeriod_msec);
+		vclock::Timer autonTimer;
+
+		// Drive out and back, turning at each end
+		int legCount = 0;
+		double startAngle_degrees = startLg.getThetaPolarAngle_degrees();
+		while (autonTimer.value() < routineDuration_seconds) {
+			followPath(outward);
+			vclock::sleep(200);
+			followPath(back);
+			turnToAngle(startAngle_degrees + 90);
+			vclock::sleep(200);
+			turnToAngle(startAngle_degrees);
+			legCount += 2;
+		}
+
+		Result result;
+		result.legCount = legCount;
+		result.finalX_tiles = robotSimulator.position.x;
+		result.finalY_tiles = robotSimulator.position.y;
+		result.finalAngle_radians = robotSimulator.angularPosition;
+		result.simulated_seconds = autonTimer.value();
+		vclock::stopStepping();
+		result.wall_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+		return result;
+	}
+}
+
+int main() {
+	Result first = runRoutine();
+	Result second = runRoutine();
+	bool isRepeatable = (
+		first.finalX_tiles == second.finalX_tiles
+		&& first.finalY_tiles == second.finalY_tiles
+		&& first.finalAngle_radians == second.finalAngle_radians
+	);
+
+	printf("routine: %d path legs, %lu ticks\n", first.legCount, (unsigned long) tickCount);
+	printf("  final pose (%.4f, %.4f) %.2f deg\n", first.finalX_tiles, first.finalY_tiles, genutil::toDegrees(first.finalAngle_radians));
+	printf("  %.2f s simulated in %.2f ms (%.0fx real time), repeatable: %s\n",
+		first.simulated_seconds, first.wall_seconds * 1000, first.simulated_seconds / first.wall_seconds, isRepeatable ? "yes" : "no");
+	return 0;
+}
@@ -0,0 +1,184 @@
+"""
+Fits feedforward constants to the samples recorded by the SystemIdentification auton.
+
+Each mechanism is fitted by least squares to
+    V = kS * sign(v) + kV * v + kA * a (+ kG * cos(angle) for the arm)
+using the quasistatic and step tests together. The arm's angle above
+horizontal comes from its motor position, through ARM_GEAR_RATIO and
+ARM_ZERO_ANGLE. The acceleration is the
+central difference of the velocity within each test. The largest velocity
+and acceleration reached in the step tests are reported as well.
+
+Mechanisms without samples keep their default constants.
+
+Usage:
+    python3 tools/sysidFit.py sysid.bin > include/Utilities/sysidConstants.h
+"""
+
+import math
+import os
+import struct
+import sys
+
+MECHANISMS = ["DriveLeft", "DriveRight", "Arm", "Intake"]
+STEP_TESTS = (2, 3)
+
+# Arm degrees per motor degree, and the arm's angle above horizontal at motor position 0,
+# where the arm rests when the motor is reset. Update both if the arm is rebuilt.
+ARM_GEAR_RATIO = 1.0
+ARM_ZERO_ANGLE = -45.0
+
+# Samples slower than this are treated as static
+MIN_VELOCITY = {"DriveLeft": 0.05, "DriveRight": 0.05, "Arm": 5.0, "Intake": 20.0}
+
+# Constants used when a mechanism has no samples
+DEFAULTS = {
+	"DriveLeft": {"kS": 0.8, "kV": 3.0, "kA": 0.6, "kG": 0.0, "maxVelocity": 3.7, "maxAcceleration": 4.0},
+	"DriveRight": {"kS": 0.8, "kV": 3.0, "kA": 0.6, "kG": 0.0, "maxVelocity": 3.7, "maxAcceleration": 4.0},
+	"Arm": {"kS": 0.5, "kV": 0.02, "kA": 0.002, "kG": 0.0, "maxVelocity": 500.0, "maxAcceleration": 3000.0},
+	"Intake": {"kS": 0.5, "kV": 0.003, "kA": 0.0003, "kG": 0.0, "maxVelocity": 3600.0, "maxAcceleration": 20000.0},
+}
+
+
+def read_samples(file_name):
+	"""Returns {mechanism: {test: [(time_s, voltage, velocity, position)]}}."""
+	with open(file_name, "rb") as file:
+		data = file.read()
+	magic, version, record_size = struct.unpack_from("<4sHH", data, 0)
+	if magic != b"SYID" or version != 1:
+		raise ValueError("not a sysid log")
+
+	samples = {}
+	for offset in range(8, len(data) - record_size + 1, record_size):
+		time_us, mechanism, test, _, voltage, velocity, position = struct.unpack_from("<IBBHfff", data, offset)
+		name = MECHANISMS[mechanism]
+		samples.setdefault(name, {}).setdefault(test, []).append((time_us * 1e-6, voltage, velocity, position))
+	return samples
+
+
+def with_acceleration(test_samples):
+	"""Returns (voltage, velocity, acceleration, position) rows, differentiating over two samples each side."""
+	rows = []
+	for i in range(2, len(test_samples) - 2):
+		time_before, _, velocity_before, _ = test_samples[i - 2]
+		time_after, _, velocity_after, _ = test_samples[i + 2]
+		if time_after <= time_before:
+			continue
+		acceleration = (velocity_after - velocity_before) / (time_after - time_before)
+		_, voltage, velocity, position = test_samples[i]
+		rows.append((voltage, velocity, acceleration, position))
+	return rows
+
+
+def solve(matrix, vector):
+	"""Solves a small linear system by Gaussian elimination with partial pivoting."""
+	size = len(vector)
+	augmented = [list(matrix[i]) + [vector[i]] for i in range(size)]
+	for column in range(size):
+		pivot = max(range(column, size), key=lambda row: abs(augmented[row][column]))
+		augmented[column], augmented[pivot] = augmented[pivot], augmented[column]
+		if abs(augmented[column][column]) < 1e-12:
+			raise ValueError("singular fit, not enough varied samples")
+		for row in range(size):
+			if row != column:
+				factor = augmented[row][column] / augmented[column][column]
+				for k in range(column, size + 1):
+					augmented[row][k] -= factor * augmented[column][k]
+	return [augmented[i][size] / augmented[i][i] for i in range(size)]
+
+
+def least_squares(features, targets):
+	"""Solves the normal equations of features * x = targets."""
+	size = len(features[0])
+	normal = [[sum(f[i] * f[j] for f in features) for j in range(size)] for i in range(size)]
+	right = [sum(f[i] * t for f, t in zip(features, targets)) for i in range(size)]
+	return solve(normal, right)
+
+
+def percentile(values, fraction):
+	ordered = sorted(values)
+	return ordered[min(len(ordered) - 1, int(fraction * len(ordered)))]
+
+
+def arm_angle(motor_position):
+	"""Returns the arm's angle above horizontal, in degrees."""
+	return motor_position * ARM_GEAR_RATIO + ARM_ZERO_ANGLE
+
+
+def fit(name, tests):
+	use_gravity = name == "Arm"
+	features, targets = [], []
+	step_velocities, step_accelerations = [], []
+
+	for test, test_samples in tests.items():
+		rows = with_acceleration(test_samples)
+		for voltage, velocity, acceleration, position in rows:
+			if abs(velocity) < MIN_VELOCITY[name]:
+				continue
+			feature = [math.copysign(1, velocity), velocity, acceleration]
+			if use_gravity:
+				feature.append(math.cos(math.radians(arm_angle(position))))
+			features.append(feature)
+			targets.append(voltage)
+			if test in STEP_TESTS:
+				step_velocities.append(abs(velocity))
+				step_accelerations.append(abs(acceleration))
+
+	solution = least_squares(features, targets)
+	constants = {"kS": solution[0], "kV": solution[1], "kA": solution[2], "kG": solution[3] if use_gravity else 0.0}
+	constants["maxVelocity"] = max(step_velocities) if step_velocities else DEFAULTS[name]["maxVelocity"]
+	constants["maxAcceleration"] = percentile(step_accelerations, 0.95) if step_accelerations else DEFAULTS[name]["maxAcceleration"]
+	constants["sampleCount"] = len(targets)
+	return constants
+
+
+def lower_first(name):
+	return name[0].lower() + name[1:]
+
+
+def emit(results, source):
+	units = {
+		"DriveLeft": ("tiles", "Tiles"), "DriveRight": ("tiles", "Tiles"),
+		"Arm": ("degrees", "Degrees"), "Intake": ("degrees", "Degrees"),
+	}
+	print("#pragma once")
+	print()
+	print("// Generated by tools/sysidFit.py, don't edit by hand")
+	print("// Source: %s" % os.path.basename(source))
+	print()
+	print("namespace sysidconstants {")
+	for index, name in enumerate(MECHANISMS):
+		constants = results[name]
+		prefix = lower_first(name)
+		unit, unitName = units[name]
+		if index > 0:
+			print()
+		if "sampleCount" in constants:
+			print("\t// %s, fitted from %d samples" % (name, constants["sampleCount"]))
+		else:
+			print("\t// %s, defaults" % name)
+		print("\tconst double %sKs_volt = %.4f;" % (prefix, constants["kS"]))
+		print("\tconst double %sKv_voltPer%sPerSecond = %.6f;" % (prefix, unitName, constants["kV"]))
+		print("\tconst double %sKa_voltPer%sPerSecondSquared = %.6f;" % (prefix, unitName, constants["kA"]))
+		if name == "Arm":
+			print("\t// Holds the arm level, scaled by the cosine of its angle above horizontal")
+			print("\tconst double %sKg_volt = %.4f;" % (prefix, constants["kG"]))
+			print("\tconst double %sGearRatio = %.4f;" % (prefix, ARM_GEAR_RATIO))
+			print("\tconst double %sZeroAngle_degrees = %.4f;" % (prefix, ARM_ZERO_ANGLE))
+		print("\tconst double %sMaxVelocity_%sPerSecond = %.4f;" % (prefix, unit, constants["maxVelocity"]))
+		print("\tconst double %sMaxAcceleration_%sPerSecondSquared = %.4f;" % (prefix, unit, constants["maxAcceleration"]))
+	print("}")
+
+
+def main():
+	results = dict((name, dict(DEFAULTS[name])) for name in MECHANISMS)
+	source = "defaults"
+	if len(sys.argv) > 1:
+		source = sys.argv[1]
+		for name, tests in read_samples(source).items():
+			results[name] = fit(name, tests)
+	emit(results, source)
+
+
+if __name__ == "__main__":
+	main()